@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Tiny benchmark runner for level_bench, every benchmark runs once to warm up and then `iterations` timed runs.
+// Results are written as JSON so CI can diff them against a stored baseline.
+
+struct BenchConfig
+{
+    uint64_t seed = 1337;
+    size_t entityCount = 10000;
+    int iterations = 10;
+    std::string filter;
+};
+
+struct BenchResult
+{
+    std::string name;
+    size_t operations = 0;
+    std::vector<double> runMs;
+
+    double MinMs() const { return *std::min_element(runMs.begin(), runMs.end()); }
+
+    double MedianMs() const
+    {
+        std::vector<double> sorted = runMs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t middle = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) * 0.5;
+    }
+
+    double MeanMs() const
+    {
+        double total = 0.0;
+        for (double ms : runMs)
+            total += ms;
+        return total / runMs.size();
+    }
+};
+
+// Keeps the compiler from throwing away work whose result we never use
+inline volatile uint64_t benchSink = 0;
+
+template <typename T>
+inline void DoNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    benchSink = benchSink + *reinterpret_cast<const volatile unsigned char *>(&value);
+#endif
+}
+
+class BenchSuite
+{
+public:
+    explicit BenchSuite(const BenchConfig &benchConfig) : config(benchConfig) {}
+
+    // setup/teardown are not timed, use them for anything the benchmark shouldn't measure
+    void Run(const std::string &name, size_t operations, const std::function<void()> &body,
+             const std::function<void()> &setup = nullptr, const std::function<void()> &teardown = nullptr)
+    {
+        if (!config.filter.empty() && name.find(config.filter) == std::string::npos)
+            return;
+
+        BenchResult result;
+        result.name = name;
+        result.operations = operations;
+
+        for (int i = -1; i < config.iterations; ++i)
+        {
+            if (setup)
+                setup();
+
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+
+            if (teardown)
+                teardown();
+
+            // First run is the warm up
+            if (i >= 0)
+                result.runMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        results.push_back(result);
+    }
+
+    const std::vector<BenchResult> &GetResults() const { return results; }
+
+    // Correctness checks that run next to the timings (SIMD paths against the plain ones and so on). main lists the
+    // failed ones and exits non zero, so CI fails on a wrong result and not only on a slow one
+    void Check(const std::string &name, bool passed)
+    {
+        if (!passed)
+            failedChecks.push_back(name);
+    }
+
+    const std::vector<std::string> &GetFailedChecks() const { return failedChecks; }
+
+    void WriteJson(std::ostream &out) const
+    {
+        out << "{\n  \"seed\": " << config.seed << ",\n  \"entities\": " << config.entityCount
+            << ",\n  \"iterations\": " << config.iterations << ",\n  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult &result = results[i];
+            double nsPerOp = result.operations ? result.MedianMs() * 1.0e6 / result.operations : 0.0;
+            out << "    {\"name\": \"" << result.name << "\", \"operations\": " << result.operations
+                << ", \"min_ms\": " << result.MinMs() << ", \"median_ms\": " << result.MedianMs()
+                << ", \"mean_ms\": " << result.MeanMs() << ", \"ns_per_op\": " << nsPerOp << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+
+        out << "  ]\n}\n";
+    }
+
+private:
+    BenchConfig config;
+    std::vector<BenchResult> results;
+    std::vector<std::string> failedChecks;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <raylib.h>
+#include <raymath.h>
+#include "LevelEditor/gameEntity.h"
+
+// SplitMix64, tiny and gives the same numbers on every compiler/stdlib (std::uniform_real_distribution doesn't)
+class BenchRandom
+{
+public:
+    explicit BenchRandom(uint64_t seed) : state(seed) {}
+
+    uint64_t Next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    float NextFloat() { return static_cast<float>(Next() >> 40) / static_cast<float>(1ULL << 24); }
+    float Range(float min, float max) { return min + (max - min) * NextFloat(); }
+    Vector3 Vector(float min, float max) { return {Range(min, max), Range(min, max), Range(min, max)}; }
+
+    Quaternion Rotation()
+    {
+        Vector3 axis = Vector3Normalize(Vector(-1.0f, 1.0f));
+        if (Vector3Length(axis) < 0.001f)
+            axis = {0, 1, 0};
+        return QuaternionFromAxisAngle(axis, Range(0.0f, 2.0f * PI));
+    }
+
+private:
+    uint64_t state;
+};
+
+// Half size of the cube the scene gets spread over, grows with the entity count so density stays about the same
+inline float GetSceneExtent(size_t entityCount)
+{
+    return std::cbrt(static_cast<float>(entityCount)) * 2.0f;
+}
+
+// Same seed + count = same scene, mix of cubes and spheres with random transforms
+inline std::vector<GameEntity *> GenerateScene(uint64_t seed, size_t entityCount)
+{
+    static const char *NAMES[] = {"Entity", "Wall", "Floor", "Crate", "Pillar", "Barrel", "Light", "Door"};
+
+    BenchRandom random(seed);
+    float extent = GetSceneExtent(entityCount);
+
+    std::vector<GameEntity *> entities;
+    entities.reserve(entityCount);
+
+    for (size_t i = 0; i < entityCount; ++i)
+    {
+        GameEntity *entity = new GameEntity();
+        entity->SetName(NAMES[random.Next() % (sizeof(NAMES) / sizeof(NAMES[0]))]);
+        entity->EntityTransform.position = random.Vector(-extent, extent);
+        entity->EntityTransform.rotation = random.Rotation();
+        entity->EntityTransform.UpdateEulerFromQuaternion();
+        float scale = random.Range(0.5f, 2.0f);
+        entity->EntityTransform.scale = {scale, scale, scale};
+
+        if (random.NextFloat() < 0.6f)
+        {
+            auto cube = entity->AddComponent<CubeComponent>();
+            cube->size = random.Vector(0.5f, 2.0f);
+        }
+        else
+        {
+            auto sphere = entity->AddComponent<SphereComponent>();
+            sphere->radius = random.Range(0.25f, 1.0f);
+        }
+
+        entities.push_back(entity);
+    }
+
+    return entities;
+}
+
+// Rays from outside the scene aimed at random points inside it, so most of them actually hit something
+inline std::vector<Ray> GenerateRays(uint64_t seed, size_t rayCount, size_t entityCount)
+{
+    BenchRandom random(seed ^ 0xA5A5A5A5ULL);
+    float extent = GetSceneExtent(entityCount);
+
+    std::vector<Ray> rays;
+    rays.reserve(rayCount);
+    for (size_t i = 0; i < rayCount; ++i)
+    {
+        Vector3 origin = Vector3Scale(Vector3Normalize(random.Vector(-1.0f, 1.0f)), extent * 3.0f);
+        Vector3 target = random.Vector(-extent * 0.5f, extent * 0.5f);
+        rays.push_back({origin, Vector3Normalize(Vector3Subtract(target, origin))});
+    }
+    return rays;
+}
+
+inline void DestroyScene(std::vector<GameEntity *> &entities)
+{
+    for (auto entity : entities)
+        delete entity;
+    entities.clear();
+}
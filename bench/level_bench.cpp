@@ -0,0 +1,1125 @@
+// Headless benchmarks for the editor core, no window or GL context needed.
+//
+//   level_bench [--entities N] [--seed S] [--iterations I] [--filter name] [--out results.json]
+//
+// Same arguments give the same synthetic scene every time, so results can be compared between commits.
+// The correctness checks run along with the benchmarks, any of them failing makes the exit code 1.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchHarness.h"
+#include "SceneGenerator.h"
+#include "LevelEditor/gameEntity.h"
+#include "LevelEditor/Picking.h"
+#include "LevelEditor/Collision.h"
+#include "LevelEditor/EntityMemory.h"
+#include "LevelEditor/EntityView.h"
+#include "LevelEditor/StringPool.h"
+#include "EngineInputs/inputs.h"
+#include "EngineInputs/ActionMap.h"
+#include "SaveLevel/save.h"
+#include "SaveLevel/AssetPrefetch.h"
+#include "Rendering/OcclusionCuller.h"
+#include "Rendering/DrawList.h"
+#include "Rendering/TransformBatch.h"
+#include "Jobs/JobSystem.h"
+#include "../utf8/utf8.h"
+
+static void RegisterEntityBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    std::vector<GameEntity *> created;
+    auto createDestroy = [&]()
+    {
+        created.reserve(config.entityCount);
+        for (size_t i = 0; i < config.entityCount; ++i)
+        {
+            GameEntity *entity = new GameEntity();
+            entity->AddComponent<CubeComponent>();
+            created.push_back(entity);
+        }
+        DestroyScene(created);
+    };
+    suite.Run("entity_create_destroy", config.entityCount, createDestroy);
+
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+
+    auto componentLookup = [&]()
+    {
+        size_t found = 0;
+        for (auto entity : scene)
+        {
+            found += entity->GetComponent<CubeComponent>() != nullptr;
+            found += entity->GetComponent<SphereComponent>() != nullptr;
+            found += entity->GetComponent<ModelComponent>() != nullptr;
+        }
+        DoNotOptimize(found);
+    };
+    suite.Run("component_lookup", config.entityCount * 3, componentLookup);
+
+    auto componentHas = [&]()
+    {
+        size_t found = 0;
+        for (auto entity : scene)
+        {
+            found += entity->HasComponent<CubeComponent>();
+            found += entity->HasComponent<SphereComponent>();
+            found += entity->HasComponent<ModelComponent>();
+        }
+        DoNotOptimize(found);
+    };
+    suite.Run("component_has", config.entityCount * 3, componentHas);
+
+    // Every entity already has its one Object component, so this is only the category check saying no
+    auto componentAddRejected = [&]()
+    {
+        size_t added = 0;
+        for (auto entity : scene)
+            added += entity->AddComponent<ModelComponent>() != nullptr;
+        DoNotOptimize(added);
+    };
+    suite.Run("component_add_rejected", config.entityCount, componentAddRejected);
+
+    // Going over every drawable thing: the old per entity if/else chain against the cached views, and what a rebuild
+    // of the views costs after a structural change
+    auto queryChain = [&]()
+    {
+        float total = 0.0f;
+        for (auto entity : scene)
+        {
+            if (auto cube = entity->GetComponent<CubeComponent>())
+                total += cube->size.x;
+            else if (auto sphere = entity->GetComponent<SphereComponent>())
+                total += sphere->radius;
+            else if (auto model = entity->GetComponent<ModelComponent>())
+                total += model->occluder;
+        }
+        DoNotOptimize(total);
+    };
+    suite.Run("query_chain", config.entityCount, queryChain);
+
+    auto queryView = [&]()
+    {
+        float total = 0.0f;
+        for (const auto &item : View<CubeComponent>(scene))
+            total += item.Get<CubeComponent>()->size.x;
+        for (const auto &item : View<SphereComponent>(scene))
+            total += item.Get<SphereComponent>()->radius;
+        for (const auto &item : View<ModelComponent>(scene))
+            total += item.Get<ModelComponent>()->occluder;
+        DoNotOptimize(total);
+    };
+    suite.Run("query_view", config.entityCount, queryView);
+
+    EntityView<CubeComponent> rebuiltView;
+    auto queryRebuild = [&]()
+    {
+        DoNotOptimize(rebuiltView.Update(scene).size());
+    };
+    // A fresh view every run, so every run has to scan
+    suite.Run("query_view_rebuild", config.entityCount, queryRebuild, [&]()
+              { rebuiltView = EntityView<CubeComponent>(); });
+
+    auto transformUpdate = [&]()
+    {
+        for (auto entity : scene)
+        {
+            entity->EntityTransform.RotateAroundLocalAxis({0, 1, 0}, 1.0f);
+            Matrix transform = entity->EntityTransform.GetTransformMatrix();
+            DoNotOptimize(transform);
+        }
+    };
+    suite.Run("transform_update", config.entityCount, transformUpdate);
+
+    const size_t RAY_COUNT = 256;
+    std::vector<Ray> rays = GenerateRays(config.seed, RAY_COUNT, config.entityCount);
+    auto rayPick = [&]()
+    {
+        size_t hits = 0;
+        for (const Ray &ray : rays)
+            hits += Picking::PickEntity(scene, ray) != nullptr;
+        DoNotOptimize(hits);
+    };
+    suite.Run("ray_pick", RAY_COUNT, rayPick);
+
+    // The views go shape by shape, the closest hit still has to be what one pass over the entities finds
+    if (config.filter.empty() || std::string("ray_pick").find(config.filter) != std::string::npos)
+    {
+        int mismatches = 0;
+        for (const Ray &ray : rays)
+        {
+            GameEntity *expected = nullptr;
+            float expectedDistance = 0.0f;
+            for (auto entity : scene)
+            {
+                RayCollision collision = Picking::RayEntity(entity, ray);
+                if (collision.hit && (!expected || collision.distance < expectedDistance))
+                {
+                    expected = entity;
+                    expectedDistance = collision.distance;
+                }
+            }
+            mismatches += Picking::PickEntity(scene, ray) != expected;
+        }
+        std::cerr << "ray_pick: " << mismatches << " of " << RAY_COUNT << " rays picked something else than a plain loop\n";
+        suite.Check("ray_pick_matches_loop", mismatches == 0);
+    }
+
+    DestroyScene(scene);
+}
+
+// Where entities and components come from: the pools and the level arena against plain new/delete, unloading a
+// bulk created level, and how scattered the cubes get after a lot of deleting and creating
+static void RegisterAllocationBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    const size_t count = config.entityCount;
+    std::vector<void *> blocks(count * 2);
+
+    // Only the memory, one entity and one cube worth per entity
+    auto heapAlloc = [&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            blocks[i * 2] = ::operator new(sizeof(GameEntity));
+            blocks[i * 2 + 1] = ::operator new(sizeof(CubeComponent));
+        }
+        for (void *block : blocks)
+            ::operator delete(block);
+    };
+    suite.Run("alloc_heap", blocks.size(), heapAlloc);
+
+    auto poolAlloc = [&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            blocks[i * 2] = EntityMemory::Allocate(sizeof(GameEntity));
+            blocks[i * 2 + 1] = EntityMemory::Allocate(sizeof(CubeComponent));
+        }
+        for (void *block : blocks)
+            EntityMemory::Free(block);
+    };
+    suite.Run("alloc_pool", blocks.size(), poolAlloc);
+
+    auto arenaAlloc = [&]()
+    {
+        EntityMemory::BeginLevelArena();
+        for (size_t i = 0; i < count; ++i)
+        {
+            blocks[i * 2] = EntityMemory::Allocate(sizeof(GameEntity));
+            blocks[i * 2 + 1] = EntityMemory::Allocate(sizeof(CubeComponent));
+        }
+        EntityMemory::EndLevelArena();
+        for (void *block : blocks)
+            EntityMemory::Free(block);
+        EntityMemory::ReleaseLevelArena();
+    };
+    suite.Run("alloc_arena", blocks.size(), arenaAlloc);
+
+    // Whole entities, constructors and the component map included
+    std::vector<GameEntity *> created;
+    auto createEntities = [&]()
+    {
+        created.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            GameEntity *entity = new GameEntity();
+            entity->AddComponent<CubeComponent>();
+            created.push_back(entity);
+        }
+    };
+    auto createArena = [&]()
+    {
+        EntityMemory::BeginLevelArena();
+        createEntities();
+        EntityMemory::EndLevelArena();
+    };
+    auto unload = [&]()
+    {
+        DestroyScene(created);
+        EntityMemory::ReleaseLevelArena();
+    };
+    suite.Run("entity_create_pool", count, createEntities, nullptr, unload);
+    suite.Run("entity_create_arena", count, createArena, nullptr, unload);
+    suite.Run("entity_unload_pool", count, unload, createEntities);
+    suite.Run("entity_unload_arena", count, unload, createArena);
+
+    // Fragmentation: a few rounds of replacing a random half of the cubes with other things allocated in between,
+    // like an editing session. Then how many 4KB pages the cubes ended up spread over and how long reading all of them takes
+    const size_t OTHER_SIZES[] = {sizeof(GameEntity), sizeof(SphereComponent), sizeof(ModelComponent)};
+    const int CHURN_ROUNDS = 4;
+    auto churn = [&](auto allocate, auto release, std::vector<void *> &cubes)
+    {
+        BenchRandom random(config.seed);
+        std::vector<void *> others;
+        cubes.resize(count);
+        auto allocateCube = [&]()
+        {
+            void *cube = allocate(sizeof(CubeComponent));
+            *static_cast<float *>(cube) = 1.0f;
+            return cube;
+        };
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            cubes[i] = allocateCube();
+            others.push_back(allocate(OTHER_SIZES[random.Next() % 3]));
+        }
+        for (int round = 0; round < CHURN_ROUNDS; ++round)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (random.Next() & 1)
+                {
+                    release(cubes[i]);
+                    release(others[i]);
+                    others[i] = allocate(OTHER_SIZES[random.Next() % 3]);
+                    cubes[i] = allocateCube();
+                }
+            }
+        }
+        for (void *other : others)
+            release(other);
+    };
+    auto pagesTouched = [](const std::vector<void *> &cubes)
+    {
+        std::vector<uintptr_t> pages;
+        for (void *cube : cubes)
+            pages.push_back(reinterpret_cast<uintptr_t>(cube) >> 12);
+        std::sort(pages.begin(), pages.end());
+        return static_cast<size_t>(std::unique(pages.begin(), pages.end()) - pages.begin());
+    };
+
+    std::vector<void *> heapCubes, poolCubes;
+    auto heapAllocate = [](size_t size)
+    { return ::operator new(size); };
+    auto heapRelease = [](void *block)
+    { ::operator delete(block); };
+    auto poolRelease = [](void *block)
+    { EntityMemory::Free(block); };
+
+    suite.Run("alloc_churn_heap", count * (CHURN_ROUNDS + 1), [&]()
+              { churn(heapAllocate, heapRelease, heapCubes); },
+              nullptr, [&]()
+              { for (void *cube : heapCubes) ::operator delete(cube); heapCubes.clear(); });
+    suite.Run("alloc_churn_pool", count * (CHURN_ROUNDS + 1), [&]()
+              { churn(EntityMemory::Allocate, poolRelease, poolCubes); },
+              nullptr, [&]()
+              { for (void *cube : poolCubes) EntityMemory::Free(cube); poolCubes.clear(); });
+
+    // Fresh churned sets outside of the timing for the walks and the numbers
+    churn(heapAllocate, heapRelease, heapCubes);
+    churn(EntityMemory::Allocate, poolRelease, poolCubes);
+
+    auto walk = [](const std::vector<void *> &cubes)
+    {
+        float total = 0.0f;
+        for (void *cube : cubes)
+            total += *static_cast<const float *>(cube);
+        DoNotOptimize(total);
+    };
+    suite.Run("component_walk_heap", count, [&]()
+              { walk(heapCubes); });
+    suite.Run("component_walk_pool", count, [&]()
+              { walk(poolCubes); });
+
+    EntityMemoryStats stats = EntityMemory::GetStats();
+    double used = stats.poolPages ? 100.0 * stats.poolLiveBytes / (stats.poolPages * EntityMemory::PAGE_SIZE) : 0.0;
+    std::cerr << "entity memory after churn: cubes on " << pagesTouched(heapCubes) << " 4KB pages on the heap, " << pagesTouched(poolCubes)
+              << " in the pool (" << (count * sizeof(CubeComponent) + 4095) / 4096 << " at best); pool " << stats.poolLive << " live / " << stats.poolFree << " free blocks in " << stats.poolPages << " pages ("
+              << used << "% used)\n";
+
+    for (void *cube : heapCubes)
+        ::operator delete(cube);
+    for (void *cube : poolCubes)
+        EntityMemory::Free(cube);
+}
+
+// Rotated cube bounds: building/caching the OBBs, ray and frustum tests against them, and a check of all of it
+// against plain math (ray into the cube's local space, plane tests on the 8 corners)
+static void RegisterBoundsBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+    std::vector<CubeComponent *> cubes;
+    for (auto entity : scene)
+    {
+        if (auto cube = entity->GetComponent<CubeComponent>())
+            cubes.push_back(cube);
+    }
+
+    std::vector<OrientedBox> boxes(cubes.size());
+    auto buildBoxes = [&]()
+    {
+        for (size_t i = 0; i < cubes.size(); ++i)
+        {
+            const EntityTransform &transform = cubes[i]->entity->EntityTransform;
+            boxes[i] = OrientedBox::FromRotation(transform.position, transform.rotation, Vector3Scale(Vector3Multiply(cubes[i]->size, transform.scale), 0.5f));
+        }
+    };
+    suite.Run("obb_build", cubes.size(), buildBoxes);
+    buildBoxes();
+
+    auto cachedBoxes = [&]()
+    {
+        float sum = 0.0f;
+        for (auto cube : cubes)
+            sum += cube->GetOrientedBox().center.x;
+        DoNotOptimize(sum);
+    };
+    suite.Run("obb_cached", cubes.size(), cachedBoxes);
+
+    const size_t RAY_COUNT = 64;
+    std::vector<Ray> rays = GenerateRays(config.seed, RAY_COUNT, config.entityCount);
+    auto rayBoxes = [&]()
+    {
+        size_t hits = 0;
+        for (const Ray &ray : rays)
+        {
+            for (const OrientedBox &box : boxes)
+                hits += Collision::RayOrientedBox(ray, box).hit;
+        }
+        DoNotOptimize(hits);
+    };
+    suite.Run("ray_obb", RAY_COUNT * boxes.size(), rayBoxes);
+
+    float extent = GetSceneExtent(config.entityCount);
+    Matrix view = MatrixLookAt({extent * 1.5f, extent * 0.5f, extent * 1.5f}, {0, 0, 0}, {0, 1, 0});
+    Matrix viewProjection = MatrixMultiply(view, MatrixPerspective(45.0f * DEG2RAD, 16.0 / 9.0, 0.01, 1000.0));
+    Frustum frustum = Frustum::FromMatrix(viewProjection);
+    auto frustumBoxes = [&]()
+    {
+        size_t inside = 0;
+        for (const OrientedBox &box : boxes)
+            inside += Collision::FrustumOrientedBox(frustum, box);
+        DoNotOptimize(inside);
+    };
+    suite.Run("frustum_obb", boxes.size(), frustumBoxes);
+
+    // Accuracy against the straightforward versions, only a slice of the boxes so it stays quick
+    size_t checked = std::min<size_t>(boxes.size(), 2000);
+    size_t rayMismatches = 0, frustumMismatches = 0, boundsMismatches = 0;
+    for (size_t i = 0; i < checked; ++i)
+    {
+        const OrientedBox &box = boxes[i];
+        const EntityTransform &transform = cubes[i]->entity->EntityTransform;
+        Vector3 size = Vector3Multiply(cubes[i]->size, transform.scale);
+        Matrix world = MatrixMultiply(MatrixMultiply(MatrixScale(size.x, size.y, size.z), QuaternionToMatrix(transform.rotation)),
+                                      MatrixTranslate(transform.position.x, transform.position.y, transform.position.z));
+        Matrix toLocal = MatrixInvert(world);
+
+        for (const Ray &ray : rays)
+        {
+            RayCollision fast = Collision::RayOrientedBox(ray, box);
+
+            Vector3 localOrigin = Vector3Transform(ray.position, toLocal);
+            Vector3 localDirection = Vector3Subtract(Vector3Transform(Vector3Add(ray.position, ray.direction), toLocal), localOrigin);
+            RayCollision reference = Collision::RayBox({localOrigin, localDirection}, {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}});
+
+            if (fast.hit != reference.hit)
+                ++rayMismatches;
+            else if (fast.hit)
+            {
+                float distance = Vector3Distance(ray.position, Vector3Transform(reference.point, world));
+                if (fabsf(distance - fast.distance) > 1e-3f * std::max(1.0f, distance))
+                    ++rayMismatches;
+            }
+        }
+
+        Vector3 corners[8];
+        BoundingBox cornerBounds = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            corners[corner] = box.GetCorner(corner);
+            cornerBounds.min = Vector3Min(cornerBounds.min, corners[corner]);
+            cornerBounds.max = Vector3Max(cornerBounds.max, corners[corner]);
+        }
+
+        BoundingBox bounds = box.GetBoundingBox();
+        if (Vector3Distance(bounds.min, cornerBounds.min) > 1e-4f || Vector3Distance(bounds.max, cornerBounds.max) > 1e-4f)
+            ++boundsMismatches;
+
+        // Outside a plane exactly when all 8 corners are
+        bool referenceInside = true;
+        for (int plane = 0; plane < 6 && referenceInside; ++plane)
+        {
+            int outside = 0;
+            for (const Vector3 &corner : corners)
+            {
+                float side = frustum.normalX[plane] * corner.x + frustum.normalY[plane] * corner.y + frustum.normalZ[plane] * corner.z + frustum.distance[plane];
+                outside += side < -1e-4f;
+            }
+            referenceInside = outside < 8;
+        }
+        if (referenceInside != Collision::FrustumOrientedBox(frustum, box))
+            ++frustumMismatches;
+    }
+
+    std::cerr << "obb accuracy over " << checked << " boxes: " << rayMismatches << " ray, " << frustumMismatches << " frustum, "
+              << boundsMismatches << " bounds mismatches\n";
+    suite.Check("obb_ray_accuracy", rayMismatches == 0);
+    suite.Check("obb_frustum_accuracy", frustumMismatches == 0);
+    suite.Check("obb_bounds_accuracy", boundsMismatches == 0);
+
+    DestroyScene(scene);
+}
+
+static void RegisterTransformBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    // Odd on purpose, so the 8/4 wide loops always leave a tail for the scalar one
+    size_t count = config.entityCount | 1;
+    BenchRandom random(config.seed);
+    std::vector<EntityTransform> source(count);
+    TransformSoA transforms;
+    transforms.Resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        EntityTransform &transform = source[i];
+        transform.position = random.Vector(-100.0f, 100.0f);
+        transform.scale = random.Vector(0.1f, 10.0f);
+        transform.rotation = random.Rotation();
+        // Some that never got normalized, the kernel has to give what raymath gives for those too
+        if (i % 7 == 0)
+            transform.rotation = QuaternionScale(transform.rotation, random.Range(0.5f, 1.5f));
+        transforms.Set(i, transform);
+    }
+
+    std::vector<Matrix> reference(count), scalar(count), batched(count);
+    auto raymath = [&]()
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const Vector3 &position = source[i].position;
+            reference[i] = MatrixMultiply(source[i].GetTransformMatrix(), MatrixTranslate(position.x, position.y, position.z));
+        }
+        DoNotOptimize(reference.data());
+    };
+    suite.Run("transform_batch_raymath", count, raymath);
+
+    auto batchScalar = [&]()
+    {
+        TransformBatch::ComputeWorldMatricesScalar(transforms, 0, count, scalar.data());
+        DoNotOptimize(scalar.data());
+    };
+    suite.Run("transform_batch_scalar", count, batchScalar);
+
+    auto batchSimd = [&]()
+    {
+        TransformBatch::ComputeWorldMatrices(transforms, 0, count, batched.data());
+        DoNotOptimize(batched.data());
+    };
+    suite.Run("transform_batch_simd", count, batchSimd);
+
+    raymath();
+    batchScalar();
+    batchSimd();
+
+    // Relative to the biggest element of the matrix, scales go up to 10 and positions to 100
+    float scalarError = 0.0f, simdError = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float16 expected = MatrixToFloatV(reference[i]);
+        float16 fromScalar = MatrixToFloatV(scalar[i]);
+        float16 fromSimd = MatrixToFloatV(batched[i]);
+        float largest = 1.0f;
+        for (float value : expected.v)
+            largest = std::max(largest, fabsf(value));
+
+        for (int j = 0; j < 16; ++j)
+        {
+            scalarError = std::max(scalarError, fabsf(fromScalar.v[j] - expected.v[j]) / largest);
+            simdError = std::max(simdError, fabsf(fromSimd.v[j] - expected.v[j]) / largest);
+        }
+    }
+
+    std::cerr << "transform batch (" << TransformBatch::GetPathName() << ") over " << count << " transforms: max relative error "
+              << scalarError << " scalar, " << simdError << " simd vs raymath\n";
+    // Same operations as raymath minus the multiplies by 0 and 1, anything past rounding noise is a wrong formula or lane
+    const float TOLERANCE = 1e-5f;
+    suite.Check("transform_batch_scalar_accuracy", scalarError <= TOLERANCE);
+    suite.Check("transform_batch_simd_accuracy", simdError <= TOLERANCE);
+}
+
+// Counts instead of doing work, so the benchmark is only the table lookups and virtual calls
+class CountingObserver : public InputObserver
+{
+public:
+    void OnInputEvent(int, InputType) override { ++events; }
+    size_t events = 0;
+};
+
+static void RegisterInputBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    // Sized so a frame delivers 10k events, way more than the editor ever sees, to make dispatch cost visible.
+    // Every key has the same number of subscribers per input type so the stream below can hit that exactly
+    const int OBSERVER_COUNT = 160;
+    const int SUBSCRIBERS_PER_KEY = 20;
+    const int EVENTS_PER_FRAME = 10000;
+    const int FRAME_COUNT = 64;
+
+    BenchRandom random(config.seed);
+    InputSystem inputSystem;
+    std::vector<CountingObserver> observers(OBSERVER_COUNT);
+    for (int type = 0; type < InputSystem::KEY_INPUT_TYPE_COUNT; ++type)
+    {
+        for (int key = 1; key < INPUT_KEY_COUNT; ++key)
+        {
+            // A run of neighbours from a random start, so the subscribers are scattered but never the same one twice
+            int first = static_cast<int>(random.Next() % OBSERVER_COUNT);
+            for (int i = 0; i < SUBSCRIBERS_PER_KEY; ++i)
+                inputSystem.RegisterObserver(&observers[(first + i) % OBSERVER_COUNT], static_cast<InputType>(type), {key});
+        }
+    }
+
+    // Synthetic key stream, every key flips with 50% chance each frame and then random keys get nudged until the
+    // frame is worth exactly EVENTS_PER_FRAME. In units of SUBSCRIBERS_PER_KEY events: a press or a hold is 1,
+    // a release is 2 (KeyReleased and IsKeyUp), staying up is 0
+    const int targetUnits = EVENTS_PER_FRAME / SUBSCRIBERS_PER_KEY;
+    std::vector<KeyBits> frames(FRAME_COUNT);
+    KeyBits lastFrame;
+    for (auto &frame : frames)
+    {
+        int units = 0;
+        for (int key = 1; key < INPUT_KEY_COUNT; ++key)
+        {
+            frame.set(key, lastFrame.test(key) != static_cast<bool>(random.Next() & 1));
+            units += lastFrame.test(key) ? (frame.test(key) ? 1 : 2) : (frame.test(key) ? 1 : 0);
+        }
+
+        // Every nudge moves the total by one. Held keys cost at least 1 each and at most targetUnits can be down
+        // after any frame, so the target is always reachable
+        while (units != targetUnits)
+        {
+            int key = 1 + static_cast<int>(random.Next() % (INPUT_KEY_COUNT - 1));
+            bool down = frame.test(key);
+            bool wasDown = lastFrame.test(key);
+            // One more: press a key that stayed up or release a held one. One less: undo a press or a release
+            if (units < targetUnits ? down == wasDown : down != wasDown)
+            {
+                frame.flip(key);
+                units += units < targetUnits ? 1 : -1;
+            }
+        }
+        lastFrame = frame;
+    }
+
+    // Every pass starts from all keys up, so each one delivers the same events as the first
+    auto dispatch = [&]()
+    {
+        inputSystem.Update(KeyBits(), false);
+        for (const auto &frame : frames)
+            inputSystem.Update(frame);
+    };
+
+    // One pass up front to check the stream really is worth EVENTS_PER_FRAME
+    dispatch();
+    size_t eventsPerPass = 0;
+    for (const auto &observer : observers)
+        eventsPerPass += observer.events;
+    suite.Check("input_dispatch_events_per_frame", eventsPerPass == static_cast<size_t>(EVENTS_PER_FRAME) * FRAME_COUNT);
+
+    suite.Run("input_dispatch", eventsPerPass, dispatch);
+    std::cerr << "input_dispatch delivers " << eventsPerPass / FRAME_COUNT << " events per frame\n";
+
+    // W pressed while the keys go elsewhere (flying with the camera, typing) and still held once they come back
+    // mustn't show up as a new press then
+    {
+        InputSystem suppressedInput;
+        CountingObserver pressed;
+        suppressedInput.RegisterObserver(&pressed, InputType::KeyPressed, {KEY_W});
+        KeyBits held;
+        held.set(KEY_W);
+
+        suppressedInput.Update(KeyBits());
+        for (int i = 0; i < 3; ++i)
+            suppressedInput.Update(held, false);
+        suppressedInput.Update(held);
+        bool noFakePress = pressed.events == 0;
+
+        // A real press afterwards still gets through
+        suppressedInput.Update(KeyBits());
+        suppressedInput.Update(held);
+        suite.Check("input_no_press_after_suppression", noFakePress && pressed.events == 1);
+    }
+
+    // Same key stream through an ActionMap with a few hundred chords, every press is one table lookup
+    class CountingActionObserver : public ActionObserver
+    {
+    public:
+        void OnAction(InputAction) override { ++actions; }
+        size_t actions = 0;
+    };
+
+    InputSystem actionInput;
+    ActionMap actionMap;
+    CountingActionObserver actionObserver;
+    for (int i = 0; i < 256; ++i)
+    {
+        auto action = static_cast<InputAction>(1 + random.Next() % (INPUT_ACTION_COUNT - 1));
+        int key = 1 + static_cast<int>(random.Next() % (INPUT_KEY_COUNT - 1));
+        actionMap.Bind(action, key, static_cast<uint8_t>(random.Next() % INPUT_MODIFIER_COMBOS));
+    }
+    actionMap.Attach(actionInput);
+    for (int i = 1; i < INPUT_ACTION_COUNT; ++i)
+        actionMap.Subscribe(&actionObserver, {static_cast<InputAction>(i)});
+
+    auto actionDispatch = [&]()
+    {
+        actionInput.Update(KeyBits(), false);
+        for (const auto &frame : frames)
+            actionInput.Update(frame);
+    };
+
+    size_t pressesPerPass = 0;
+    KeyBits previous;
+    for (const auto &frame : frames)
+    {
+        pressesPerPass += (frame & ~previous).count();
+        previous = frame;
+    }
+
+    suite.Run("action_dispatch", pressesPerPass, actionDispatch);
+}
+
+static void RegisterLevelFileBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    const int MODEL_FILES = 8;
+    const size_t MODEL_FILE_BYTES = 1 << 20;
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string path = (directory / "level_bench.lvl").string();
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+
+    // Some model entities pointing at dummy files, nothing here can turn them into models but LoadLevel prefetches them
+    std::vector<std::string> modelPaths;
+    for (int i = 0; i < MODEL_FILES; ++i)
+    {
+        modelPaths.push_back((directory / ("level_bench_model" + std::to_string(i) + ".glb")).string());
+        std::ofstream modelFile(modelPaths.back(), std::ios::binary);
+        std::vector<char> bytes(MODEL_FILE_BYTES, static_cast<char>(i));
+        modelFile.write(bytes.data(), bytes.size());
+    }
+    for (size_t i = 0; i < config.entityCount / 100; ++i)
+    {
+        GameEntity *entity = new GameEntity();
+        entity->SetName("Prop");
+        entity->AddComponent<ModelComponent>()->SetFilePath(modelPaths[i % MODEL_FILES]);
+        scene.push_back(entity);
+    }
+
+    auto save = [&]()
+    {
+        SaveLevel(path, scene);
+    };
+    suite.Run("level_save", scene.size(), save);
+
+    // Make sure there is a file to load even when the save benchmark was filtered out
+    SaveLevel(path, scene);
+
+    std::vector<GameEntity *> loaded;
+    LevelLoadStats stats;
+    auto load = [&]()
+    {
+        LoadLevel(path, loaded, &stats);
+    };
+    auto unload = [&]()
+    {
+        DestroyScene(loaded);
+        AssetPrefetch::Clear();
+    };
+    auto printStages = [&](const char *name)
+    {
+        if (!config.filter.empty() && std::string(name).find(config.filter) == std::string::npos)
+            return;
+
+        // One more outside the timing, just for the stage numbers
+        load();
+        std::cerr << name << ": " << stats.entities << " entities in " << stats.chunks << " chunks, " << stats.totalMs << " ms total (header "
+                  << stats.headerMs << ", read " << stats.readMs << ", build " << stats.decodeMs << ", prefetch " << stats.models << " files / "
+                  << (stats.prefetchBytes >> 20) << " MB in " << stats.prefetchMs << " ms), " << JobSystem::GetThreadCount() << " threads\n";
+        unload();
+    };
+
+    // Without Init the builds run inline on the calling thread, only the reading and prefetching overlap
+    suite.Run("level_load", scene.size(), load, nullptr, unload);
+    printStages("level_load");
+
+    JobSystem::Init();
+    suite.Run("level_load_jobs", scene.size(), load, nullptr, unload);
+    printStages("level_load_jobs");
+    JobSystem::Shutdown();
+
+    DestroyScene(scene);
+    std::filesystem::remove(path);
+    for (const std::string &modelPath : modelPaths)
+        std::filesystem::remove(modelPath);
+}
+
+// Interning names and model paths: the common case where the string is in the pool already (also from all the
+// job threads at once, like LoadLevel does), strings it has never seen, and reading them back through the entities
+static void RegisterStringPoolBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    static const char *NAMES[] = {"Entity", "Wall", "Floor", "Crate", "Pillar", "Barrel", "Light", "Door"};
+    const size_t NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+
+    auto internExisting = [&]()
+    {
+        for (size_t i = 0; i < scene.size(); ++i)
+            scene[i]->SetName(NAMES[i % NAME_COUNT]);
+    };
+    suite.Run("string_intern_existing", scene.size(), internExisting);
+
+    auto internParallel = [&]()
+    {
+        JobSystem::ParallelFor(scene.size(), 512, [&](size_t begin, size_t end)
+                               {
+                                   for (size_t i = begin; i < end; ++i)
+                                       scene[i]->SetName(NAMES[i % NAME_COUNT]);
+                               });
+    };
+    JobSystem::Init();
+    suite.Run("string_intern_parallel", scene.size(), internParallel);
+    JobSystem::Shutdown();
+
+    // Every run needs strings the pool hasn't seen yet, making them isn't part of the timing
+    std::vector<std::string> fresh;
+    int run = 0;
+    auto makeFresh = [&]()
+    {
+        fresh.clear();
+        for (size_t i = 0; i < scene.size(); ++i)
+            fresh.push_back("assets/models/run" + std::to_string(run) + "/prop_" + std::to_string(i) + ".glb");
+        ++run;
+    };
+    auto internNew = [&]()
+    {
+        StringId last = StringPool::EMPTY;
+        for (const std::string &path : fresh)
+            last = StringPool::Intern(path);
+        DoNotOptimize(last);
+    };
+    suite.Run("string_intern_new", scene.size(), internNew, makeFresh);
+
+    auto readNames = [&]()
+    {
+        size_t characters = 0;
+        for (auto entity : scene)
+            characters += entity->GetName().size();
+        DoNotOptimize(characters);
+    };
+    suite.Run("string_read_names", scene.size(), readNames);
+
+    StringPoolStats stats = StringPool::GetStats();
+    std::cerr << "string pool: " << stats.strings << " strings, " << stats.bytes << " bytes used, " << stats.reservedBytes
+              << " reserved, names take " << sizeof(StringId) << " bytes per entity (std::string was " << sizeof(std::string) << "+)\n";
+
+    DestroyScene(scene);
+}
+
+// Rows of wall segments (the occluders) with gaps in them, props scattered between the rows at standing height,
+// looked at from outside the first row. Roughly what culling is for: a level made of rooms
+static void RegisterOcclusionBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    const int WALL_ROWS = 8;
+    const float WALL_WIDTH = 6.0f;
+
+    BenchRandom random(config.seed ^ 0x0CC1ULL);
+    float extent = GetSceneExtent(config.entityCount);
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+    for (auto entity : scene)
+        entity->EntityTransform.position.y = random.Range(0.5f, 3.0f);
+
+    float firstRowZ = -extent * 0.6f;
+    float rowSpacing = extent * 1.6f / WALL_ROWS;
+    for (int row = 0; row < WALL_ROWS; ++row)
+    {
+        for (float x = -extent; x < extent; x += WALL_WIDTH)
+        {
+            // Every now and then a doorway
+            if (random.NextFloat() < 0.2f)
+                continue;
+
+            GameEntity *wall = new GameEntity();
+            wall->SetName("Wall");
+            wall->EntityTransform.position = {x + WALL_WIDTH * 0.5f, 2.0f, firstRowZ + row * rowSpacing};
+            auto cube = wall->AddComponent<CubeComponent>();
+            cube->size = {WALL_WIDTH, 4.0f, 0.3f};
+            cube->occluder = true;
+            scene.push_back(wall);
+        }
+    }
+
+    Camera3D camera = {0};
+    camera.position = {0.0f, 1.7f, -extent * 1.2f};
+    camera.target = {0.0f, 1.7f, 0.0f};
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = 45.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+    Matrix viewProjection = OcclusionCuller::GetViewProjection(camera, 16.0f / 9.0f);
+
+    OcclusionSnapshot snapshot;
+    auto buildSnapshot = [&]()
+    {
+        OcclusionCuller::BuildSnapshot(scene, viewProjection, snapshot);
+    };
+    suite.Run("occlusion_snapshot", scene.size(), buildSnapshot);
+    buildSnapshot();
+
+    DepthRasterizer rasterizer;
+    std::vector<uint8_t> visible;
+    OcclusionStats stats;
+    auto cull = [&]()
+    {
+        OcclusionCuller::Cull(snapshot, rasterizer, visible, stats);
+    };
+    suite.Run("occlusion_cull", scene.size(), cull);
+    cull();
+
+    // Anything in front of the first row with its center on screen can't be hidden by anything, culling one is a bug
+    size_t wrong = 0;
+    for (size_t i = 0; i < scene.size(); ++i)
+    {
+        BoundingBox bounds = snapshot.bounds[i].GetBoundingBox();
+        Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+        const Matrix &m = viewProjection;
+        float x = m.m0 * center.x + m.m4 * center.y + m.m8 * center.z + m.m12;
+        float y = m.m1 * center.x + m.m5 * center.y + m.m9 * center.z + m.m13;
+        float w = m.m3 * center.x + m.m7 * center.y + m.m11 * center.z + m.m15;
+        bool onScreen = w > 0.0f && fabsf(x) < w && fabsf(y) < w;
+        if (onScreen && bounds.max.z < firstRowZ - 0.15f && !visible[i])
+            ++wrong;
+    }
+
+    std::cerr << "occlusion_cull: " << stats.occluders << " occluders (" << stats.triangles << " triangles), culled " << stats.culled
+              << " of " << stats.tested << ", " << wrong << " wrongly culled\n";
+    suite.Check("occlusion_no_wrong_culls", wrong == 0);
+
+    DestroyScene(scene);
+}
+
+// Per frame work on the job system at different thread counts, run with --entities 1000000 for the scaling numbers.
+// Every thread count has to come up with exactly what the single threaded run did
+static void RegisterJobBenchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    const int THREAD_COUNTS[] = {1, 2, 4, 8, 16};
+
+    std::vector<GameEntity *> scene = GenerateScene(config.seed, config.entityCount);
+    float extent = GetSceneExtent(config.entityCount);
+
+    Camera3D camera = {0};
+    camera.position = {extent * 1.2f, extent * 0.4f, extent * 1.2f};
+    camera.target = {0.0f, 0.0f, 0.0f};
+    camera.up = {0.0f, 1.0f, 0.0f};
+    camera.fovy = 45.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+    const float ASPECT = 16.0f / 9.0f;
+    Matrix viewProjection = OcclusionCuller::GetViewProjection(camera, ASPECT);
+
+    DrawList drawList;
+    OcclusionSnapshot snapshot;
+    DepthRasterizer rasterizer;
+    std::vector<uint8_t> visible;
+    OcclusionStats stats;
+
+    std::vector<uint8_t> expectedVisible;
+    int expectedDrawn = -1;
+    size_t mismatches = 0;
+
+    for (int threads : THREAD_COUNTS)
+    {
+        JobSystem::Init(threads);
+        std::string suffix = "_" + std::to_string(threads) + "t";
+
+        auto buildDrawList = [&]()
+        {
+            drawList.Build(scene, camera, ASPECT, nullptr, nullptr);
+        };
+        suite.Run("jobs_draw_list" + suffix, scene.size(), buildDrawList);
+
+        auto cull = [&]()
+        {
+            OcclusionCuller::BuildSnapshot(scene, viewProjection, snapshot);
+            OcclusionCuller::Cull(snapshot, rasterizer, visible, stats);
+        };
+        suite.Run("jobs_occlusion" + suffix, scene.size(), cull);
+
+        buildDrawList();
+        cull();
+        if (expectedDrawn < 0)
+        {
+            expectedDrawn = drawList.GetStats().drawn;
+            expectedVisible = visible;
+        }
+        else if (drawList.GetStats().drawn != expectedDrawn || visible != expectedVisible)
+        {
+            ++mismatches;
+        }
+    }
+    JobSystem::Shutdown();
+
+    std::cerr << "jobs: " << expectedDrawn << " of " << scene.size() << " in the draw list, " << mismatches
+              << " thread counts disagreeing with 1 thread (" << std::thread::hardware_concurrency() << " cores here)\n";
+    suite.Check("jobs_match_single_thread", mismatches == 0);
+
+    DestroyScene(scene);
+}
+
+// Text the size of a long log session made of log lines, paths and entity names. ascii is all English, mixed has some
+// accented/Cyrillic/CJK names and paths in it, cjk is mostly CJK with ASCII punctuation and numbers
+static std::string GenerateText(uint64_t seed, int nonAsciiPercent)
+{
+    const size_t TEXT_BYTES = 4 << 20;
+    const char *asciiWords[] = {"Loaded", "model", "Levels/level.lvl", "entity", "Cube", "warning:", "took", "ms", "C:/Assets/props/crate.glb", "frame"};
+    const char *otherWords[] = {"\xc3\xa9t\xc3\xa9", "\xd0\x9c\xd0\xbe\xd0\xb4\xd0\xb5\xd0\xbb\xd1\x8c", "\xe6\xa8\xa1\xe5\x9e\x8b", "\xe3\x83\xac\xe3\x83\x99\xe3\x83\xab",
+                                "\xeb\xa0\x88\xeb\xb2\xa8", "\xf0\x9f\x93\xa6"};
+
+    BenchRandom random(seed);
+    std::string text;
+    text.reserve(TEXT_BYTES + 64);
+    while (text.size() < TEXT_BYTES)
+    {
+        if (static_cast<int>(random.Next() % 100) < nonAsciiPercent)
+            text += otherWords[random.Next() % (sizeof(otherWords) / sizeof(otherWords[0]))];
+        else
+            text += asciiWords[random.Next() % (sizeof(asciiWords) / sizeof(asciiWords[0]))];
+        text += random.Next() % 12 ? ' ' : '\n';
+    }
+    return text;
+}
+
+// The utf8 headers with their ASCII fast paths against the old code point at a time loops. Vector iterators aren't
+// covered by the fast paths, so the _scalar runs go through exactly what every call used to
+static void RegisterUtf8Benchmarks(BenchSuite &suite, const BenchConfig &config)
+{
+    const std::pair<const char *, int> CORPORA[] = {{"ascii", 0}, {"mixed", 15}, {"cjk", 85}};
+
+    size_t mismatches = 0;
+    for (const auto &[corpus, nonAsciiPercent] : CORPORA)
+    {
+        const std::string text = GenerateText(config.seed, nonAsciiPercent);
+        const std::vector<char> scalarText(text.begin(), text.end());
+        const char *begin = text.data();
+        const char *end = begin + text.size();
+        const std::u16string wide = utf8::utf8to16(text);
+        const std::vector<char16_t> scalarWide(wide.begin(), wide.end());
+        std::string name = std::string("utf8_") + corpus;
+
+        bool valid = false;
+        size_t length = 0;
+        std::u16string utf16;
+        std::u32string utf32;
+        std::string narrow;
+
+        suite.Run(name + "_valid", text.size(), [&]()
+                  { valid = utf8::is_valid(begin, end); DoNotOptimize(valid); });
+        suite.Run(name + "_valid_scalar", text.size(), [&]()
+                  { valid = utf8::is_valid(scalarText.begin(), scalarText.end()); DoNotOptimize(valid); });
+
+        suite.Run(name + "_distance", text.size(), [&]()
+                  { length = utf8::unchecked::distance(begin, end); DoNotOptimize(length); });
+        suite.Run(name + "_distance_scalar", text.size(), [&]()
+                  { length = utf8::unchecked::distance(scalarText.begin(), scalarText.end()); DoNotOptimize(length); });
+
+        suite.Run(name + "_to16", text.size(), [&]()
+                  { utf16.clear(); utf8::utf8to16(begin, end, std::back_inserter(utf16)); });
+        suite.Run(name + "_to16_scalar", text.size(), [&]()
+                  { utf16.clear(); utf8::utf8to16(scalarText.begin(), scalarText.end(), std::back_inserter(utf16)); });
+
+        suite.Run(name + "_to32", text.size(), [&]()
+                  { utf32.clear(); utf8::utf8to32(begin, end, std::back_inserter(utf32)); });
+        suite.Run(name + "_to32_scalar", text.size(), [&]()
+                  { utf32.clear(); utf8::utf8to32(scalarText.begin(), scalarText.end(), std::back_inserter(utf32)); });
+
+        suite.Run(name + "_from16", wide.size(), [&]()
+                  { narrow.clear(); utf8::utf16to8(wide.data(), wide.data() + wide.size(), std::back_inserter(narrow)); });
+        suite.Run(name + "_from16_scalar", wide.size(), [&]()
+                  { narrow.clear(); utf8::utf16to8(scalarWide.begin(), scalarWide.end(), std::back_inserter(narrow)); });
+
+        // Both ways have to agree on everything
+        std::u32string scalar32;
+        utf8::utf8to32(scalarText.begin(), scalarText.end(), std::back_inserter(scalar32));
+        std::u16string fast16;
+        utf8::utf8to16(begin, end, std::back_inserter(fast16));
+        std::u32string fast32;
+        utf8::utf8to32(begin, end, std::back_inserter(fast32));
+        std::string fastNarrow;
+        utf8::utf16to8(wide.data(), wide.data() + wide.size(), std::back_inserter(fastNarrow));
+        if (!utf8::is_valid(begin, end) || fast16 != wide || fast32 != scalar32 || fastNarrow != text ||
+            static_cast<size_t>(utf8::unchecked::distance(begin, end)) != scalar32.size() ||
+            static_cast<size_t>(utf8::distance(begin, end)) != scalar32.size())
+            ++mismatches;
+    }
+
+    std::cerr << "utf8: " << mismatches << " corpora where the fast paths disagree with the scalar ones\n";
+    suite.Check("utf8_fast_paths_match", mismatches == 0);
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig config;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        auto hasValue = [&]()
+        { return i + 1 < argc; };
+
+        if (!std::strcmp(argv[i], "--entities") && hasValue())
+            config.entityCount = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--seed") && hasValue())
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--iterations") && hasValue())
+            config.iterations = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--filter") && hasValue())
+            config.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--out") && hasValue())
+            outPath = argv[++i];
+        else
+        {
+            std::cerr << "Usage: level_bench [--entities N] [--seed S] [--iterations I] [--filter name] [--out results.json]\n";
+            return 1;
+        }
+    }
+
+    if (config.iterations < 1)
+        config.iterations = 1;
+
+    BenchSuite suite(config);
+    RegisterEntityBenchmarks(suite, config);
+    RegisterAllocationBenchmarks(suite, config);
+    RegisterBoundsBenchmarks(suite, config);
+    RegisterTransformBenchmarks(suite, config);
+    RegisterInputBenchmarks(suite, config);
+    RegisterLevelFileBenchmarks(suite, config);
+    RegisterStringPoolBenchmarks(suite, config);
+    RegisterOcclusionBenchmarks(suite, config);
+    RegisterJobBenchmarks(suite, config);
+    RegisterUtf8Benchmarks(suite, config);
+
+    // Human readable summary on stderr, JSON on stdout (or the --out file)
+    for (const BenchResult &result : suite.GetResults())
+        std::cerr << result.name << ": " << result.MedianMs() << " ms median (" << result.operations << " ops)\n";
+
+    if (outPath.empty())
+    {
+        suite.WriteJson(std::cout);
+    }
+    else
+    {
+        std::ofstream out(outPath);
+        suite.WriteJson(out);
+    }
+
+    for (const std::string &check : suite.GetFailedChecks())
+        std::cerr << "FAILED check: " << check << "\n";
+    return suite.GetFailedChecks().empty() ? 0 : 1;
+}
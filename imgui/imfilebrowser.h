@@ -2,12 +2,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
 #include <cstring>
 #include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "imgui.h"
@@ -48,6 +55,8 @@ namespace ImGui
 
         FileBrowser &operator=(const FileBrowser &copyFrom);
 
+        ~FileBrowser();
+
         // set the window position (in pixels)
         // default is centered
         void SetWindowPos(int posX, int posY) noexcept;
@@ -68,6 +77,9 @@ namespace ImGui
         // the browsing window is opened or not
         bool IsOpened() const noexcept;
 
+        // a directory listing is still coming in, the ui needs frames to show it
+        bool IsScanning() const noexcept { return scan_ != nullptr; }
+
         // display the browsing window if opened
         void Display();
 
@@ -117,6 +129,11 @@ namespace ImGui
         // this function will pre-fill the input dialog with a filename.
         void SetInputName(std::string_view input);
 
+        // (optional) draws an icon (eg. a thumbnail) in front of every regular file.
+        // gets the full path and the icon size, every row becomes that tall.
+        // only called for the rows in view. pass nullptr to go back to text only
+        void SetFileIconCallback(std::function<void(const std::filesystem::path &, float)> callback, float iconSize);
+
     private:
         template <class Functor>
         struct ScopeGuard
@@ -134,14 +151,70 @@ namespace ImGui
             bool isDir = false;
             std::filesystem::path name;
             std::string showName;
-            std::filesystem::path extension;
+            // lower case on windows already, so filtering never converts anything
+            std::string extension;
+        };
+
+        // directory listings are read on a worker thread. it streams the records it finds into `arrived`
+        // and hands over the whole sorted listing once it's done
+        struct DirectoryScan
+        {
+            std::mutex mutex;
+            std::vector<FileRecord> arrived;
+            std::vector<FileRecord> sorted;
+            std::string error;
+            bool done = false;
+            std::atomic<bool> cancelled{false};
+        };
+
+        // sorted listings of the directories browsed so far, shared by every browser. an entry is only used
+        // while the directory's last write time still matches, adding/removing/renaming anything changes it
+        struct CachedListing
+        {
+            std::filesystem::file_time_type writeTime;
+            std::vector<FileRecord> records;
+            std::uint64_t lastUsed = 0;
         };
 
+        struct ListingCache
+        {
+            std::mutex mutex;
+            std::map<std::filesystem::path, CachedListing> listings;
+            std::uint64_t useCounter = 0;
+        };
+
+        static constexpr size_t MaxCachedListings = 32;
+        static constexpr size_t ScanBatchSize = 512;
+
         static std::string ToLower(const std::string &s);
 
         void ToolTip(const std::string_view &s);
 
-        void UpdateFileRecords();
+        // uses the cached listing when the directory didn't change, otherwise starts a scan.
+        // opening the directory happens right here so a bad path still throws
+        void UpdateFileRecords(bool forceRescan = false);
+
+        static ListingCache &GetListingCache();
+
+        static void ScanDirectory(
+            std::shared_ptr<DirectoryScan> scan, std::filesystem::directory_iterator it,
+            std::filesystem::path directory, bool cacheable, std::filesystem::file_time_type writeTime, bool skipErrors);
+
+        static FileRecord MakeFileRecord(const std::filesystem::directory_entry &entry);
+
+        static void SortFileRecords(std::vector<FileRecord> &records);
+
+        // moves whatever the scan found since the last frame into fileRecords_
+        void PollScan();
+
+        void CancelScan();
+
+        // brings visibleRecords_ up to date with fileRecords_ and the current filter
+        void UpdateVisibleRecords();
+
+        void ResetVisibleRecords();
+
+        bool IsRecordVisible(const FileRecord &record) const;
 
         void SetCurrentDirectoryUncatched(const std::filesystem::path &pwd);
 
@@ -149,7 +222,7 @@ namespace ImGui
             const std::filesystem::path &dir,
             const std::filesystem::path &preferredFallback);
 
-        bool IsExtensionMatched(const std::filesystem::path &extension) const;
+        bool IsExtensionMatched(const std::string &extension) const;
 
         void ClearRangeSelectionState();
 
@@ -194,6 +267,15 @@ namespace ImGui
 
         std::filesystem::path currentDirectory_;
         std::vector<FileRecord> fileRecords_;
+        std::shared_ptr<DirectoryScan> scan_;
+        // joined before the next scan starts and in the destructor, never left running on its own
+        std::thread scanThread_;
+
+        // indices into fileRecords_ that pass the filters, the table only draws these (and only the rows in view).
+        // a scan only appends, so just the new records get filtered each frame
+        std::vector<unsigned int> visibleRecords_;
+        size_t visibleFiltered_;
+        unsigned int visibleFilterIndex_;
 
         unsigned int rangeSelectionStart_; // enable range selection when shift is pressed
         std::set<std::filesystem::path> selectedFilenames_;
@@ -203,6 +285,9 @@ namespace ImGui
         std::vector<char> inputNameBuffer_;
         std::string customizedInputName_;
 
+        std::function<void(const std::filesystem::path &, float)> fileIconCallback_;
+        float fileIconSize_;
+
         bool editDir_;
         bool setFocusToEditDir_;
         std::vector<char> currDirBuffer_;
@@ -214,7 +299,7 @@ namespace ImGui
 } // namespace ImGui
 
 inline ImGui::FileBrowser::FileBrowser(ImGuiFileBrowserFlags flags, std::filesystem::path defaultDirectory)
-    : width_(700), height_(450), posX_(0), posY_(0), flags_(flags), defaultDirectory_(std::move(defaultDirectory)), shouldOpen_(false), shouldClose_(false), isOpened_(false), isOk_(false), isPosSet_(false), rangeSelectionStart_(0), editDir_(false), setFocusToEditDir_(false)
+    : width_(700), height_(450), posX_(0), posY_(0), flags_(flags), defaultDirectory_(std::move(defaultDirectory)), shouldOpen_(false), shouldClose_(false), isOpened_(false), isOk_(false), isPosSet_(false), typeFilterIndex_(0), hasAllFilter_(false), visibleFiltered_(0), visibleFilterIndex_(0), rangeSelectionStart_(0), fileIconSize_(0.0f), editDir_(false), setFocusToEditDir_(false)
 {
     assert(!((flags_ & ImGuiFileBrowserFlags_SelectDirectory) && (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)) &&
            "'EnterNewFilename' doesn't work when 'SelectDirectory' is enabled");
@@ -241,6 +326,11 @@ inline ImGui::FileBrowser::FileBrowser(const FileBrowser &copyFrom)
     *this = copyFrom;
 }
 
+inline ImGui::FileBrowser::~FileBrowser()
+{
+    CancelScan();
+}
+
 inline ImGui::FileBrowser &ImGui::FileBrowser::operator=(
     const FileBrowser &copyFrom)
 {
@@ -268,14 +358,20 @@ inline ImGui::FileBrowser &ImGui::FileBrowser::operator=(
     selectedFilenames_ = copyFrom.selectedFilenames_;
     rangeSelectionStart_ = copyFrom.rangeSelectionStart_;
 
+    // a scan that's still running stays with copyFrom, this one keeps what arrived so far
+    CancelScan();
     currentDirectory_ = copyFrom.currentDirectory_;
     fileRecords_ = copyFrom.fileRecords_;
+    ResetVisibleRecords();
 
     openNewDirLabel_ = copyFrom.openNewDirLabel_;
     newDirNameBuffer_ = copyFrom.newDirNameBuffer_;
     inputNameBuffer_ = copyFrom.inputNameBuffer_;
     customizedInputName_ = copyFrom.customizedInputName_;
 
+    fileIconCallback_ = copyFrom.fileIconCallback_;
+    fileIconSize_ = copyFrom.fileIconSize_;
+
     editDir_ = copyFrom.editDir_;
     currDirBuffer_ = copyFrom.currDirBuffer_;
 
@@ -338,6 +434,8 @@ inline bool ImGui::FileBrowser::IsOpened() const noexcept
 
 inline void ImGui::FileBrowser::Display()
 {
+    PollScan();
+
     PushID(this);
     ScopeGuard exitThis([this]
                         {
@@ -541,7 +639,7 @@ inline void ImGui::FileBrowser::Display()
         drives_ = GetDrivesBitMask();
 #endif
 
-        UpdateFileRecords();
+        UpdateFileRecords(true);
 
         std::set<std::filesystem::path> newSelectedFilenames;
         for (auto &name : selectedFilenames_)
@@ -620,127 +718,138 @@ inline void ImGui::FileBrowser::Display()
         ScopeGuard endChild([]
                             { EndChild(); });
 
-        const bool shouldHideRegularFiles =
-            (flags_ & ImGuiFileBrowserFlags_HideRegularFiles) && (flags_ & ImGuiFileBrowserFlags_SelectDirectory);
+        UpdateVisibleRecords();
 
-        for (unsigned int rscIndex = 0; rscIndex < fileRecords_.size(); ++rscIndex)
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(visibleRecords_.size()));
+        while (clipper.Step())
         {
-            const auto &rsc = fileRecords_[rscIndex];
-            if (!rsc.isDir && shouldHideRegularFiles)
-            {
-                continue;
-            }
-            if (!rsc.isDir && !IsExtensionMatched(rsc.extension))
-            {
-                continue;
-            }
-            if (!rsc.name.empty() && rsc.name.c_str()[0] == '$')
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
             {
-                continue;
-            }
+                const unsigned int rscIndex = visibleRecords_[row];
+                const auto &rsc = fileRecords_[rscIndex];
 
-            const bool selected = selectedFilenames_.find(rsc.name) != selectedFilenames_.end();
+                const bool selected = selectedFilenames_.find(rsc.name) != selectedFilenames_.end();
 
 #if IMGUI_VERSION_NUM >= 19100
-            const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_NoAutoClosePopups;
+                const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_NoAutoClosePopups;
 #else
-            const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_DontClosePopups;
+                const ImGuiSelectableFlags selectableFlag = ImGuiSelectableFlags_DontClosePopups;
 #endif
 
-            if (Selectable(rsc.showName.c_str(), selected, selectableFlag))
-            {
-                const bool wantDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
-                const bool canSelect = rsc.name != ".." && rsc.isDir == wantDir;
-                const bool rangeSelect =
-                    canSelect && GetIO().KeyShift &&
-                    rangeSelectionStart_ < fileRecords_.size() &&
-                    (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
-                    IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
-                const bool multiSelect =
-                    !rangeSelect && GetIO().KeyCtrl &&
-                    (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
-                    IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
-
-                if (rangeSelect)
+                // icons go in front, directories get the same space so every row is as tall as the clipper expects
+                ImVec2 selectableSize(0.0f, 0.0f);
+                if (fileIconCallback_)
+                {
+                    if (rsc.isDir)
+                    {
+                        Dummy(ImVec2(fileIconSize_, fileIconSize_));
+                    }
+                    else
+                    {
+                        PushID(static_cast<int>(rscIndex));
+                        fileIconCallback_(currentDirectory_ / rsc.name, fileIconSize_);
+                        PopID();
+                    }
+                    SameLine();
+                    selectableSize.y = fileIconSize_;
+                }
+
+                if (Selectable(rsc.showName.c_str(), selected, selectableFlag, selectableSize))
                 {
-                    const unsigned int first = (std::min)(rangeSelectionStart_, rscIndex);
-                    const unsigned int last = (std::max)(rangeSelectionStart_, rscIndex);
-                    selectedFilenames_.clear();
-                    for (unsigned int i = first; i <= last; ++i)
+                    const bool wantDir = flags_ & ImGuiFileBrowserFlags_SelectDirectory;
+                    const bool canSelect = rsc.name != ".." && rsc.isDir == wantDir;
+                    const bool rangeSelect =
+                        canSelect && GetIO().KeyShift &&
+                        rangeSelectionStart_ < fileRecords_.size() &&
+                        (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
+                        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+                    const bool multiSelect =
+                        !rangeSelect && GetIO().KeyCtrl &&
+                        (flags_ & ImGuiFileBrowserFlags_MultipleSelection) &&
+                        IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows);
+
+                    if (rangeSelect)
+                    {
+                        const unsigned int first = (std::min)(rangeSelectionStart_, rscIndex);
+                        const unsigned int last = (std::max)(rangeSelectionStart_, rscIndex);
+                        selectedFilenames_.clear();
+                        for (unsigned int i = first; i <= last; ++i)
+                        {
+                            if (fileRecords_[i].isDir != wantDir)
+                            {
+                                continue;
+                            }
+                            if (!wantDir && !IsExtensionMatched(fileRecords_[i].extension))
+                            {
+                                continue;
+                            }
+                            selectedFilenames_.insert(fileRecords_[i].name);
+                        }
+                    }
+                    else if (selected)
                     {
-                        if (fileRecords_[i].isDir != wantDir)
+                        if (!multiSelect)
+                        {
+                            selectedFilenames_ = {rsc.name};
+                            rangeSelectionStart_ = rscIndex;
+                        }
+                        else
                         {
-                            continue;
+                            selectedFilenames_.erase(rsc.name);
                         }
-                        if (!wantDir && !IsExtensionMatched(fileRecords_[i].extension))
+                        if (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
                         {
-                            continue;
+                            AssignToArrayStyleString(inputNameBuffer_, "");
                         }
-                        selectedFilenames_.insert(fileRecords_[i].name);
                     }
-                }
-                else if (selected)
-                {
-                    if (!multiSelect)
+                    else if (canSelect)
                     {
-                        selectedFilenames_ = {rsc.name};
+                        if (multiSelect)
+                        {
+                            selectedFilenames_.insert(rsc.name);
+                        }
+                        else
+                        {
+                            selectedFilenames_ = {rsc.name};
+                        }
+                        if (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+                        {
+                            const auto rscName = u8StrToStr(rsc.name.u8string());
+                            AssignToArrayStyleString(inputNameBuffer_, rscName);
+                        }
                         rangeSelectionStart_ = rscIndex;
                     }
-                    else
+                }
+
+                if (IsMouseDoubleClicked(ImGuiMouseButton_Left) && IsItemHovered(ImGuiHoveredFlags_None))
+                {
+                    if (rsc.isDir)
                     {
-                        selectedFilenames_.erase(rsc.name);
+                        shouldSetNewDir = true;
+                        newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
                     }
-                    if (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
+                    else if (!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
                     {
-                        AssignToArrayStyleString(inputNameBuffer_, "");
+                        selectedFilenames_ = {rsc.name};
+                        isOk_ = true;
+                        CloseCurrentPopup();
                     }
                 }
-                else if (canSelect)
+                else if (IsKeyPressed(ImGuiKey_GamepadFaceDown) && IsItemHovered())
                 {
-                    if (multiSelect)
+                    if (rsc.isDir)
                     {
-                        selectedFilenames_.insert(rsc.name);
+                        shouldSetNewDir = true;
+                        newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
+                        SetKeyboardFocusHere(-1);
                     }
-                    else
+                    else if (!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
                     {
                         selectedFilenames_ = {rsc.name};
+                        isOk_ = true;
+                        CloseCurrentPopup();
                     }
-                    if (flags_ & ImGuiFileBrowserFlags_EnterNewFilename)
-                    {
-                        const auto rscName = u8StrToStr(rsc.name.u8string());
-                        AssignToArrayStyleString(inputNameBuffer_, rscName);
-                    }
-                    rangeSelectionStart_ = rscIndex;
-                }
-            }
-
-            if (IsMouseDoubleClicked(ImGuiMouseButton_Left) && IsItemHovered(ImGuiHoveredFlags_None))
-            {
-                if (rsc.isDir)
-                {
-                    shouldSetNewDir = true;
-                    newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
-                }
-                else if (!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
-                {
-                    selectedFilenames_ = {rsc.name};
-                    isOk_ = true;
-                    CloseCurrentPopup();
-                }
-            }
-            else if (IsKeyPressed(ImGuiKey_GamepadFaceDown) && IsItemHovered())
-            {
-                if (rsc.isDir)
-                {
-                    shouldSetNewDir = true;
-                    newDir = (rsc.name != "..") ? (currentDirectory_ / rsc.name) : currentDirectory_.parent_path();
-                    SetKeyboardFocusHere(-1);
-                }
-                else if (!(flags_ & ImGuiFileBrowserFlags_SelectDirectory))
-                {
-                    selectedFilenames_ = {rsc.name};
-                    isOk_ = true;
-                    CloseCurrentPopup();
                 }
             }
         }
@@ -832,6 +941,11 @@ inline void ImGui::FileBrowser::Display()
         SameLine();
         Text("%s", statusStr_.c_str());
     }
+    else if (scan_ && !(flags_ & ImGuiFileBrowserFlags_NoStatusBar))
+    {
+        SameLine();
+        TextDisabled("scanning... %d items", static_cast<int>(fileRecords_.size() - 1));
+    }
 
     if (!typeFilters_.empty())
     {
@@ -964,6 +1078,7 @@ inline void ImGui::FileBrowser::SetTypeFilters(const std::vector<std::string> &_
 
     std::copy(typeFilters.begin(), typeFilters.end(), std::back_inserter(typeFilters_));
     typeFilterIndex_ = 0;
+    ResetVisibleRecords();
 }
 
 inline void ImGui::FileBrowser::SetCurrentTypeFilterIndex(int index)
@@ -978,6 +1093,13 @@ inline void ImGui::FileBrowser::SetInputName(std::string_view input)
     customizedInputName_ = input;
 }
 
+inline void ImGui::FileBrowser::SetFileIconCallback(
+    std::function<void(const std::filesystem::path &, float)> callback, float iconSize)
+{
+    fileIconCallback_ = std::move(callback);
+    fileIconSize_ = iconSize;
+}
+
 inline std::string ImGui::FileBrowser::ToLower(const std::string &s)
 {
     std::string ret = s;
@@ -997,96 +1119,315 @@ inline void ImGui::FileBrowser::ToolTip(const std::string_view &s)
     ImGui::SetTooltip("%s", s.data());
 }
 
-inline void ImGui::FileBrowser::UpdateFileRecords()
+inline void ImGui::FileBrowser::UpdateFileRecords(bool forceRescan)
 {
+    CancelScan();
     fileRecords_ = {FileRecord{true, "..", "[D] ..", ""}};
+    ResetVisibleRecords();
 
-    for (auto &p : std::filesystem::directory_iterator(currentDirectory_))
+    // when the directory can't be stat'ed the listing just doesn't get cached
+    std::error_code writeTimeError;
+    const auto writeTime = last_write_time(currentDirectory_, writeTimeError);
+    const bool cacheable = !writeTimeError;
+
+    if (cacheable && !forceRescan)
     {
-        FileRecord rcd;
-        try
+        ListingCache &cache = GetListingCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        const auto it = cache.listings.find(currentDirectory_);
+        if (it != cache.listings.end() && it->second.writeTime == writeTime)
+        {
+            it->second.lastUsed = ++cache.useCounter;
+            fileRecords_ = it->second.records;
+            ClearRangeSelectionState();
+            return;
+        }
+    }
+
+    // network drives can take seconds to list, only opening the directory happens here
+    std::filesystem::directory_iterator it(currentDirectory_);
+    scan_ = std::make_shared<DirectoryScan>();
+    scanThread_ = std::thread(
+        ScanDirectory, scan_, std::move(it), currentDirectory_, cacheable, writeTime,
+        (flags_ & ImGuiFileBrowserFlags_SkipItemsCausingError) != 0);
+
+    ClearRangeSelectionState();
+}
+
+inline ImGui::FileBrowser::ListingCache &ImGui::FileBrowser::GetListingCache()
+{
+    // never destroyed, a global browser's destructor still joins its scan during static destruction
+    static ListingCache *cache = new ListingCache();
+    return *cache;
+}
+
+inline void ImGui::FileBrowser::ScanDirectory(
+    std::shared_ptr<DirectoryScan> scan, std::filesystem::directory_iterator it,
+    std::filesystem::path directory, bool cacheable, std::filesystem::file_time_type writeTime, bool skipErrors)
+{
+    std::vector<FileRecord> records = {FileRecord{true, "..", "[D] ..", ""}};
+    size_t published = records.size();
+    auto lastPublish = std::chrono::steady_clock::now();
+    std::string error;
+
+    // hands the records found since the last time to the ui thread, every few hundred or every few frames
+    auto publish = [&]()
+    {
+        std::lock_guard<std::mutex> lock(scan->mutex);
+        scan->arrived.insert(scan->arrived.end(), records.begin() + published, records.end());
+        published = records.size();
+        lastPublish = std::chrono::steady_clock::now();
+    };
+
+    // errors can't fall back to another directory anymore, whatever got listed until then stays
+    try
+    {
+        const std::filesystem::directory_iterator end;
+        while (it != end && !scan->cancelled.load(std::memory_order_relaxed))
         {
-            if (p.is_regular_file())
+            try
             {
-                rcd.isDir = false;
+                FileRecord rcd = MakeFileRecord(*it);
+                if (!rcd.name.empty())
+                {
+                    records.push_back(std::move(rcd));
+                }
             }
-            else if (p.is_directory())
+            catch (...)
             {
-                rcd.isDir = true;
+                if (!skipErrors)
+                {
+                    throw;
+                }
             }
-            else
+
+            std::error_code ec;
+            it.increment(ec);
+            if (ec)
             {
-                continue;
+                error = "error: " + ec.message();
+                break;
             }
 
-            rcd.name = p.path().filename();
-            if (rcd.name.empty())
+            if (records.size() - published >= ScanBatchSize ||
+                std::chrono::steady_clock::now() - lastPublish > std::chrono::milliseconds(30))
             {
-                continue;
+                publish();
             }
-
-            rcd.extension = p.path().filename().extension();
-            rcd.showName = (rcd.isDir ? "[D] " : "[F] ") + u8StrToStr(p.path().filename().u8string());
         }
-        catch (...)
+    }
+    catch (const std::exception &err)
+    {
+        error = std::string("error: ") + err.what();
+    }
+    catch (...)
+    {
+        error = "unknown error";
+    }
+
+    if (scan->cancelled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    SortFileRecords(records);
+
+    if (cacheable && error.empty())
+    {
+        ListingCache &cache = GetListingCache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        CachedListing &listing = cache.listings[directory];
+        listing.writeTime = writeTime;
+        listing.records = records;
+        listing.lastUsed = ++cache.useCounter;
+
+        if (cache.listings.size() > MaxCachedListings)
         {
-            if (!(flags_ & ImGuiFileBrowserFlags_SkipItemsCausingError))
-            {
-                throw;
-            }
-            continue;
+            const auto oldest = std::min_element(
+                cache.listings.begin(), cache.listings.end(), [](const auto &l, const auto &r)
+                { return l.second.lastUsed < r.second.lastUsed; });
+            cache.listings.erase(oldest);
         }
-        fileRecords_.push_back(rcd);
     }
 
+    std::lock_guard<std::mutex> lock(scan->mutex);
+    scan->sorted = std::move(records);
+    scan->error = std::move(error);
+    scan->done = true;
+}
+
+inline ImGui::FileBrowser::FileRecord ImGui::FileBrowser::MakeFileRecord(const std::filesystem::directory_entry &entry)
+{
+    FileRecord rcd;
+    if (entry.is_regular_file())
+    {
+        rcd.isDir = false;
+    }
+    else if (entry.is_directory())
+    {
+        rcd.isDir = true;
+    }
+    else
+    {
+        return rcd;
+    }
+
+    rcd.name = entry.path().filename();
+    if (rcd.name.empty())
+    {
+        return rcd;
+    }
+
+#ifdef _WIN32
+    rcd.extension = ToLower(u8StrToStr(rcd.name.extension().u8string()));
+#else
+    rcd.extension = u8StrToStr(rcd.name.extension().u8string());
+#endif
+    rcd.showName = (rcd.isDir ? "[D] " : "[F] ") + u8StrToStr(rcd.name.u8string());
+    return rcd;
+}
+
+inline void ImGui::FileBrowser::SortFileRecords(std::vector<FileRecord> &records)
+{
     // The default lexicographical order does not meet our sorting requirements.
     // We want [b0, a0, A1] to be sorted into something like [a0, A1, b0] instead of [a0, b0, A1].
     // Therefore, here we compute a custom key for each filename for sorting.
-    if (fileRecords_.size() > 2)
+    if (records.size() <= 2)
     {
-        std::vector<std::vector<uint32_t>> keys;
-        keys.reserve(fileRecords_.size());
-        for (auto &fileRecord : fileRecords_)
+        return;
+    }
+
+    std::vector<std::vector<uint32_t>> keys;
+    keys.reserve(records.size());
+    for (auto &fileRecord : records)
+    {
+        const auto name = u8StrToStr(fileRecord.name.u8string());
+        auto &key = keys.emplace_back();
+        key.reserve(name.size() + 1);
+        key.emplace_back(!fileRecord.isDir);
+        for (char c : name)
         {
-            const auto name = u8StrToStr(fileRecord.name.u8string());
-            auto &key = keys.emplace_back();
-            key.reserve(name.size() + 1);
-            key.emplace_back(!fileRecord.isDir);
-            for (char c : name)
+            if ('A' <= c && c <= 'Z')
             {
-                if ('A' <= c && c <= 'Z')
-                {
-                    key.emplace_back(2 * (c + 'a' - 'A') + 1);
-                }
-                else
-                {
-                    key.emplace_back(2 * c);
-                }
+                key.emplace_back(2 * (c + 'a' - 'A') + 1);
+            }
+            else
+            {
+                key.emplace_back(2 * c);
             }
         }
+    }
+
+    std::vector<uint32_t> fileRecordRemapIndices;
+    fileRecordRemapIndices.reserve(records.size());
+    for (uint32_t i = 0; i < records.size(); ++i)
+    {
+        fileRecordRemapIndices.push_back(i);
+    }
+
+    std::sort(
+        fileRecordRemapIndices.begin() + 1, fileRecordRemapIndices.end(), [&](uint32_t li, uint32_t ri)
+        { return keys[li] < keys[ri]; });
+
+    std::vector<FileRecord> remappedFileRecords;
+    remappedFileRecords.reserve(records.size());
+    for (const uint32_t index : fileRecordRemapIndices)
+    {
+        remappedFileRecords.emplace_back(std::move(records[index]));
+    }
+
+    records = std::move(remappedFileRecords);
+}
+
+inline void ImGui::FileBrowser::PollScan()
+{
+    if (!scan_)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(scan_->mutex);
+        if (!scan_->done)
+        {
+            if (!scan_->arrived.empty())
+            {
+                fileRecords_.insert(
+                    fileRecords_.end(), std::make_move_iterator(scan_->arrived.begin()), std::make_move_iterator(scan_->arrived.end()));
+                scan_->arrived.clear();
+            }
+            return;
+        }
 
-        std::vector<uint32_t> fileRecordRemapIndices;
-        fileRecordRemapIndices.reserve(fileRecords_.size());
-        for (uint32_t i = 0; i < fileRecords_.size(); ++i)
+        // sorted listing replaces the streamed one, selections are by name so they survive that
+        fileRecords_ = std::move(scan_->sorted);
+        if (!scan_->error.empty())
         {
-            fileRecordRemapIndices.push_back(i);
+            statusStr_ = scan_->error;
         }
+    }
 
-        std::sort(
-            fileRecordRemapIndices.begin() + 1, fileRecordRemapIndices.end(), [&](uint32_t li, uint32_t ri)
-            { return keys[li] < keys[ri]; });
+    // done is the last thing the worker sets, this only waits for it to return
+    scanThread_.join();
+    scan_.reset();
+    ResetVisibleRecords();
+    ClearRangeSelectionState();
+}
 
-        std::vector<FileRecord> remappedFileRecords;
-        remappedFileRecords.reserve(fileRecords_.size());
-        for (const uint32_t index : fileRecordRemapIndices)
+inline void ImGui::FileBrowser::CancelScan()
+{
+    if (scan_)
+    {
+        // the worker looks at this between entries, so the join doesn't wait for the rest of the directory
+        scan_->cancelled = true;
+        if (scanThread_.joinable())
         {
-            remappedFileRecords.emplace_back(std::move(fileRecords_[index]));
+            scanThread_.join();
         }
+        scan_.reset();
+    }
+}
 
-        fileRecords_ = std::move(remappedFileRecords);
+inline void ImGui::FileBrowser::UpdateVisibleRecords()
+{
+    if (visibleFilterIndex_ != typeFilterIndex_ || visibleFiltered_ > fileRecords_.size())
+    {
+        ResetVisibleRecords();
     }
 
-    ClearRangeSelectionState();
+    for (; visibleFiltered_ < fileRecords_.size(); ++visibleFiltered_)
+    {
+        if (IsRecordVisible(fileRecords_[visibleFiltered_]))
+        {
+            visibleRecords_.push_back(static_cast<unsigned int>(visibleFiltered_));
+        }
+    }
+}
+
+inline void ImGui::FileBrowser::ResetVisibleRecords()
+{
+    visibleRecords_.clear();
+    visibleFiltered_ = 0;
+    visibleFilterIndex_ = typeFilterIndex_;
+}
+
+inline bool ImGui::FileBrowser::IsRecordVisible(const FileRecord &record) const
+{
+    const bool shouldHideRegularFiles =
+        (flags_ & ImGuiFileBrowserFlags_HideRegularFiles) && (flags_ & ImGuiFileBrowserFlags_SelectDirectory);
+    if (!record.isDir && shouldHideRegularFiles)
+    {
+        return false;
+    }
+    if (!record.isDir && !IsExtensionMatched(record.extension))
+    {
+        return false;
+    }
+    if (!record.name.empty() && record.name.c_str()[0] == '$')
+    {
+        return false;
+    }
+    return true;
 }
 
 inline void ImGui::FileBrowser::SetCurrentDirectoryUncatched(const std::filesystem::path &pwd)
@@ -1148,14 +1489,8 @@ inline bool ImGui::FileBrowser::SetCurrentDirectoryInternal(
     return false;
 }
 
-inline bool ImGui::FileBrowser::IsExtensionMatched(const std::filesystem::path &_extension) const
+inline bool ImGui::FileBrowser::IsExtensionMatched(const std::string &extension) const
 {
-#ifdef _WIN32
-    std::filesystem::path extension = ToLower(u8StrToStr(_extension.u8string()));
-#else
-    auto &extension = _extension;
-#endif
-
     // no type filters
     if (typeFilters_.empty())
     {
@@ -33,13 +33,16 @@
 
 #include "raylib.h"
 #include "rlgl.h"
+#include "raymath.h"
 
 #include "imgui.h"
 
 #include <math.h>
 #include <map>
 #include <limits>
+#include <cstddef>
 #include <cstdint>
+#include <chrono>
 
 #ifndef NO_FONT_AWESOME
 #include "extras/FA6FreeSolidFontData.h"
@@ -59,6 +62,31 @@ static bool LastShiftPressed = false;
 static bool LastAltPressed = false;
 static bool LastSuperPressed = false;
 
+// Buffered render path: every ImDrawList is copied into one streaming VBO/IBO pair and each ImDrawCmd is a single
+// indexed draw, instead of pushing every index through rlVertex into rlgl's batch.
+// The buffers are a ring holding a few frames of UI, each frame writes past the last one so the GPU can still be
+// reading the previous frames without the upload having to wait for it.
+static constexpr int StreamFrames = 3;
+static constexpr int StreamMinVertices = 1 << 16;
+
+struct StreamBuffers
+{
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+    unsigned int ibo = 0;
+    int vertexCapacity = 0;
+    int indexCapacity = 0;
+    int vertexCursor = 0;
+    int indexCursor = 0;
+};
+
+static StreamBuffers UiBuffers;
+static bool UseBufferedRendering = true;
+static rlImGuiRenderStats LastRenderStats = {};
+
+// rlDrawVertexArrayElements always draws GL_UNSIGNED_SHORT indices
+static_assert(sizeof(ImDrawIdx) == 2, "The buffered render path needs 16 bit ImDrawIdx");
+
 // internal only functions
 bool rlImGuiIsControlDown() { return IsKeyDown(KEY_RIGHT_CONTROL) || IsKeyDown(KEY_LEFT_CONTROL); }
 bool rlImGuiIsShiftDown() { return IsKeyDown(KEY_RIGHT_SHIFT) || IsKeyDown(KEY_LEFT_SHIFT); }
@@ -247,6 +275,80 @@ static void ImGuiRenderTriangles(unsigned int count, int indexStart, const ImVec
     rlEnd();
 }
 
+static void UnloadStreamBuffers(void)
+{
+    if (UiBuffers.vao != 0)
+        rlUnloadVertexArray(UiBuffers.vao);
+    if (UiBuffers.vbo != 0)
+        rlUnloadVertexBuffer(UiBuffers.vbo);
+    if (UiBuffers.ibo != 0)
+        rlUnloadVertexBuffer(UiBuffers.ibo);
+    UiBuffers = StreamBuffers();
+}
+
+// Makes sure a whole frame fits, growing to the next power of two (times the frames in flight) when it doesn't
+static void ReserveStreamBuffers(int vertexCount, int indexCount)
+{
+    if (UiBuffers.vbo != 0 && vertexCount * StreamFrames <= UiBuffers.vertexCapacity && indexCount * StreamFrames <= UiBuffers.indexCapacity)
+        return;
+
+    int vertexCapacity = StreamMinVertices;
+    while (vertexCapacity < vertexCount * StreamFrames)
+        vertexCapacity *= 2;
+    int indexCapacity = StreamMinVertices * 2;
+    while (indexCapacity < indexCount * StreamFrames)
+        indexCapacity *= 2;
+
+    UnloadStreamBuffers();
+    UiBuffers.vao = rlLoadVertexArray();
+    rlEnableVertexArray(UiBuffers.vao);
+    UiBuffers.vbo = rlLoadVertexBuffer(nullptr, vertexCapacity * (int)sizeof(ImDrawVert), true);
+    UiBuffers.ibo = rlLoadVertexBufferElement(nullptr, indexCapacity * (int)sizeof(ImDrawIdx), true);
+    rlDisableVertexArray();
+
+    UiBuffers.vertexCapacity = vertexCapacity;
+    UiBuffers.indexCapacity = indexCapacity;
+}
+
+// Default raylib shader (texture * colDiffuse * vertex color), same thing the batch would draw with
+static void SetupBufferedRenderState(void)
+{
+    rlEnableShader(rlGetShaderIdDefault());
+    int *locs = rlGetShaderLocsDefault();
+
+    Matrix mvp = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+    rlSetUniformMatrix(locs[RL_SHADER_LOC_MATRIX_MVP], mvp);
+    float white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    rlSetUniform(locs[RL_SHADER_LOC_COLOR_DIFFUSE], white, RL_SHADER_UNIFORM_VEC4, 1);
+    int textureSlot = 0;
+    rlSetUniform(locs[RL_SHADER_LOC_MAP_DIFFUSE], &textureSlot, RL_SHADER_UNIFORM_SAMPLER2D, 1);
+    rlActiveTextureSlot(0);
+
+    // No VAO on some GLES2 drivers, binding the buffers directly works everywhere
+    if (!rlEnableVertexArray(UiBuffers.vao))
+    {
+        rlEnableVertexBuffer(UiBuffers.vbo);
+        rlEnableVertexBufferElement(UiBuffers.ibo);
+    }
+    else
+    {
+        rlEnableVertexBuffer(UiBuffers.vbo);
+    }
+
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD);
+    rlEnableVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR);
+}
+
+// ImGui indices are relative to their own draw list, so the attributes get pointed at where its vertices start
+static void SetStreamVertexBase(int vertexBase)
+{
+    int base = vertexBase * (int)sizeof(ImDrawVert);
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_POSITION, 2, RL_FLOAT, false, sizeof(ImDrawVert), base + (int)offsetof(ImDrawVert, pos));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_TEXCOORD, 2, RL_FLOAT, false, sizeof(ImDrawVert), base + (int)offsetof(ImDrawVert, uv));
+    rlSetVertexAttribute(RL_DEFAULT_SHADER_ATTRIB_LOCATION_COLOR, 4, RL_UNSIGNED_BYTE, true, sizeof(ImDrawVert), base + (int)offsetof(ImDrawVert, col));
+}
+
 static void EnableScissor(float x, float y, float width, float height)
 {
     rlEnableScissorTest();
@@ -531,6 +633,21 @@ void rlImGuiEnd(void)
     ImGui_ImplRaylib_RenderDrawData(ImGui::GetDrawData());
 }
 
+void rlImGuiSetBufferedRendering(bool enabled)
+{
+    UseBufferedRendering = enabled;
+}
+
+bool rlImGuiIsBufferedRendering(void)
+{
+    return UseBufferedRendering;
+}
+
+rlImGuiRenderStats rlImGuiGetRenderStats(void)
+{
+    return LastRenderStats;
+}
+
 void rlImGuiShutdown(void)
 {
     if (GlobalContext == nullptr)
@@ -707,6 +824,7 @@ void ImGui_ImplRaylib_Shutdown()
     }
 
     ImGui_ImplRaylib_FreeBackendData();
+    UnloadStreamBuffers();
 
     io.Fonts->TexID = ImTextureID{0};
 }
@@ -716,11 +834,8 @@ void ImGui_ImplRaylib_NewFrame(void)
     ImGuiNewFrame(GetFrameTime());
 }
 
-void ImGui_ImplRaylib_RenderDrawData(ImDrawData *draw_data)
+static void RenderDrawDataBatched(ImDrawData *draw_data)
 {
-    rlDrawRenderBatchActive();
-    rlDisableBackfaceCulling();
-
     for (int l = 0; l < draw_data->CmdListsCount; ++l)
     {
         const ImDrawList *commandList = draw_data->CmdLists[l];
@@ -737,12 +852,89 @@ void ImGui_ImplRaylib_RenderDrawData(ImDrawData *draw_data)
 
             ImGuiRenderTriangles(cmd.ElemCount, cmd.IdxOffset, commandList->IdxBuffer, commandList->VtxBuffer, cmd.GetTexID());
             rlDrawRenderBatchActive();
+            ++LastRenderStats.drawCalls;
         }
     }
 
     rlSetTexture(0);
+}
+
+static void RenderDrawDataBuffered(ImDrawData *draw_data)
+{
+    ReserveStreamBuffers(draw_data->TotalVtxCount, draw_data->TotalIdxCount);
+
+    // Whole frame goes in one piece, back to the start when it doesn't fit behind the last one anymore
+    if (UiBuffers.vertexCursor + draw_data->TotalVtxCount > UiBuffers.vertexCapacity || UiBuffers.indexCursor + draw_data->TotalIdxCount > UiBuffers.indexCapacity)
+    {
+        UiBuffers.vertexCursor = 0;
+        UiBuffers.indexCursor = 0;
+    }
+
+    rlDisableDepthTest();
+    SetupBufferedRenderState();
+
+    for (int l = 0; l < draw_data->CmdListsCount; ++l)
+    {
+        const ImDrawList *commandList = draw_data->CmdLists[l];
+        int vertexCount = commandList->VtxBuffer.Size;
+        int indexCount = commandList->IdxBuffer.Size;
+
+        rlUpdateVertexBuffer(UiBuffers.vbo, commandList->VtxBuffer.Data, vertexCount * (int)sizeof(ImDrawVert), UiBuffers.vertexCursor * (int)sizeof(ImDrawVert));
+        rlUpdateVertexBufferElements(UiBuffers.ibo, commandList->IdxBuffer.Data, indexCount * (int)sizeof(ImDrawIdx), UiBuffers.indexCursor * (int)sizeof(ImDrawIdx));
+        LastRenderStats.uploadBytes += vertexCount * (int)sizeof(ImDrawVert) + indexCount * (int)sizeof(ImDrawIdx);
+        SetStreamVertexBase(UiBuffers.vertexCursor);
+
+        for (const auto &cmd : commandList->CmdBuffer)
+        {
+            EnableScissor(cmd.ClipRect.x - draw_data->DisplayPos.x, cmd.ClipRect.y - draw_data->DisplayPos.y, cmd.ClipRect.z - (cmd.ClipRect.x - draw_data->DisplayPos.x), cmd.ClipRect.w - (cmd.ClipRect.y - draw_data->DisplayPos.y));
+            if (cmd.UserCallback != nullptr)
+            {
+                // Could have drawn anything with any state, put ours back
+                cmd.UserCallback(commandList, &cmd);
+                SetupBufferedRenderState();
+                SetStreamVertexBase(UiBuffers.vertexCursor);
+                continue;
+            }
+
+            if (cmd.ElemCount == 0)
+                continue;
+
+            rlEnableTexture(static_cast<unsigned int>(cmd.GetTexID()));
+            rlDrawVertexArrayElements(UiBuffers.indexCursor + (int)cmd.IdxOffset, (int)cmd.ElemCount, nullptr);
+            ++LastRenderStats.drawCalls;
+        }
+
+        UiBuffers.vertexCursor += vertexCount;
+        UiBuffers.indexCursor += indexCount;
+    }
+
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    rlDisableTexture();
+    rlDisableShader();
+}
+
+void ImGui_ImplRaylib_RenderDrawData(ImDrawData *draw_data)
+{
+    auto start = std::chrono::steady_clock::now();
+    LastRenderStats = {};
+    LastRenderStats.vertices = draw_data->TotalVtxCount;
+    LastRenderStats.indices = draw_data->TotalIdxCount;
+    LastRenderStats.buffered = UseBufferedRendering;
+
+    rlDrawRenderBatchActive();
+    rlDisableBackfaceCulling();
+
+    if (UseBufferedRendering && draw_data->TotalVtxCount > 0)
+        RenderDrawDataBuffered(draw_data);
+    else
+        RenderDrawDataBatched(draw_data);
+
     rlDisableScissorTest();
     rlEnableBackfaceCulling();
+
+    LastRenderStats.renderMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 void HandleGamepadButtonEvent(ImGuiIO &io, GamepadButton button, ImGuiKey key)
@@ -89,6 +89,36 @@ extern "C"
     /// </summary>
     RLIMGUIAPI void rlImGuiEnd(void);
 
+    /// <summary>
+    /// What the last rlImGuiEnd drew and how long the render backend took for it (CPU side)
+    /// </summary>
+    typedef struct rlImGuiRenderStats
+    {
+        int vertices;
+        int indices;
+        int drawCalls;
+        int uploadBytes;
+        float renderMs;
+        bool buffered;
+    } rlImGuiRenderStats;
+
+    /// <summary>
+    /// Picks how the UI gets drawn. Buffered (default) streams the ImDrawList vertex/index buffers into a VBO/IBO
+    /// and does one indexed draw per draw command, otherwise every index goes through rlVertex into rlgl's batch
+    /// </summary>
+    /// <param name="enabled">true for the buffered path, false for the rlgl batch</param>
+    RLIMGUIAPI void rlImGuiSetBufferedRendering(bool enabled);
+
+    /// <summary>
+    /// Whether the buffered render path is in use
+    /// </summary>
+    RLIMGUIAPI bool rlImGuiIsBufferedRendering(void);
+
+    /// <summary>
+    /// Numbers from the last rlImGuiEnd
+    /// </summary>
+    RLIMGUIAPI rlImGuiRenderStats rlImGuiGetRenderStats(void);
+
     /// <summary>
     /// Cleanup ImGui and unload font atlas
     /// Calls ImGui_ImplRaylib_Shutdown
@@ -13,7 +13,7 @@
 
 #include <imgui.h>
 #include <imgui_internal.h>
-#include "../UTF8/utf8.h"
+#include "../utf8/utf8.h"
 
 // Calculates the midpoint between two numbers.
 template <typename T>
@@ -206,71 +206,113 @@ static ImVector<std::string_view> wrapText(std::string_view text, float wrapWidt
     return result;
 }
 
-ImVector<TextSelect::SubLine> TextSelect::getSubLines() const
+void TextSelect::resetSubLines()
 {
-    ImVector<SubLine> result;
+    subLines.clear();
+    subLineHead = 0;
+    cachedLines = 0;
+    lineBase = 0;
+}
 
-    std::size_t numLines = getNumLines();
+void TextSelect::updateSubLines()
+{
+    // Without wrapping every whole line is its own subline, nothing to keep
+    if (!enableWordWrap)
+    {
+        return;
+    }
 
-    // There will be at minimum `numLines` sublines.
-    result.reserve(numLines);
+    std::size_t numLines = getNumLines();
 
     ImGuiWindow *window = ImGui::GetCurrentWindow();
     const float wrapWidth = ImGui::CalcWrapWidthForPos(window->DC.CursorPos, 0);
 
-    for (std::size_t i = 0; i < numLines; ++i)
+    // Other width wraps every line differently, fewer lines than cached means the text got swapped out
+    if (wrapWidth != cachedWrapWidth || numLines < cachedLines)
+    {
+        resetSubLines();
+        cachedWrapWidth = wrapWidth;
+    }
+
+    // Only the lines added since last frame
+    for (std::size_t i = cachedLines; i < numLines; ++i)
     {
         auto wholeLine = getLineAtIdx(i);
-        if (enableWordWrap)
+        for (auto subLine : wrapText(wholeLine, wrapWidth))
         {
-            auto subLines = wrapText(wholeLine, wrapWidth);
-            for (auto subLine : subLines)
-            {
-                result.push_back({subLine, i});
-            }
+            subLines.push_back({i + lineBase, static_cast<std::uint32_t>(subLine.data() - wholeLine.data()),
+                                static_cast<std::uint32_t>(subLine.size())});
+        }
+    }
+    cachedLines = numLines;
+}
+
+std::string_view TextSelect::subLineString(std::size_t subIdx) const
+{
+    if (!enableWordWrap)
+    {
+        return getLineAtIdx(subIdx);
+    }
+
+    const SubLine &subLine = subLines[subLineHead + subIdx];
+    return getLineAtIdx(subLine.wholeLineIndex - lineBase).substr(subLine.start, subLine.length);
+}
+
+std::size_t TextSelect::subLineAtY(float y, float textHeight, float itemSpacing) const
+{
+    // Sublines only ever go down, so this is a plain binary search
+    std::size_t low = 0;
+    std::size_t high = numSubLines();
+    while (high - low > 1)
+    {
+        std::size_t mid = midpoint(low, high);
+        if (subLineMinY(mid, textHeight, itemSpacing) <= y)
+        {
+            low = mid;
         }
         else
         {
-            result.push_back({wholeLine, i});
+            high = mid;
         }
     }
-    return result;
+    return low;
 }
 
-void TextSelect::handleMouseDown(const ImVector<TextSelect::SubLine> &subLines, const ImVec2 &cursorPosStart)
+void TextSelect::handleMouseDown(const ImVec2 &cursorPosStart)
 {
-    if (subLines.size() == 0)
+    std::size_t numSub = numSubLines();
+    if (numSub == 0)
     {
         return;
     }
 
-    ImGuiWindow *window = ImGui::GetCurrentWindow();
-    const float wrapWidth = ImGui::CalcWrapWidthForPos(window->DC.CursorPos, 0);
     const float textHeight = ImGui::GetTextLineHeight();
     const float itemSpacing = ImGui::GetCurrentContext()->Style.ItemSpacing.y;
     ImVec2 mousePos = ImGui::GetMousePos() - cursorPosStart;
 
     // Find the index of the sub line under the cursor.
+    // Subline i takes over from the bottom of subline i - 1, including the spacing when it starts a new whole line.
+    // That only goes down, so binary search for the last one the mouse is past.
     std::size_t subY = 0;
-    float accumulatedHeight = textHeight;
-    for (std::size_t i = 1; i < subLines.size(); ++i)
+    std::size_t low = 1;
+    std::size_t high = numSub;
+    while (low < high)
     {
-        if (mousePos.y < accumulatedHeight)
+        std::size_t mid = midpoint(low, high);
+        if (mid * textHeight + wholeLineOf(mid - 1) * itemSpacing <= mousePos.y)
         {
-            break;
+            subY = mid;
+            low = mid + 1;
         }
-        ++subY;
-        accumulatedHeight += textHeight;
-        // Don't add spacing between sublines, only between whole lines.
-        if (subLines[i].wholeLineIndex != subLines[i - 1].wholeLineIndex)
+        else
         {
-            accumulatedHeight += itemSpacing;
+            high = mid;
         }
     }
 
-    std::string_view currentSubLine = subLines[subY].string;
+    std::string_view currentSubLine = subLineString(subY);
 
-    std::size_t wholeY = subLines[subY].wholeLineIndex;
+    std::size_t wholeY = wholeLineOf(subY);
 
     std::string_view currentWholeLine = getLineAtIdx(wholeY);
 
@@ -288,14 +330,14 @@ void TextSelect::handleMouseDown(const ImVector<TextSelect::SubLine> &subLines,
 
             // Find the first sub line in the whole line
             std::size_t firstSubLineIndex = subY;
-            while (firstSubLineIndex > 0 && subLines[firstSubLineIndex - 1].wholeLineIndex == subLines[firstSubLineIndex].wholeLineIndex)
+            while (firstSubLineIndex > 0 && wholeLineOf(firstSubLineIndex - 1) == wholeY)
             {
                 --firstSubLineIndex;
             }
 
             // Find the last sub line in the whole line
             std::size_t lastSubLineIndex = subY;
-            while (lastSubLineIndex < subLines.size() - 1 && subLines[lastSubLineIndex + 1].wholeLineIndex == subLines[lastSubLineIndex].wholeLineIndex)
+            while (lastSubLineIndex < numSub - 1 && wholeLineOf(lastSubLineIndex + 1) == wholeY)
             {
                 ++lastSubLineIndex;
             }
@@ -416,7 +458,7 @@ static void drawSelectionRect(const ImVec2 &cursorPosStart, float minX, float mi
     ImGui::GetWindowDrawList()->AddRectFilled(rectMin, rectMax, color);
 }
 
-void TextSelect::drawSelection(const ImVector<TextSelect::SubLine> &subLines, const ImVec2 &cursorPosStart) const
+void TextSelect::drawSelection(const ImVec2 &cursorPosStart) const
 {
     if (!hasSelection())
     {
@@ -432,57 +474,77 @@ void TextSelect::drawSelection(const ImVector<TextSelect::SubLine> &subLines, co
         return;
     }
 
-    float accumulatedHeight = 0;
-
     ImGuiContext *context = ImGui::GetCurrentContext();
     ImGuiWindow *window = ImGui::GetCurrentWindow();
-    const float wrapWidth = ImGui::CalcWrapWidthForPos(window->DC.CursorPos, 0);
     const float newlineWidth = ImGui::CalcTextSize(" ").x;
     const float textHeight = context->FontSize;
     const float itemSpacing = context->Style.ItemSpacing.y;
 
-    for (auto subLine : subLines)
+    // Only the sublines that are in view, walking all of them gets slow with a big log
+    const float visibleMinY = window->ClipRect.Min.y - cursorPosStart.y;
+    const float visibleMaxY = window->ClipRect.Max.y - cursorPosStart.y;
+    const std::size_t numSub = numSubLines();
+
+    for (std::size_t i = subLineAtY(visibleMinY, textHeight, itemSpacing); i < numSub; ++i)
     {
-        auto wholeLine = getLineAtIdx(subLine.wholeLineIndex);
+        float minY = subLineMinY(i, textHeight, itemSpacing);
+        if (minY >= visibleMaxY)
+        {
+            break;
+        }
+
+        std::size_t wholeLineIndex = wholeLineOf(i);
+
+        // Skip whole lines before selection.
+        if (startY > wholeLineIndex)
+        {
+            continue;
+        }
+        // Skip whole lines after selection.
+        if (endY < wholeLineIndex)
+        {
+            break;
+        }
+
+        auto wholeLine = getLineAtIdx(wholeLineIndex);
+        auto subLine = subLineString(i);
 
         auto wholeLineEnd = wholeLine.data() + wholeLine.size();
 
-        const char *subLineStart = subLine.string.data();
-        const char *subLineEnd = subLine.string.data() + subLine.string.size();
+        const char *subLineStart = subLine.data();
+        const char *subLineEnd = subLine.data() + subLine.size();
 
         // Indices of sub-line bounds relative to the start of the whole line.
         std::size_t subLineStartX = utf8::distance(wholeLine.data(), subLineStart);
         std::size_t subLineEndX = utf8::distance(wholeLine.data(), subLineEnd);
 
-        float minY = accumulatedHeight;
-        accumulatedHeight += textHeight;
+        float maxY = minY + textHeight;
         // Item spacing is not applied between sub-lines
         if (subLineEnd == wholeLineEnd)
         {
             // We are rendering last sub-line.
-            accumulatedHeight += itemSpacing;
+            maxY += itemSpacing;
         }
-        float maxY = accumulatedHeight;
 
-        // Skip whole/sub lines before selection.
-        if (startY > subLine.wholeLineIndex || subLine.wholeLineIndex == startY && startX >= subLineEndX)
+        // Skip sub lines before selection.
+        if (wholeLineIndex == startY && startX >= subLineEndX)
         {
             continue;
         }
-        // Skip whole/sub lines after selection.
-        if (endY < subLine.wholeLineIndex || subLine.wholeLineIndex == endY && endX < subLineStartX)
+        // Skip sub lines after selection.
+        if (wholeLineIndex == endY && endX < subLineStartX)
         {
             break;
         }
 
         // The first and last rectangles should only extend to the selection boundaries
         // The middle rectangles (if any) enclose the entire line + some extra width for the newline.
-        bool isStartSubLine = subLine.wholeLineIndex == startY && subLineStartX <= startX && startX <= subLineEndX;
-        bool isEndSubLine = subLine.wholeLineIndex == endY && subLineStartX <= endX && endX <= subLineEndX;
+        bool isStartSubLine = wholeLineIndex == startY && subLineStartX <= startX && startX <= subLineEndX;
+        bool isEndSubLine = wholeLineIndex == endY && subLineStartX <= endX && endX <= subLineEndX;
 
-        float minX = isStartSubLine ? substringSizeX(subLine.string, 0, startX - std::min(subLineStartX, startX)) : 0;
-        float maxX = isEndSubLine ? substringSizeX(subLine.string, 0, endX - std::min(subLineStartX, endX))
-                                  : substringSizeX(subLine.string, 0) + newlineWidth;
+        float minX = isStartSubLine ? substringSizeX(subLine, 0, startX - std::min(subLineStartX, startX)) : 0;
+        float maxX = isEndSubLine ? substringSizeX(subLine, 0, endX - std::min(subLineStartX, endX))
+                                  : substringSizeX(subLine, 0) + newlineWidth;
 
         drawSelectionRect(cursorPosStart, minX, minY, maxX, maxY);
     }
@@ -534,6 +596,11 @@ void TextSelect::copy() const
 
 void TextSelect::selectAll()
 {
+    if (getNumLines() == 0)
+    {
+        return;
+    }
+
     std::size_t lastLineIdx = getNumLines() - 1;
     std::string_view lastLine = getLineAtIdx(lastLineIdx);
 
@@ -554,8 +621,8 @@ void TextSelect::update()
         ImGui::SetMouseCursor(ImGuiMouseCursor_TextInput);
     }
 
-    // Split whole lines by wrap width (if enabled).
-    auto subLines = getSubLines();
+    // Split new whole lines by wrap width (if enabled).
+    updateSubLines();
 
     // Handle mouse events
     if (ImGui::IsMouseClicked(ImGuiMouseButton_Left))
@@ -575,7 +642,7 @@ void TextSelect::update()
     {
         if (shouldHandleMouseDown)
         {
-            handleMouseDown(subLines, cursorPosStart);
+            handleMouseDown(cursorPosStart);
         }
         if (!hovered)
         {
@@ -583,7 +650,7 @@ void TextSelect::update()
         }
     }
 
-    drawSelection(subLines, cursorPosStart);
+    drawSelection(cursorPosStart);
 
     // Keyboard shortcuts
     if (ImGui::Shortcut(ImGuiMod_Ctrl | ImGuiKey_A))
@@ -595,3 +662,54 @@ void TextSelect::update()
         copy();
     }
 }
+
+void TextSelect::linesRemoved(std::size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Selection moves up with its text, if all of it got removed there's nothing left to select
+    if (hasSelection() && getSelection().endY < count)
+    {
+        selectStart = {};
+        selectEnd = {};
+    }
+    for (CursorPos *pos : {&selectStart, &selectEnd})
+    {
+        if (pos->isInvalid())
+        {
+            continue;
+        }
+        if (pos->y < count)
+        {
+            *pos = {0, 0};
+        }
+        else
+        {
+            pos->y -= count;
+        }
+    }
+
+    if (count >= cachedLines)
+    {
+        resetSubLines();
+        return;
+    }
+
+    // Sublines keep their index, lineBase moving up is what drops the front ones
+    lineBase += count;
+    cachedLines -= count;
+    while (subLineHead < subLines.size() && subLines[subLineHead].wholeLineIndex < lineBase)
+    {
+        ++subLineHead;
+    }
+
+    // Erasing the front every time would be O(n) per removed line, so only once half of it is dead
+    if (subLineHead >= 4096 && subLineHead * 2 >= subLines.size())
+    {
+        subLines.erase(subLines.begin(), subLines.begin() + subLineHead);
+        subLineHead = 0;
+    }
+}
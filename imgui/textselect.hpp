@@ -4,8 +4,11 @@
 #pragma once
 
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <memory>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <imgui.h>
 
@@ -35,9 +38,12 @@ class TextSelect {
         std::size_t endY;
     };
 
+    // Byte offsets instead of a string_view, the text of a line can move (a ring buffer reusing the slot) while
+    // the subline stays cached.
     struct SubLine {
-        std::string_view string;
-        std::size_t wholeLineIndex; // Which whole line this subline belongs to.
+        std::size_t wholeLineIndex; // Which whole line this subline belongs to, counting removed lines (see lineBase).
+        std::uint32_t start; // Byte offset into the whole line.
+        std::uint32_t length; // Length in bytes.
     };
 
     // Selection bounds
@@ -48,8 +54,30 @@ class TextSelect {
 
     // Accessor functions to get line information
     // This class only knows about line numbers so it must be provided with functions that give it text data.
-    std::function<std::string_view(std::size_t)> getLineAtIdx; // Gets the string given a line number
-    std::function<std::size_t()> getNumLines; // Gets the total number of lines
+    // Kept as plain function pointers over the stored callables, cheaper to call than std::function.
+    using GetLineFn = std::string_view (*)(const void* accessors, std::size_t idx);
+    using GetNumLinesFn = std::size_t (*)(const void* accessors);
+    std::shared_ptr<const void> accessors; // Owns the callables passed to the constructor
+    GetLineFn getLineAtIdxFn; // Gets the string given a line number
+    GetNumLinesFn getNumLinesFn; // Gets the total number of lines
+
+    std::string_view getLineAtIdx(std::size_t idx) const {
+        return getLineAtIdxFn(accessors.get(), idx);
+    }
+
+    std::size_t getNumLines() const {
+        return getNumLinesFn(accessors.get());
+    }
+
+    // Wrapped sublines of every line seen so far, only used with word wrap (otherwise a subline is just the whole
+    // line). Each frame only the lines added since the last one get wrapped, everything is redone when the wrap width
+    // changes or lines disappear without linesRemoved(), so lines are expected not to change once they're added.
+    // Sublines before subLineHead belong to removed lines, they get erased in bulk once there are enough of them.
+    std::vector<SubLine> subLines;
+    std::size_t subLineHead = 0;
+    std::size_t cachedLines = 0; // Whole lines currently in the cache
+    std::size_t lineBase = 0; // Lines removed from the front since the cache was started
+    float cachedWrapWidth = -1.0f;
 
     // Indicates whether selection should be updated. This is needed for distinguishing mouse drags that are
     // initiated by clicking the text, or different element.
@@ -61,17 +89,40 @@ class TextSelect {
     // Gets the user selection. Start and end are guaranteed to be in order.
     Selection getSelection() const;
 
-    // Splits all whole lines by wrap width if wrapping is enabled. Otherwise returns whole lines.
-    ImVector<SubLine> getSubLines() const;
+    // Brings the subline cache up to date, splitting new whole lines by wrap width if wrapping is enabled.
+    void updateSubLines();
+
+    void resetSubLines();
+
+    std::size_t numSubLines() const {
+        return enableWordWrap ? subLines.size() - subLineHead : getNumLines();
+    }
+
+    // Whole line index of a subline (0 is the first subline of line 0).
+    std::size_t wholeLineOf(std::size_t subIdx) const {
+        return enableWordWrap ? subLines[subLineHead + subIdx].wholeLineIndex - lineBase : subIdx;
+    }
+
+    // Text of a subline, a view into its whole line.
+    std::string_view subLineString(std::size_t subIdx) const;
+
+    // Y offset of a subline from the top of the text, sublines are one text line apart with item spacing after
+    // every whole line. Lets the mouse and the visible area find their sublines by binary search.
+    float subLineMinY(std::size_t subIdx, float textHeight, float itemSpacing) const {
+        return subIdx * textHeight + wholeLineOf(subIdx) * itemSpacing;
+    }
+
+    // Last subline starting at or above `y`, 0 when there are none.
+    std::size_t subLineAtY(float y, float textHeight, float itemSpacing) const;
 
     // Processes mouse down (click/drag) events.
-    void handleMouseDown(const ImVector<TextSelect::SubLine>& subLines, const ImVec2& cursorPosStart);
+    void handleMouseDown(const ImVec2& cursorPosStart);
 
     // Processes scrolling events.
     void handleScrolling() const;
 
-    // Draws the text selection rectangle in the window.
-    void drawSelection(const ImVector<TextSelect::SubLine>& subLines, const ImVec2& cursorPosStart) const;
+    // Draws the text selection rectangle in the window, only for the sublines in view.
+    void drawSelection(const ImVec2& cursorPosStart) const;
 
 public:
     // Sets the text accessor functions.
@@ -79,7 +130,12 @@ public:
     // getNumLines: Function returning a std::size_t (total number of lines of text)
     template <class T, class U>
     TextSelect(const T& getLineAtIdx, const U& getNumLines, bool enableWordWrap = false) :
-        getLineAtIdx(getLineAtIdx), getNumLines(getNumLines), enableWordWrap(enableWordWrap) {}
+        accessors(std::make_shared<const std::pair<T, U>>(getLineAtIdx, getNumLines)),
+        getLineAtIdxFn([](const void* a, std::size_t idx) -> std::string_view {
+            return static_cast<const std::pair<T, U>*>(a)->first(idx);
+        }),
+        getNumLinesFn([](const void* a) -> std::size_t { return static_cast<const std::pair<T, U>*>(a)->second(); }),
+        enableWordWrap(enableWordWrap) {}
 
     // Checks if there is an active selection in the text.
     bool hasSelection() const {
@@ -94,4 +150,8 @@ public:
 
     // Draws the text selection rectangle and handles user input.
     void update();
+
+    // Tells it that `count` lines were removed from the front (a log ring dropping its oldest lines), so the cached
+    // sublines and the selection keep pointing at the same text. Lines added at the end are picked up on their own.
+    void linesRemoved(std::size_t count);
 };
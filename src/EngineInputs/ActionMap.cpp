@@ -0,0 +1,321 @@
+#include "ActionMap.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "inputs.h"
+#include "../Logging/Logger.h"
+
+namespace
+{
+    struct KeyName
+    {
+        const char *name;
+        int key;
+    };
+
+    // Letters, digits and F-keys are handled in FindKey, these are the rest
+    const KeyName KEY_NAMES[] = {
+        {"Space", KEY_SPACE},
+        {"Escape", KEY_ESCAPE},
+        {"Enter", KEY_ENTER},
+        {"Tab", KEY_TAB},
+        {"Backspace", KEY_BACKSPACE},
+        {"Insert", KEY_INSERT},
+        {"Delete", KEY_DELETE},
+        {"Right", KEY_RIGHT},
+        {"Left", KEY_LEFT},
+        {"Down", KEY_DOWN},
+        {"Up", KEY_UP},
+        {"PageUp", KEY_PAGE_UP},
+        {"PageDown", KEY_PAGE_DOWN},
+        {"Home", KEY_HOME},
+        {"End", KEY_END},
+        {"Minus", KEY_MINUS},
+        {"Equal", KEY_EQUAL},
+        {"Comma", KEY_COMMA},
+        {"Period", KEY_PERIOD},
+        {"Slash", KEY_SLASH},
+        {"Backslash", KEY_BACKSLASH},
+        {"Semicolon", KEY_SEMICOLON},
+        {"Apostrophe", KEY_APOSTROPHE},
+        {"LeftBracket", KEY_LEFT_BRACKET},
+        {"RightBracket", KEY_RIGHT_BRACKET},
+        {"Grave", KEY_GRAVE},
+    };
+
+    bool EqualsIgnoreCase(const std::string &a, const char *b)
+    {
+        size_t length = std::char_traits<char>::length(b);
+        if (a.size() != length)
+            return false;
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+                return false;
+        }
+        return true;
+    }
+
+    std::string Trim(const std::string &text)
+    {
+        size_t start = text.find_first_not_of(" \t\r");
+        if (start == std::string::npos)
+            return "";
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+
+    int FindKey(const std::string &name)
+    {
+        if (name.size() == 1 && std::isalnum(static_cast<unsigned char>(name[0])))
+            return std::toupper(static_cast<unsigned char>(name[0])); // KEY_A..KEY_Z and KEY_ZERO..KEY_NINE are ASCII
+
+        if (name.size() >= 2 && (name[0] == 'F' || name[0] == 'f') && std::isdigit(static_cast<unsigned char>(name[1])))
+        {
+            int number = std::atoi(name.c_str() + 1);
+            if (number >= 1 && number <= 12)
+                return KEY_F1 + number - 1;
+        }
+
+        for (const KeyName &keyName : KEY_NAMES)
+        {
+            if (EqualsIgnoreCase(name, keyName.name))
+                return keyName.key;
+        }
+        return 0;
+    }
+
+    std::string GetKeyName(int key)
+    {
+        if ((key >= KEY_A && key <= KEY_Z) || (key >= KEY_ZERO && key <= KEY_NINE))
+            return std::string(1, static_cast<char>(key));
+        if (key >= KEY_F1 && key <= KEY_F12)
+            return "F" + std::to_string(key - KEY_F1 + 1);
+
+        for (const KeyName &keyName : KEY_NAMES)
+        {
+            if (keyName.key == key)
+                return keyName.name;
+        }
+        return std::to_string(key);
+    }
+
+    InputAction FindAction(const std::string &name)
+    {
+        for (int i = 1; i < INPUT_ACTION_COUNT; ++i)
+        {
+            if (EqualsIgnoreCase(name, INPUT_ACTION_NAMES[i]))
+                return static_cast<InputAction>(i);
+        }
+        return InputAction::None;
+    }
+
+    uint8_t GetModifiers(const KeyBits &keys)
+    {
+        uint8_t modifiers = MODIFIER_NONE;
+        if (keys.test(KEY_LEFT_CONTROL) || keys.test(KEY_RIGHT_CONTROL))
+            modifiers |= MODIFIER_CTRL;
+        if (keys.test(KEY_LEFT_SHIFT) || keys.test(KEY_RIGHT_SHIFT))
+            modifiers |= MODIFIER_SHIFT;
+        if (keys.test(KEY_LEFT_ALT) || keys.test(KEY_RIGHT_ALT))
+            modifiers |= MODIFIER_ALT;
+        return modifiers;
+    }
+}
+
+ActionMap::ActionMap()
+{
+    SetDefaultBindings();
+}
+
+void ActionMap::SetDefaultBindings()
+{
+    bindings = {
+        {InputAction::GizmoNone, KEY_Q},
+        {InputAction::GizmoPosition, KEY_W},
+        {InputAction::GizmoRotation, KEY_E},
+        {InputAction::GizmoScale, KEY_R},
+        {InputAction::SaveLevel, KEY_F5},
+        {InputAction::LoadLevel, KEY_F6},
+        {InputAction::ToggleTraceCapture, KEY_F9},
+        {InputAction::ToggleInputRecording, KEY_F10},
+    };
+    Compile();
+}
+
+bool ActionMap::LoadBindings(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+
+    std::vector<ActionBinding> previous = std::move(bindings);
+    bindings.clear();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos)
+        {
+            DebugWarn(path, "line", lineNumber, "is missing '='");
+            continue;
+        }
+
+        InputAction action = FindAction(Trim(line.substr(0, equals)));
+        if (action == InputAction::None)
+        {
+            DebugWarn(path, "line", lineNumber, "unknown action:", Trim(line.substr(0, equals)));
+            continue;
+        }
+
+        // Ctrl+Shift+S, last part is the key, everything before it a modifier
+        std::stringstream chord(line.substr(equals + 1));
+        std::string part;
+        std::vector<std::string> parts;
+        while (std::getline(chord, part, '+'))
+            parts.push_back(Trim(part));
+
+        uint8_t modifiers = MODIFIER_NONE;
+        bool valid = !parts.empty();
+        for (size_t i = 0; valid && i + 1 < parts.size(); ++i)
+        {
+            if (EqualsIgnoreCase(parts[i], "Ctrl"))
+                modifiers |= MODIFIER_CTRL;
+            else if (EqualsIgnoreCase(parts[i], "Shift"))
+                modifiers |= MODIFIER_SHIFT;
+            else if (EqualsIgnoreCase(parts[i], "Alt"))
+                modifiers |= MODIFIER_ALT;
+            else
+                valid = false;
+        }
+
+        int key = valid ? FindKey(parts.back()) : 0;
+        if (key == 0)
+        {
+            DebugWarn(path, "line", lineNumber, "bad key chord:", Trim(line.substr(equals + 1)));
+            continue;
+        }
+
+        ActionBinding binding = {action, key, modifiers};
+        WarnOnConflict(binding);
+        bindings.push_back(binding);
+    }
+
+    // An empty or completely broken file would leave the editor without shortcuts
+    if (bindings.empty())
+    {
+        DebugWarn("No usable bindings in", path, "keeping the old ones");
+        bindings = std::move(previous);
+    }
+
+    Compile();
+    return true;
+}
+
+void ActionMap::Bind(InputAction action, int key, uint8_t modifiers)
+{
+    if (key <= 0 || key >= INPUT_KEY_COUNT || modifiers >= INPUT_MODIFIER_COMBOS)
+    {
+        DebugError("Can't bind", INPUT_ACTION_NAMES[static_cast<int>(action)], "to key", key);
+        return;
+    }
+
+    ActionBinding binding = {action, key, modifiers};
+    WarnOnConflict(binding);
+    bindings.push_back(binding);
+    Compile();
+}
+
+void ActionMap::Compile()
+{
+    std::fill(&table[0][0], &table[0][0] + INPUT_MODIFIER_COMBOS * INPUT_KEY_COUNT, InputAction::None);
+
+    // Later bindings win, same as the order they were added in
+    for (const ActionBinding &binding : bindings)
+        table[binding.modifiers][binding.key] = binding.action;
+}
+
+void ActionMap::WarnOnConflict(const ActionBinding &binding) const
+{
+    for (const ActionBinding &existing : bindings)
+    {
+        if (existing.key == binding.key && existing.modifiers == binding.modifiers && existing.action != binding.action)
+            DebugWarn(GetChordName(binding), "was bound to", INPUT_ACTION_NAMES[static_cast<int>(existing.action)], "now", INPUT_ACTION_NAMES[static_cast<int>(binding.action)]);
+    }
+}
+
+void ActionMap::Attach(InputSystem &system)
+{
+    if (inputSystem)
+        inputSystem->UnregisterObserver(this);
+    inputSystem = &system;
+
+    for (const ActionBinding &binding : bindings)
+        inputSystem->RegisterObserver(this, InputType::KeyPressed, {binding.key});
+}
+
+void ActionMap::Subscribe(ActionObserver *observer, std::initializer_list<InputAction> actions)
+{
+    for (InputAction action : actions)
+    {
+        auto &list = observers[static_cast<int>(action)];
+        if (std::find(list.begin(), list.end(), observer) == list.end())
+            list.push_back(observer);
+    }
+}
+
+void ActionMap::Unsubscribe(ActionObserver *observer)
+{
+    for (auto &list : observers)
+        list.erase(std::remove(list.begin(), list.end(), observer), list.end());
+}
+
+bool ActionMap::ConsumeTriggered(InputAction action)
+{
+    bool wasTriggered = triggered.test(static_cast<int>(action));
+    triggered.reset(static_cast<int>(action));
+    return wasTriggered;
+}
+
+InputAction ActionMap::Resolve(int key, uint8_t modifiers) const
+{
+    if (key <= 0 || key >= INPUT_KEY_COUNT || modifiers >= INPUT_MODIFIER_COMBOS)
+        return InputAction::None;
+    return table[modifiers][key];
+}
+
+void ActionMap::OnInputEvent(int key, InputType type)
+{
+    if (type != InputType::KeyPressed || !inputSystem)
+        return;
+
+    InputAction action = Resolve(key, GetModifiers(inputSystem->GetKeyState()));
+    if (action == InputAction::None)
+        return;
+
+    triggered.set(static_cast<int>(action));
+    for (ActionObserver *observer : observers[static_cast<int>(action)])
+        observer->OnAction(action);
+}
+
+std::string ActionMap::GetChordName(const ActionBinding &binding)
+{
+    std::string name;
+    if (binding.modifiers & MODIFIER_CTRL)
+        name += "Ctrl+";
+    if (binding.modifiers & MODIFIER_SHIFT)
+        name += "Shift+";
+    if (binding.modifiers & MODIFIER_ALT)
+        name += "Alt+";
+    return name + GetKeyName(binding.key);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <bitset>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "ActionObserver.h"
+#include "InputFrame.h"
+#include "InputAction.h"
+#include "InputObserver.h"
+
+class InputSystem;
+
+enum InputModifier : uint8_t
+{
+    MODIFIER_NONE = 0,
+    MODIFIER_CTRL = 1 << 0,
+    MODIFIER_SHIFT = 1 << 1,
+    MODIFIER_ALT = 1 << 2,
+};
+
+constexpr int INPUT_MODIFIER_COMBOS = 8;
+
+struct ActionBinding
+{
+    InputAction action = InputAction::None;
+    int key = 0;
+    uint8_t modifiers = MODIFIER_NONE;
+};
+
+// Turns key presses into actions. Bindings (action -> chord) get compiled into a [modifiers][key] table,
+// so a key press is one lookup no matter how many shortcuts there are. Modifiers have to match exactly,
+// Ctrl+S doesn't also fire S.
+class ActionMap : public InputObserver
+{
+public:
+    ActionMap();
+
+    void SetDefaultBindings();
+    // One "action = Ctrl+Shift+Key" per line, # comments. Replaces the current bindings, false if the file can't be read
+    bool LoadBindings(const std::string &path);
+    void Bind(InputAction action, int key, uint8_t modifiers = MODIFIER_NONE);
+    const std::vector<ActionBinding> &GetBindings() const { return bindings; }
+
+    // Registers for the bound keys, call again after changing bindings
+    void Attach(InputSystem &inputSystem);
+
+    void Subscribe(ActionObserver *observer, std::initializer_list<InputAction> actions);
+    void Unsubscribe(ActionObserver *observer);
+
+    // For code that isn't an observer (main loop), true once per trigger
+    bool ConsumeTriggered(InputAction action);
+
+    InputAction Resolve(int key, uint8_t modifiers) const;
+    void OnInputEvent(int key, InputType type) override;
+
+    static std::string GetChordName(const ActionBinding &binding);
+
+private:
+    void Compile();
+    void WarnOnConflict(const ActionBinding &binding) const;
+
+    std::vector<ActionBinding> bindings;
+    InputAction table[INPUT_MODIFIER_COMBOS][INPUT_KEY_COUNT];
+    std::vector<ActionObserver *> observers[INPUT_ACTION_COUNT];
+    std::bitset<INPUT_ACTION_COUNT> triggered;
+    InputSystem *inputSystem = nullptr;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "InputAction.h"
+
+class ActionObserver
+{
+public:
+    virtual ~ActionObserver() = default;
+    virtual void OnAction(InputAction action) = 0;
+};
@@ -1,20 +1,25 @@
 #include "GizmoController.h"
-#include "raylib.h"
-#include "../InputType.h"
-#include "../Logging/Logger.h"
-#include <iostream>
 
 GizmoController::GizmoController(GizmoSystem &gizmoSys)
     : gizmoSystem(gizmoSys) {}
 
-void GizmoController::OnInputEvent(int key, InputType type)
+void GizmoController::OnAction(InputAction action)
 {
-    if (key == KEY_Q && type == InputType::KeyPressed)
+    switch (action)
+    {
+    case InputAction::GizmoNone:
         gizmoSystem.SetMode(GizmoMode::NONE);
-    if (key == KEY_W && type == InputType::KeyPressed)
+        break;
+    case InputAction::GizmoPosition:
         gizmoSystem.SetMode(GizmoMode::POSITION);
-    if (key == KEY_E && type == InputType::KeyPressed)
+        break;
+    case InputAction::GizmoRotation:
         gizmoSystem.SetMode(GizmoMode::ROTATION);
-    if (key == KEY_R && type == InputType::KeyPressed)
+        break;
+    case InputAction::GizmoScale:
         gizmoSystem.SetMode(GizmoMode::SCALE);
+        break;
+    default:
+        break;
+    }
 }
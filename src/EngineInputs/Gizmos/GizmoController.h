@@ -1,13 +1,13 @@
 #pragma once
 
 #include "../../LevelEditor/Gizmo.h"
-#include "../InputObserver.h"
+#include "../ActionObserver.h"
 
-class GizmoController : public InputObserver
+class GizmoController : public ActionObserver
 {
 public:
     GizmoController(GizmoSystem &gizmoSys);
-    void OnInputEvent(int key, InputType type) override;
+    void OnAction(InputAction action) override;
 
 private:
     GizmoSystem &gizmoSystem;
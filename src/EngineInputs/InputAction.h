@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Everything a shortcut can do. Names below are what bindings.cfg uses, keep both lists in the same order
+enum class InputAction : uint8_t
+{
+    None,
+    GizmoNone,
+    GizmoPosition,
+    GizmoRotation,
+    GizmoScale,
+    SaveLevel,
+    LoadLevel,
+    ToggleTraceCapture,
+    ToggleInputRecording,
+    Count,
+};
+
+constexpr int INPUT_ACTION_COUNT = static_cast<int>(InputAction::Count);
+
+constexpr const char *INPUT_ACTION_NAMES[INPUT_ACTION_COUNT] = {
+    "none",
+    "gizmo_none",
+    "gizmo_position",
+    "gizmo_rotation",
+    "gizmo_scale",
+    "save_level",
+    "load_level",
+    "toggle_trace_capture",
+    "toggle_input_recording",
+};
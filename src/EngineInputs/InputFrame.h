@@ -0,0 +1,23 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <raylib.h>
+
+// Same as raylib's MAX_KEYBOARD_KEYS, every KEY_* fits in here
+constexpr int INPUT_KEY_COUNT = 512;
+// MOUSE_BUTTON_LEFT..MOUSE_BUTTON_BACK
+constexpr int INPUT_MOUSE_BUTTON_COUNT = 7;
+
+typedef std::bitset<INPUT_KEY_COUNT> KeyBits;
+
+// Everything the editor reads from the user in one frame. Live it comes from raylib, in a replay from the recording
+struct InputFrame
+{
+    KeyBits keys;
+    Vector2 mousePosition = {0, 0};
+    Vector2 mouseWheel = {0, 0};
+    uint8_t mouseButtons = 0; // bit per MOUSE_BUTTON_*
+    // Camera after this frame's movement, replays set it directly instead of redoing the fly cam
+    Camera3D camera = {0};
+};
@@ -0,0 +1,67 @@
+#include "inputs.h"
+#include "InputState.h"
+#include <raylib.h>
+
+// The raylib side of InputSystem, kept out of inputs.cpp so the dispatch part builds without a window
+
+int InputSystem::_gamepadIndex = 0;
+
+namespace
+{
+    InputFrame PollInputFrame(const InputFrame &previous)
+    {
+        InputFrame frame;
+        frame.keys = previous.keys;
+
+        // Held keys stay held until raylib says otherwise
+        for (int key = 0; key < INPUT_KEY_COUNT; ++key)
+        {
+            if (frame.keys.test(key) && !IsKeyDown(key))
+                frame.keys.reset(key);
+        }
+
+        int key = GetKeyPressed();
+        while (key != 0)
+        {
+            // Prevent the keypressed to trigger when letting go of the key
+            if (key < INPUT_KEY_COUNT && IsKeyDown(key))
+                frame.keys.set(key);
+
+            key = GetKeyPressed();
+        }
+
+        for (int button = 0; button < INPUT_MOUSE_BUTTON_COUNT; ++button)
+        {
+            if (IsMouseButtonDown(button))
+                frame.mouseButtons |= 1 << button;
+        }
+
+        frame.mousePosition = GetMousePosition();
+        frame.mouseWheel = GetMouseWheelMoveV();
+        frame.camera = previous.camera;
+        return frame;
+    }
+}
+
+void InputSystem::BeginFrame()
+{
+    if (!IsReplaying())
+    {
+        InputState::BeginFrame(PollInputFrame(InputState::GetFrame()));
+        return;
+    }
+
+    // Out of frames, keep the last one around so nothing sees a sudden release
+    InputFrame frame = InputState::GetFrame();
+    if (!replayFinished && !replay.Next(frame))
+        replayFinished = true;
+    InputState::BeginFrame(frame);
+}
+
+// Just keeping this here in case I ever need it
+bool InputSystem::IsControllerActive(int gamepadIndex = 0)
+{
+    _gamepadIndex = gamepadIndex;
+    return IsGamepadAvailable(gamepadIndex) &&
+           (GetGamepadAxisCount(gamepadIndex) > 0);
+}
@@ -0,0 +1,182 @@
+#include "InputRecording.h"
+#include <cstring>
+#include "../Logging/Logger.h"
+
+namespace
+{
+    enum InputFrameFlags : uint8_t
+    {
+        FRAME_KEYS = 1 << 0,
+        FRAME_MOUSE = 1 << 1,
+        FRAME_BUTTONS = 1 << 2,
+        FRAME_WHEEL = 1 << 3,
+        FRAME_CAMERA = 1 << 4,
+    };
+
+    template <typename T>
+    void WritePod(std::ofstream &file, const T &value)
+    {
+        file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadPod(std::ifstream &file, T &value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    bool SameBytes(const void *a, const void *b, size_t size)
+    {
+        return std::memcmp(a, b, size) == 0;
+    }
+}
+
+bool InputRecorder::Start(const std::string &recordingPath)
+{
+    Stop();
+
+    file.open(recordingPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        DebugError("Could not open input recording for writing:", recordingPath);
+        return false;
+    }
+
+    file.write(INPUT_RECORDING_MAGIC, sizeof(INPUT_RECORDING_MAGIC));
+    WritePod(file, INPUT_RECORDING_VERSION);
+
+    path = recordingPath;
+    last = InputFrame();
+    frameCount = 0;
+    return true;
+}
+
+void InputRecorder::Stop()
+{
+    if (file.is_open())
+        file.close();
+}
+
+void InputRecorder::Write(const InputFrame &frame)
+{
+    if (!file.is_open())
+        return;
+
+    KeyBits changedKeys = frame.keys ^ last.keys;
+
+    uint8_t flags = 0;
+    if (changedKeys.any())
+        flags |= FRAME_KEYS;
+    if (!SameBytes(&frame.mousePosition, &last.mousePosition, sizeof(Vector2)))
+        flags |= FRAME_MOUSE;
+    if (frame.mouseButtons != last.mouseButtons)
+        flags |= FRAME_BUTTONS;
+    if (frame.mouseWheel.x != 0.0f || frame.mouseWheel.y != 0.0f)
+        flags |= FRAME_WHEEL;
+    if (!SameBytes(&frame.camera, &last.camera, sizeof(Camera3D)))
+        flags |= FRAME_CAMERA;
+
+    WritePod(file, flags);
+
+    if (flags & FRAME_KEYS)
+    {
+        WritePod(file, static_cast<uint16_t>(changedKeys.count()));
+        for (int key = 0; key < INPUT_KEY_COUNT; ++key)
+        {
+            if (changedKeys.test(key))
+                WritePod(file, static_cast<uint16_t>(key));
+        }
+    }
+    if (flags & FRAME_MOUSE)
+        WritePod(file, frame.mousePosition);
+    if (flags & FRAME_BUTTONS)
+        WritePod(file, frame.mouseButtons);
+    if (flags & FRAME_WHEEL)
+        WritePod(file, frame.mouseWheel);
+    if (flags & FRAME_CAMERA)
+        WritePod(file, frame.camera);
+
+    last = frame;
+    ++frameCount;
+}
+
+bool InputReplay::Open(const std::string &path)
+{
+    Close();
+
+    file.open(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        DebugError("Could not open input recording:", path);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, INPUT_RECORDING_MAGIC, sizeof(magic)) != 0 || !ReadPod(file, version))
+    {
+        DebugError("Not an input recording:", path);
+        Close();
+        return false;
+    }
+
+    if (version != INPUT_RECORDING_VERSION)
+    {
+        DebugError("Input recording has an unsupported version:", path, static_cast<int>(version));
+        Close();
+        return false;
+    }
+
+    last = InputFrame();
+    frameIndex = 0;
+    return true;
+}
+
+void InputReplay::Close()
+{
+    if (file.is_open())
+        file.close();
+}
+
+bool InputReplay::Next(InputFrame &frame)
+{
+    uint8_t flags;
+    if (!file.is_open() || !ReadPod(file, flags))
+        return false;
+
+    InputFrame next = last;
+    next.mouseWheel = {0, 0};
+
+    bool ok = true;
+    if (flags & FRAME_KEYS)
+    {
+        uint16_t count = 0;
+        ok = ReadPod(file, count);
+        for (uint16_t i = 0; ok && i < count; ++i)
+        {
+            uint16_t key;
+            ok = ReadPod(file, key) && key < INPUT_KEY_COUNT;
+            if (ok)
+                next.keys.flip(key);
+        }
+    }
+    if (ok && (flags & FRAME_MOUSE))
+        ok = ReadPod(file, next.mousePosition);
+    if (ok && (flags & FRAME_BUTTONS))
+        ok = ReadPod(file, next.mouseButtons);
+    if (ok && (flags & FRAME_WHEEL))
+        ok = ReadPod(file, next.mouseWheel);
+    if (ok && (flags & FRAME_CAMERA))
+        ok = ReadPod(file, next.camera);
+
+    if (!ok)
+    {
+        DebugError("Input recording is truncated at frame", static_cast<int>(frameIndex));
+        return false;
+    }
+
+    frame = next;
+    last = next;
+    ++frameIndex;
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include "InputFrame.h"
+
+// Input recording layout:
+//   magic "INPR" + uint32 version
+//   per frame: uint8 flags, then only the parts that changed since the previous frame
+//     keys    -> uint16 count + uint16 per key that flipped
+//     mouse   -> 2 floats, buttons -> uint8, wheel -> 2 floats (only when it moved)
+//     camera  -> raw Camera3D
+// An idle frame is a single byte, so an hour long session stays a few MB.
+
+constexpr char INPUT_RECORDING_MAGIC[4] = {'I', 'N', 'P', 'R'};
+constexpr uint32_t INPUT_RECORDING_VERSION = 1;
+
+class InputRecorder
+{
+public:
+    bool Start(const std::string &path);
+    void Stop();
+    bool IsRecording() const { return file.is_open(); }
+
+    void Write(const InputFrame &frame);
+    size_t GetFrameCount() const { return frameCount; }
+    const std::string &GetPath() const { return path; }
+
+private:
+    std::ofstream file;
+    std::string path;
+    InputFrame last;
+    size_t frameCount = 0;
+};
+
+class InputReplay
+{
+public:
+    bool Open(const std::string &path);
+    void Close();
+    bool IsOpen() const { return file.is_open(); }
+
+    // False once the recording runs out (or is broken), frame is left untouched then
+    bool Next(InputFrame &frame);
+    size_t GetFrameIndex() const { return frameIndex; }
+
+private:
+    std::ifstream file;
+    InputFrame last;
+    size_t frameIndex = 0;
+};
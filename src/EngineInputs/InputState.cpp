@@ -0,0 +1,53 @@
+#include "InputState.h"
+
+InputFrame InputState::current;
+InputFrame InputState::previous;
+
+namespace
+{
+    bool IsValidKey(int key)
+    {
+        return key > 0 && key < INPUT_KEY_COUNT;
+    }
+
+    bool IsButtonSet(uint8_t buttons, int button)
+    {
+        return button >= 0 && button < INPUT_MOUSE_BUTTON_COUNT && (buttons & (1 << button));
+    }
+}
+
+void InputState::BeginFrame(const InputFrame &frame)
+{
+    previous = current;
+    current = frame;
+}
+
+bool InputState::IsKeyDown(int key)
+{
+    return IsValidKey(key) && current.keys.test(key);
+}
+
+bool InputState::IsKeyPressed(int key)
+{
+    return IsValidKey(key) && current.keys.test(key) && !previous.keys.test(key);
+}
+
+bool InputState::IsKeyReleased(int key)
+{
+    return IsValidKey(key) && !current.keys.test(key) && previous.keys.test(key);
+}
+
+bool InputState::IsMouseButtonDown(int button)
+{
+    return IsButtonSet(current.mouseButtons, button);
+}
+
+bool InputState::IsMouseButtonPressed(int button)
+{
+    return IsButtonSet(current.mouseButtons, button) && !IsButtonSet(previous.mouseButtons, button);
+}
+
+bool InputState::IsMouseButtonReleased(int button)
+{
+    return !IsButtonSet(current.mouseButtons, button) && IsButtonSet(previous.mouseButtons, button);
+}
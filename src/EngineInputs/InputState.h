@@ -0,0 +1,28 @@
+#pragma once
+
+#include "InputFrame.h"
+
+// This frame's input for anything that isn't an InputObserver (picking, gizmo dragging, F-keys).
+// Use these instead of raylib's IsKeyPressed/GetMousePosition etc, otherwise replays can't drive it.
+class InputState
+{
+public:
+    static void BeginFrame(const InputFrame &frame);
+    static const InputFrame &GetFrame() { return current; }
+    static const InputFrame &GetPreviousFrame() { return previous; }
+
+    static bool IsKeyDown(int key);
+    static bool IsKeyPressed(int key);
+    static bool IsKeyReleased(int key);
+
+    static bool IsMouseButtonDown(int button);
+    static bool IsMouseButtonPressed(int button);
+    static bool IsMouseButtonReleased(int button);
+
+    static Vector2 GetMousePosition() { return current.mousePosition; }
+    static Vector2 GetMouseWheel() { return current.mouseWheel; }
+
+private:
+    static InputFrame current;
+    static InputFrame previous;
+};
@@ -0,0 +1,36 @@
+#include "TraceCaptureController.h"
+#include "../Logging/Logger.h"
+#include "../Profiling/TraceCapture.h"
+#include <ctime>
+#include <filesystem>
+#include <string>
+
+void TraceCaptureController::OnAction(InputAction action)
+{
+    if (action != InputAction::ToggleTraceCapture)
+        return;
+
+#ifdef PROFILER_ENABLED
+    if (TraceCapture::IsCapturing())
+    {
+        TraceCapture::Stop();
+        DebugPrint("Trace capture saved:", TraceCapture::GetPath(), "events:", static_cast<int>(TraceCapture::GetWrittenEvents()), "dropped:", static_cast<int>(TraceCapture::GetDroppedEvents()));
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories("Captures", error);
+
+    // Timestamped so a long session can have multiple captures without overwriting
+    char fileName[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(fileName, sizeof(fileName), "Captures/trace_%Y%m%d_%H%M%S.json", std::localtime(&now));
+
+    if (TraceCapture::Start(fileName))
+        DebugPrint("Trace capture started:", fileName);
+    else
+        DebugError("Could not start trace capture:", fileName);
+#else
+    DebugWarn("Trace capture needs the profiler, configure with -DENABLE_PROFILER=ON");
+#endif
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "../ActionObserver.h"
+
+// ToggleTraceCapture (F9 by default) starts/stops streaming profiler zones to Captures/trace_<time>.json
+class TraceCaptureController : public ActionObserver
+{
+public:
+    void OnAction(InputAction action) override;
+};
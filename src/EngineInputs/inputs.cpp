@@ -1,84 +1,126 @@
 #include "inputs.h"
-#include <raylib.h>
-#include <raymath.h>
+#include <algorithm>
+#include "InputState.h"
 #include "../Logging/Logger.h"
-#include <unordered_set>
 
-int InputSystem::_gamepadIndex = 0;
+// Polling raylib lives in InputPolling.cpp, this half only knows about bits so it can run headless
 
-void InputSystem::RegisterObserver(InputObserver *observer)
+InputSystem::InputSystem()
+    : subscribers(KEY_INPUT_TYPE_COUNT * INPUT_KEY_COUNT)
 {
-    DebugPrint("Observer registered");
-    DebugWarn("Observer registered");
-    DebugError("Observer registered");
-    observers.push_back(observer);
 }
 
-void InputSystem::UnregisterObserver(InputObserver *observer)
+std::vector<InputObserver *> &InputSystem::GetSubscribers(InputType type, int key)
 {
-    DebugPrint("Observer unregistered");
-    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+    return subscribers[static_cast<int>(type) * INPUT_KEY_COUNT + key];
 }
 
-void InputSystem::CheckInputs()
+void InputSystem::RegisterObserver(InputObserver *observer, InputType type, std::initializer_list<int> keys)
 {
-    std::unordered_set<int> newPressedKeys;
+    if (static_cast<int>(type) >= KEY_INPUT_TYPE_COUNT)
+    {
+        DebugError("InputSystem only dispatches keyboard input types");
+        return;
+    }
 
-    int key = GetKeyPressed();
-    while (key != 0)
+    for (int key : keys)
     {
-        // Prevent the keypressed to trigger when letting go of the key
-        if (IsKeyDown(key))
+        if (key <= 0 || key >= INPUT_KEY_COUNT)
         {
-            DebugPrint("Key Pressed: ", key);
-            newPressedKeys.insert(key);
-
-            for (auto &observer : observers)
-            {
-                observer->OnInputEvent(key, InputType::KeyPressed);
-            }
+            DebugError("Key out of range:", key);
+            continue;
         }
 
-        key = GetKeyPressed();
+        auto &list = GetSubscribers(type, key);
+        if (std::find(list.begin(), list.end(), observer) == list.end())
+            list.push_back(observer);
+        subscribedKeys[static_cast<int>(type)].set(key);
     }
+}
 
-    std::unordered_set<int> stillPressedKeys;
-
-    for (int key : currentlyPressedKeys)
+void InputSystem::UnregisterObserver(InputObserver *observer)
+{
+    for (int type = 0; type < KEY_INPUT_TYPE_COUNT; ++type)
     {
-        if (IsKeyDown(key))
-        {
-            stillPressedKeys.insert(key);
-            for (auto &observer : observers)
-            {
-                observer->OnInputEvent(key, InputType::KeyDown);
-            }
-        }
-        else
+        for (int key = 0; key < INPUT_KEY_COUNT; ++key)
         {
-            for (auto &observer : observers)
-            {
-                observer->OnInputEvent(key, InputType::KeyReleased);
-                observer->OnInputEvent(key, InputType::IsKeyUp);
-            }
+            if (!subscribedKeys[type].test(key))
+                continue;
+
+            auto &list = subscribers[type * INPUT_KEY_COUNT + key];
+            list.erase(std::remove(list.begin(), list.end(), observer), list.end());
+            if (list.empty())
+                subscribedKeys[type].reset(key);
         }
     }
+}
+
+void InputSystem::EndFrame(const Camera3D &camera)
+{
+    if (!recorder.IsRecording() || IsReplaying())
+        return;
 
-    for (int key : newPressedKeys)
+    InputFrame frame = InputState::GetFrame();
+    frame.camera = camera;
+    recorder.Write(frame);
+}
+
+bool InputSystem::StartRecording(const std::string &path)
+{
+    if (IsReplaying())
     {
-        if (IsKeyDown(key))
-        {
-            stillPressedKeys.insert(key);
-        }
+        DebugWarn("Can't record while replaying");
+        return false;
     }
+    return recorder.Start(path);
+}
+
+void InputSystem::StopRecording()
+{
+    recorder.Stop();
+}
+
+bool InputSystem::StartReplay(const std::string &path)
+{
+    recorder.Stop();
+    replayFinished = false;
+    return replay.Open(path);
+}
+
+void InputSystem::CheckInputs(bool dispatch)
+{
+    Update(InputState::GetFrame().keys, dispatch);
+}
+
+void InputSystem::Update(const KeyBits &keys, bool dispatch)
+{
+    previousKeys = currentKeys;
+    currentKeys = keys;
+    if (!dispatch)
+        return;
+
+    KeyBits changed = currentKeys ^ previousKeys;
+    KeyBits released = changed & previousKeys;
 
-    currentlyPressedKeys = std::move(stillPressedKeys);
+    Dispatch(changed & currentKeys, InputType::KeyPressed);
+    // Held since last frame, a key pressed this frame only gets its KeyDown from the next one on
+    Dispatch(currentKeys & previousKeys, InputType::KeyDown);
+    Dispatch(released, InputType::KeyReleased);
+    Dispatch(released, InputType::IsKeyUp);
 }
 
-// Just keeping this here in case I ever need it
-bool InputSystem::IsControllerActive(int gamepadIndex = 0)
+void InputSystem::Dispatch(const KeyBits &keys, InputType type)
 {
-    _gamepadIndex = gamepadIndex;
-    return IsGamepadAvailable(gamepadIndex) &&
-           (GetGamepadAxisCount(gamepadIndex) > 0);
+    KeyBits wanted = keys & subscribedKeys[static_cast<int>(type)];
+    size_t remaining = wanted.count();
+
+    for (int key = 0; remaining > 0; ++key)
+    {
+        if (!wanted.test(key))
+            continue;
+
+        --remaining;
+        for (InputObserver *observer : GetSubscribers(type, key))
+            observer->OnInputEvent(key, type);
+    }
 }
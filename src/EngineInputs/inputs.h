@@ -1,21 +1,64 @@
 #pragma once
 
-#include <raylib.h>
-#include <unordered_set>
+#include <initializer_list>
+#include <string>
 #include <vector>
+#include "InputFrame.h"
 #include "InputObserver.h"
+#include "InputRecording.h"
 
 class InputSystem
 {
 public:
-    void RegisterObserver(InputObserver *observer);
+    // Only the keyboard types go through the table (KeyPressed..IsKeyUp)
+    static constexpr int KEY_INPUT_TYPE_COUNT = 4;
+
+    InputSystem();
+
+    // Observers only hear about the keys and type they asked for, so a key nobody cares about costs nothing
+    void RegisterObserver(InputObserver *observer, InputType type, std::initializer_list<int> keys);
     void UnregisterObserver(InputObserver *observer);
-    void CheckInputs();
+
+    // Start of the frame, polls raylib (or takes the next replayed frame) and hands it to InputState
+    void BeginFrame();
+    // End of input handling, the camera has moved by now so this is where the frame gets recorded
+    void EndFrame(const Camera3D &camera);
+
+    // Dispatches this frame's keys to the observers. Call it every frame, with dispatch off while input belongs to
+    // something else (fly camera, text field): the key state still has to move along, otherwise a key held through
+    // that comes out as a fresh KeyPressed afterwards
+    void CheckInputs(bool dispatch = true);
+    // Dispatches the difference between the last state and this one, without touching raylib (replays, benchmarks)
+    void Update(const KeyBits &keys, bool dispatch = true);
+
+    bool StartRecording(const std::string &path);
+    void StopRecording();
+    bool IsRecording() const { return recorder.IsRecording(); }
+    const InputRecorder &GetRecorder() const { return recorder; }
+
+    // While replaying BeginFrame ignores raylib completely
+    bool StartReplay(const std::string &path);
+    bool IsReplaying() const { return replay.IsOpen(); }
+    bool IsReplayFinished() const { return replayFinished; }
+    size_t GetReplayFrame() const { return replay.GetFrameIndex(); }
+
+    const KeyBits &GetKeyState() const { return currentKeys; }
 
 private:
+    void Dispatch(const KeyBits &keys, InputType type);
+    std::vector<InputObserver *> &GetSubscribers(InputType type, int key);
+
     static bool IsControllerActive(int gamepadIndex);
     static int _gamepadIndex;
 
-    std::unordered_set<int> currentlyPressedKeys;
-    std::vector<InputObserver *> observers;
+    KeyBits currentKeys;
+    KeyBits previousKeys;
+
+    // [type][key] flattened, plus a mask per type so a whole type can be skipped with one AND
+    std::vector<std::vector<InputObserver *>> subscribers;
+    KeyBits subscribedKeys[KEY_INPUT_TYPE_COUNT];
+
+    InputRecorder recorder;
+    InputReplay replay;
+    bool replayFinished = false;
 };
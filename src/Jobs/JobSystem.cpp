@@ -0,0 +1,215 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Job
+    {
+        void (*function)(void *context, size_t begin, size_t end);
+        void *context;
+        size_t begin;
+        size_t end;
+        size_t grain;
+        // Items of the ParallelFor this came from that still have to run, the caller waits on it hitting 0
+        std::atomic<size_t> *remaining;
+    };
+
+    // A lock per deque is plenty, pieces are thousands of entities so they're rarely fought over
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // 0 is shared by every thread that isn't a worker (main, occlusion worker), 1.. belong to the workers
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<int> queued{0};
+    std::atomic<int> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool quit = false;
+
+    thread_local size_t queueIndex = 0;
+    thread_local uint32_t stealState = 0x9E3779B9u;
+
+    void Push(const Job &job)
+    {
+        {
+            WorkQueue &queue = *queues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+
+        // Workers bump sleeping before checking queued, so one of the two always sees the other
+        queued.fetch_add(1);
+        if (sleeping.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    bool PopOwn(Job &job)
+    {
+        WorkQueue &queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty())
+            return false;
+        job = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    // Oldest end of someone else's deque, those are the biggest pieces still left
+    bool Steal(Job &job)
+    {
+        size_t count = queues.size();
+        stealState ^= stealState << 13;
+        stealState ^= stealState >> 17;
+        stealState ^= stealState << 5;
+        size_t start = stealState % count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t victim = (start + i) % count;
+            if (victim == queueIndex)
+                continue;
+
+            WorkQueue &queue = *queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty())
+                continue;
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    // Keeps halving, pushing the back half each time, then runs what's left of the front
+    void Execute(Job job)
+    {
+        while (job.end - job.begin > job.grain)
+        {
+            size_t middle = job.begin + (job.end - job.begin) / 2;
+            Job back = job;
+            back.begin = middle;
+            Push(back);
+            job.end = middle;
+        }
+
+        job.function(job.context, job.begin, job.end);
+        job.remaining->fetch_sub(job.end - job.begin, std::memory_order_acq_rel);
+    }
+
+    bool RunOne()
+    {
+        Job job;
+        if (!PopOwn(job) && !Steal(job))
+            return false;
+
+        queued.fetch_sub(1);
+        Execute(job);
+        return true;
+    }
+
+    void WorkerLoop(size_t index)
+    {
+        queueIndex = index;
+        stealState = static_cast<uint32_t>(index * 0x9E3779B9u + 1);
+
+        while (true)
+        {
+            if (RunOne())
+                continue;
+
+            // Nothing anywhere, spin a little before going to sleep, per frame loops come in bursts
+            bool found = false;
+            for (int spin = 0; spin < 64 && !found; ++spin)
+            {
+                std::this_thread::yield();
+                found = queued.load() > 0;
+            }
+            if (found)
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            wake.wait(lock, []()
+                      { return queued.load() > 0 || quit; });
+            sleeping.fetch_sub(1);
+            if (quit)
+                return;
+        }
+    }
+}
+
+void JobSystem::Init(int threadCount)
+{
+    Shutdown();
+
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    queues.clear();
+    for (int i = 0; i < threadCount; ++i)
+        queues.push_back(std::make_unique<WorkQueue>());
+
+    quit = false;
+    for (int i = 1; i < threadCount; ++i)
+        workers.emplace_back(WorkerLoop, static_cast<size_t>(i));
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        quit = true;
+    }
+    wake.notify_all();
+
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+    queues.clear();
+    queued.store(0);
+}
+
+int JobSystem::GetThreadCount()
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void JobSystem::Run(size_t count, size_t grain, RangeFunction function, void *context)
+{
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+
+    // No one to share with, skip all the bookkeeping
+    if (workers.empty() || count <= grain)
+    {
+        function(context, 0, count);
+        return;
+    }
+
+    std::atomic<size_t> remaining{count};
+    Execute({function, context, 0, count, grain, &remaining});
+
+    // Help out instead of blocking, might end up running pieces of some other ParallelFor but those need doing too
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!RunOne())
+            std::this_thread::yield();
+    }
+}
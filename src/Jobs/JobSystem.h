@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+// Work stealing thread pool for spreading the per-entity loops over every core. Each worker has its own deque, it
+// pushes and pops at the back and whoever runs out of work steals from the front of someone else's.
+// ParallelFor is fork/join: the range keeps getting split in half with one half pushed for others to steal, and the
+// calling thread helps out until all of it is done. So it's fine to call from inside a job or from any other thread
+// (the occlusion worker does), they all share one extra deque.
+class JobSystem
+{
+public:
+    // threadCount counts the calling thread too, 0 = one per core. Without Init everything just runs inline
+    static void Init(int threadCount = 0);
+    // Only when nothing is inside ParallelFor anymore
+    static void Shutdown();
+    static int GetThreadCount();
+
+    // body(begin, end) for pieces of [0, count) of at most grain items each, returns once all of them ran.
+    // Pieces run at the same time, so body can only write to what belongs to its own range
+    template <typename Func>
+    static void ParallelFor(size_t count, size_t grain, Func &&body)
+    {
+        using Body = std::remove_reference_t<Func>;
+        Run(count, grain, [](void *context, size_t begin, size_t end)
+            { (*static_cast<Body *>(context))(begin, end); }, const_cast<void *>(static_cast<const void *>(&body)));
+    }
+
+private:
+    using RangeFunction = void (*)(void *context, size_t begin, size_t end);
+    static void Run(size_t count, size_t grain, RangeFunction function, void *context);
+};
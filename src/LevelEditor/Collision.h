@@ -0,0 +1,269 @@
+#pragma once
+
+#include <raylib.h>
+#include <raymath.h>
+#include <cfloat>
+#include <cmath>
+#include "OrientedBox.h"
+#include "../Simd.h"
+
+// Ray tests done on our side instead of raylib's GetRayCollision* (those live in the raylib library, these only need
+// the headers), so the editor core can pick and query levels without linking raylib or opening a window.
+// Distance is along the ray direction, which is expected to be normalized. Unlike raylib, things behind the ray never hit.
+class Collision
+{
+public:
+    static RayCollision RayBox(Ray ray, BoundingBox box)
+    {
+        RayCollision collision = {0};
+
+        // Slab test, inverse direction handles axis aligned rays through +-inf
+        Vector3 invDir = {1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z};
+        float t1 = (box.min.x - ray.position.x) * invDir.x;
+        float t2 = (box.max.x - ray.position.x) * invDir.x;
+        float t3 = (box.min.y - ray.position.y) * invDir.y;
+        float t4 = (box.max.y - ray.position.y) * invDir.y;
+        float t5 = (box.min.z - ray.position.z) * invDir.z;
+        float t6 = (box.max.z - ray.position.z) * invDir.z;
+
+        float tNear = fmaxf(fmaxf(fminf(t1, t2), fminf(t3, t4)), fminf(t5, t6));
+        float tFar = fminf(fminf(fmaxf(t1, t2), fmaxf(t3, t4)), fmaxf(t5, t6));
+
+        if (tFar < 0.0f || tNear > tFar)
+            return collision;
+
+        // Starting inside the box counts as hitting the far side
+        float distance = tNear >= 0.0f ? tNear : tFar;
+        collision.hit = true;
+        collision.distance = distance;
+        collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, distance));
+
+        // Normal is the face we hit, pick the axis where the point is closest to the box surface
+        Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+        Vector3 halfSize = Vector3Scale(Vector3Subtract(box.max, box.min), 0.5f);
+        Vector3 local = Vector3Subtract(collision.point, center);
+        float dx = halfSize.x > 0.0f ? fabsf(local.x) / halfSize.x : 0.0f;
+        float dy = halfSize.y > 0.0f ? fabsf(local.y) / halfSize.y : 0.0f;
+        float dz = halfSize.z > 0.0f ? fabsf(local.z) / halfSize.z : 0.0f;
+        if (dx >= dy && dx >= dz)
+            collision.normal = {local.x > 0.0f ? 1.0f : -1.0f, 0, 0};
+        else if (dy >= dz)
+            collision.normal = {0, local.y > 0.0f ? 1.0f : -1.0f, 0};
+        else
+            collision.normal = {0, 0, local.z > 0.0f ? 1.0f : -1.0f};
+
+        return collision;
+    }
+
+    // Same slab test as RayBox but in the box's own frame, the 3 slabs go through SSE together
+    static RayCollision RayOrientedBox(Ray ray, const OrientedBox &box)
+    {
+        RayCollision collision = {0};
+        Vector3 offset = Vector3Subtract(ray.position, box.center);
+        float origin[4];
+        float direction[4];
+        float tNear, tFar;
+
+#ifdef EDITOR_SSE2
+        // Transposed axes, so x*column0 + y*column1 + z*column2 is the dot with every axis at once
+        __m128 column0 = _mm_setr_ps(box.axes[0].x, box.axes[1].x, box.axes[2].x, 0.0f);
+        __m128 column1 = _mm_setr_ps(box.axes[0].y, box.axes[1].y, box.axes[2].y, 0.0f);
+        __m128 column2 = _mm_setr_ps(box.axes[0].z, box.axes[1].z, box.axes[2].z, 0.0f);
+        __m128 localOrigin = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(offset.x), column0), _mm_mul_ps(_mm_set1_ps(offset.y), column1)),
+                                        _mm_mul_ps(_mm_set1_ps(offset.z), column2));
+        __m128 localDirection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ray.direction.x), column0), _mm_mul_ps(_mm_set1_ps(ray.direction.y), column1)),
+                                           _mm_mul_ps(_mm_set1_ps(ray.direction.z), column2));
+        // Unused 4th lane gets a slab from -FLT_MAX to FLT_MAX so it never wins the min/max below
+        localDirection = _mm_add_ps(localDirection, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+        __m128 half = _mm_setr_ps(box.halfExtents.x, box.halfExtents.y, box.halfExtents.z, FLT_MAX);
+
+        __m128 invDirection = _mm_div_ps(_mm_set1_ps(1.0f), localDirection);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), half), localOrigin), invDirection);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(half, localOrigin), invDirection);
+        __m128 slabNear = _mm_min_ps(t1, t2);
+        __m128 slabFar = _mm_max_ps(t1, t2);
+
+        slabNear = _mm_max_ps(slabNear, _mm_shuffle_ps(slabNear, slabNear, _MM_SHUFFLE(1, 0, 3, 2)));
+        slabNear = _mm_max_ps(slabNear, _mm_shuffle_ps(slabNear, slabNear, _MM_SHUFFLE(2, 3, 0, 1)));
+        slabFar = _mm_min_ps(slabFar, _mm_shuffle_ps(slabFar, slabFar, _MM_SHUFFLE(1, 0, 3, 2)));
+        slabFar = _mm_min_ps(slabFar, _mm_shuffle_ps(slabFar, slabFar, _MM_SHUFFLE(2, 3, 0, 1)));
+        tNear = _mm_cvtss_f32(slabNear);
+        tFar = _mm_cvtss_f32(slabFar);
+
+        _mm_storeu_ps(origin, localOrigin);
+        _mm_storeu_ps(direction, localDirection);
+#else
+        const float half[3] = {box.halfExtents.x, box.halfExtents.y, box.halfExtents.z};
+        tNear = -FLT_MAX;
+        tFar = FLT_MAX;
+        for (int i = 0; i < 3; ++i)
+        {
+            origin[i] = Vector3DotProduct(offset, box.axes[i]);
+            direction[i] = Vector3DotProduct(ray.direction, box.axes[i]);
+            float invDirection = 1.0f / direction[i];
+            float t1 = (-half[i] - origin[i]) * invDirection;
+            float t2 = (half[i] - origin[i]) * invDirection;
+            tNear = fmaxf(tNear, fminf(t1, t2));
+            tFar = fminf(tFar, fmaxf(t1, t2));
+        }
+#endif
+
+        if (tFar < 0.0f || tNear > tFar)
+            return collision;
+
+        // Starting inside the box counts as hitting the far side
+        float distance = tNear >= 0.0f ? tNear : tFar;
+        collision.hit = true;
+        collision.distance = distance;
+        collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, distance));
+
+        // Face we hit is the axis where the local hit point is closest to the surface
+        const float halves[3] = {box.halfExtents.x, box.halfExtents.y, box.halfExtents.z};
+        int face = 0;
+        float closest = -1.0f;
+        float side = 1.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            float local = origin[i] + direction[i] * distance;
+            float ratio = halves[i] > 0.0f ? fabsf(local) / halves[i] : 0.0f;
+            if (ratio > closest)
+            {
+                closest = ratio;
+                face = i;
+                side = local > 0.0f ? 1.0f : -1.0f;
+            }
+        }
+        collision.normal = Vector3Scale(box.axes[face], side);
+
+        return collision;
+    }
+
+    // False only when the box is completely outside one of the planes, so a few boxes near the corners of the
+    // frustum pass even though they're outside (fine for culling, it only has to be conservative)
+    static bool FrustumOrientedBox(const Frustum &frustum, const OrientedBox &box)
+    {
+#ifdef EDITOR_SSE2
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        for (int group = 0; group < 8; group += 4)
+        {
+            __m128 normalX = _mm_load_ps(frustum.normalX + group);
+            __m128 normalY = _mm_load_ps(frustum.normalY + group);
+            __m128 normalZ = _mm_load_ps(frustum.normalZ + group);
+
+            __m128 centerDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, _mm_set1_ps(box.center.x)), _mm_mul_ps(normalY, _mm_set1_ps(box.center.y))),
+                                               _mm_add_ps(_mm_mul_ps(normalZ, _mm_set1_ps(box.center.z)), _mm_load_ps(frustum.distance + group)));
+
+            // How far the box reaches towards each plane, |n.axis| * extent summed over the 3 axes
+            const float halves[3] = {box.halfExtents.x, box.halfExtents.y, box.halfExtents.z};
+            __m128 radius = _mm_setzero_ps();
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normalX, _mm_set1_ps(box.axes[axis].x)), _mm_mul_ps(normalY, _mm_set1_ps(box.axes[axis].y))),
+                                        _mm_mul_ps(normalZ, _mm_set1_ps(box.axes[axis].z)));
+                radius = _mm_add_ps(radius, _mm_mul_ps(_mm_andnot_ps(signMask, dot), _mm_set1_ps(halves[axis])));
+            }
+
+            if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(centerDistance, radius), _mm_setzero_ps())))
+                return false;
+        }
+        return true;
+#else
+        for (int i = 0; i < 6; ++i)
+        {
+            Vector3 normal = {frustum.normalX[i], frustum.normalY[i], frustum.normalZ[i]};
+            float radius = fabsf(Vector3DotProduct(normal, box.axes[0])) * box.halfExtents.x +
+                           fabsf(Vector3DotProduct(normal, box.axes[1])) * box.halfExtents.y +
+                           fabsf(Vector3DotProduct(normal, box.axes[2])) * box.halfExtents.z;
+            if (Vector3DotProduct(normal, box.center) + frustum.distance[i] + radius < 0.0f)
+                return false;
+        }
+        return true;
+#endif
+    }
+
+    static RayCollision RaySphere(Ray ray, Vector3 center, float radius)
+    {
+        RayCollision collision = {0};
+
+        Vector3 toCenter = Vector3Subtract(center, ray.position);
+        float projection = Vector3DotProduct(toCenter, ray.direction);
+        float distanceSq = Vector3DotProduct(toCenter, toCenter);
+        float discriminant = radius * radius - (distanceSq - projection * projection);
+        if (discriminant < 0.0f)
+            return collision;
+
+        float offset = sqrtf(discriminant);
+        bool inside = distanceSq < radius * radius;
+        float distance = inside ? projection + offset : projection - offset;
+        if (distance < 0.0f)
+            return collision;
+
+        collision.hit = true;
+        collision.distance = distance;
+        collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, distance));
+        collision.normal = Vector3Normalize(Vector3Subtract(collision.point, center));
+        if (inside)
+            collision.normal = Vector3Negate(collision.normal);
+
+        return collision;
+    }
+
+    // Moller-Trumbore, hits from both sides
+    static RayCollision RayTriangle(Ray ray, Vector3 p1, Vector3 p2, Vector3 p3)
+    {
+        RayCollision collision = {0};
+
+        Vector3 edge1 = Vector3Subtract(p2, p1);
+        Vector3 edge2 = Vector3Subtract(p3, p1);
+        Vector3 p = Vector3CrossProduct(ray.direction, edge2);
+        float det = Vector3DotProduct(edge1, p);
+        if (fabsf(det) < 0.000001f)
+            return collision;
+
+        float invDet = 1.0f / det;
+        Vector3 tv = Vector3Subtract(ray.position, p1);
+        float u = Vector3DotProduct(tv, p) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return collision;
+
+        Vector3 q = Vector3CrossProduct(tv, edge1);
+        float v = Vector3DotProduct(ray.direction, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return collision;
+
+        float t = Vector3DotProduct(edge2, q) * invDet;
+        if (t <= 0.000001f)
+            return collision;
+
+        collision.hit = true;
+        collision.distance = t;
+        collision.normal = Vector3Normalize(Vector3CrossProduct(edge1, edge2));
+        collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, t));
+        return collision;
+    }
+
+    // Closest triangle hit, uses the CPU copy of the vertices raylib keeps around after uploading
+    static RayCollision RayMesh(Ray ray, const Mesh &mesh, Matrix transform)
+    {
+        RayCollision collision = {0};
+        if (!mesh.vertices)
+            return collision;
+
+        for (int i = 0; i < mesh.triangleCount; ++i)
+        {
+            int a = mesh.indices ? mesh.indices[i * 3 + 0] : i * 3 + 0;
+            int b = mesh.indices ? mesh.indices[i * 3 + 1] : i * 3 + 1;
+            int c = mesh.indices ? mesh.indices[i * 3 + 2] : i * 3 + 2;
+
+            Vector3 v0 = Vector3Transform({mesh.vertices[a * 3], mesh.vertices[a * 3 + 1], mesh.vertices[a * 3 + 2]}, transform);
+            Vector3 v1 = Vector3Transform({mesh.vertices[b * 3], mesh.vertices[b * 3 + 1], mesh.vertices[b * 3 + 2]}, transform);
+            Vector3 v2 = Vector3Transform({mesh.vertices[c * 3], mesh.vertices[c * 3 + 1], mesh.vertices[c * 3 + 2]}, transform);
+
+            RayCollision triangleHit = RayTriangle(ray, v0, v1, v2);
+            if (triangleHit.hit && (!collision.hit || triangleHit.distance < collision.distance))
+                collision = triangleHit;
+        }
+
+        return collision;
+    }
+};
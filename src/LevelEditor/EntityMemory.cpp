@@ -0,0 +1,330 @@
+#include "EntityMemory.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+#include "../Logging/Logger.h"
+
+namespace
+{
+    constexpr size_t SIZE_CLASSES = EntityMemory::MAX_POOLED_SIZE / EntityMemory::GRANULARITY;
+    // Header sits in the first cache line of every page, objects start after it
+    constexpr size_t PAGE_HEADER_SIZE = 64;
+    // Pages get carved out of slabs this big, keeps all of it in a few spots instead of all over the address space
+    constexpr size_t SLAB_PAGES = 16;
+
+    enum class PageOwner : uint32_t
+    {
+        Pool,
+        Arena,
+        Large,
+    };
+
+    struct PageHeader
+    {
+        PageOwner owner;
+        uint32_t sizeClass;
+        // Large only, how many bytes the allocation is
+        size_t bytes;
+    };
+
+    static_assert(sizeof(PageHeader) <= PAGE_HEADER_SIZE, "PageHeader doesn't fit in front of the objects");
+
+    char *AllocatePages(size_t bytes)
+    {
+        return static_cast<char *>(::operator new(bytes, std::align_val_t(EntityMemory::PAGE_SIZE)));
+    }
+
+    void FreePages(char *pages)
+    {
+        ::operator delete(pages, std::align_val_t(EntityMemory::PAGE_SIZE));
+    }
+
+    char *InitPage(char *page, PageOwner owner, uint32_t sizeClass, size_t bytes)
+    {
+        new (page) PageHeader{owner, sizeClass, bytes};
+        return page;
+    }
+
+    // Hands out pages one at a time from whole slabs. Whoever owns it does the locking
+    struct PageSource
+    {
+        std::vector<char *> slabs;
+        // Given back by Release, the next level reuses them instead of faulting in fresh memory
+        std::vector<char *> spare;
+        char *cursor = nullptr;
+        char *end = nullptr;
+        size_t pages = 0;
+
+        char *Take(PageOwner owner, uint32_t sizeClass)
+        {
+            if (cursor == end)
+            {
+                if (!spare.empty())
+                {
+                    slabs.push_back(spare.back());
+                    spare.pop_back();
+                }
+                else
+                {
+                    slabs.push_back(AllocatePages(SLAB_PAGES * EntityMemory::PAGE_SIZE));
+                }
+                cursor = slabs.back();
+                end = cursor + SLAB_PAGES * EntityMemory::PAGE_SIZE;
+            }
+
+            char *page = cursor;
+            cursor += EntityMemory::PAGE_SIZE;
+            ++pages;
+            return InitPage(page, owner, sizeClass, EntityMemory::PAGE_SIZE);
+        }
+
+        void Release()
+        {
+            spare.insert(spare.end(), slabs.begin(), slabs.end());
+            slabs.clear();
+            cursor = end = nullptr;
+            pages = 0;
+        }
+    };
+
+    // Pool blocks are taken and given back all the time, a spin lock is cheaper than a mutex for something this short
+    class SpinLock
+    {
+    public:
+        void lock()
+        {
+            while (flag.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        void unlock() { flag.clear(std::memory_order_release); }
+
+    private:
+        std::atomic_flag flag = ATOMIC_FLAG_INIT;
+    };
+
+    PageHeader *GetHeader(void *object)
+    {
+        return reinterpret_cast<PageHeader *>(reinterpret_cast<uintptr_t>(object) & ~(EntityMemory::PAGE_SIZE - 1));
+    }
+
+    size_t GetBlockSize(uint32_t sizeClass)
+    {
+        return (sizeClass + 1) * EntityMemory::GRANULARITY;
+    }
+
+    // One size of block. Freed ones go on an intrusive list, new pages are only bumped through when that's empty
+    struct FixedBlockPool
+    {
+        SpinLock mutex;
+        uint32_t sizeClass = 0;
+        // Shared by all the pools, see MemoryState
+        PageSource *source = nullptr;
+        std::mutex *sourceMutex = nullptr;
+        size_t pages = 0;
+        void *freeList = nullptr;
+        char *cursor = nullptr;
+        char *end = nullptr;
+        size_t live = 0;
+        size_t free = 0;
+
+        void *Allocate()
+        {
+            std::lock_guard<SpinLock> lock(mutex);
+            ++live;
+            if (freeList)
+            {
+                void *block = freeList;
+                freeList = *static_cast<void **>(block);
+                --free;
+                return block;
+            }
+
+            size_t blockSize = GetBlockSize(sizeClass);
+            if (cursor + blockSize > end)
+            {
+                char *page;
+                {
+                    std::lock_guard<std::mutex> pagesLock(*sourceMutex);
+                    page = source->Take(PageOwner::Pool, sizeClass);
+                }
+                ++pages;
+                cursor = page + PAGE_HEADER_SIZE;
+                end = page + EntityMemory::PAGE_SIZE;
+            }
+
+            void *block = cursor;
+            cursor += blockSize;
+            return block;
+        }
+
+        void Free(void *block)
+        {
+            std::lock_guard<SpinLock> lock(mutex);
+            *static_cast<void **>(block) = freeList;
+            freeList = block;
+            --live;
+            ++free;
+        }
+    };
+
+    struct MemoryState
+    {
+        FixedBlockPool pools[SIZE_CLASSES];
+        // Only locked when a pool runs out of room. Pool pages stay around for good, freed blocks get reused
+        std::mutex poolPagesMutex;
+        PageSource poolPages;
+
+        std::mutex arenaMutex;
+        PageSource arenaPages;
+        std::atomic<bool> arenaActive{false};
+        // Bumped by ReleaseLevelArena, the per thread cursors from before that point at freed pages
+        std::atomic<uint32_t> arenaGeneration{1};
+        std::atomic<size_t> arenaLive{0};
+        std::atomic<size_t> largeLive{0};
+
+        MemoryState()
+        {
+            for (size_t i = 0; i < SIZE_CLASSES; ++i)
+            {
+                pools[i].sizeClass = static_cast<uint32_t>(i);
+                pools[i].source = &poolPages;
+                pools[i].sourceMutex = &poolPagesMutex;
+            }
+        }
+    };
+
+    // Never destroyed, entities deleted during static destruction still need somewhere to go back to
+    MemoryState &GetState()
+    {
+        static MemoryState *state = new MemoryState();
+        return *state;
+    }
+
+    struct ArenaCursor
+    {
+        char *cursor = nullptr;
+        char *end = nullptr;
+        uint32_t generation = 0;
+    };
+
+    thread_local ArenaCursor arenaCursors[SIZE_CLASSES];
+
+    void *AllocateFromArena(MemoryState &state, uint32_t sizeClass)
+    {
+        size_t blockSize = GetBlockSize(sizeClass);
+        ArenaCursor &cursor = arenaCursors[sizeClass];
+        uint32_t generation = state.arenaGeneration.load(std::memory_order_acquire);
+
+        if (cursor.generation != generation || cursor.cursor + blockSize > cursor.end)
+        {
+            char *page;
+            {
+                std::lock_guard<std::mutex> lock(state.arenaMutex);
+                page = state.arenaPages.Take(PageOwner::Arena, sizeClass);
+            }
+            cursor.cursor = page + PAGE_HEADER_SIZE;
+            cursor.end = page + EntityMemory::PAGE_SIZE;
+            cursor.generation = generation;
+        }
+
+        void *block = cursor.cursor;
+        cursor.cursor += blockSize;
+        state.arenaLive.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+}
+
+void *EntityMemory::Allocate(size_t size)
+{
+    MemoryState &state = GetState();
+
+    if (size == 0)
+        size = 1;
+    if (size > MAX_POOLED_SIZE)
+    {
+        size_t bytes = (PAGE_HEADER_SIZE + size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        state.largeLive.fetch_add(1, std::memory_order_relaxed);
+        return InitPage(AllocatePages(bytes), PageOwner::Large, 0, bytes) + PAGE_HEADER_SIZE;
+    }
+
+    uint32_t sizeClass = static_cast<uint32_t>((size - 1) / GRANULARITY);
+    if (state.arenaActive.load(std::memory_order_relaxed))
+        return AllocateFromArena(state, sizeClass);
+    return state.pools[sizeClass].Allocate();
+}
+
+void EntityMemory::Free(void *object)
+{
+    if (!object)
+        return;
+
+    MemoryState &state = GetState();
+    PageHeader *header = GetHeader(object);
+    switch (header->owner)
+    {
+    case PageOwner::Pool:
+        state.pools[header->sizeClass].Free(object);
+        break;
+    case PageOwner::Arena:
+        // Memory stays where it is until the whole arena goes
+        state.arenaLive.fetch_sub(1, std::memory_order_relaxed);
+        break;
+    case PageOwner::Large:
+        state.largeLive.fetch_sub(1, std::memory_order_relaxed);
+        FreePages(reinterpret_cast<char *>(header));
+        break;
+    }
+}
+
+void EntityMemory::BeginLevelArena()
+{
+    GetState().arenaActive.store(true, std::memory_order_release);
+}
+
+void EntityMemory::EndLevelArena()
+{
+    GetState().arenaActive.store(false, std::memory_order_release);
+}
+
+bool EntityMemory::ReleaseLevelArena()
+{
+    MemoryState &state = GetState();
+    size_t live = state.arenaLive.load(std::memory_order_acquire);
+    if (live > 0)
+    {
+        DebugWarn("Level arena still has", static_cast<int>(live), "objects alive, keeping it");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(state.arenaMutex);
+    state.arenaPages.Release();
+    state.arenaGeneration.fetch_add(1, std::memory_order_acq_rel);
+    return true;
+}
+
+EntityMemoryStats EntityMemory::GetStats()
+{
+    MemoryState &state = GetState();
+    EntityMemoryStats stats;
+
+    for (auto &pool : state.pools)
+    {
+        std::lock_guard<SpinLock> lock(pool.mutex);
+        stats.poolPages += pool.pages;
+        stats.poolLive += pool.live;
+        stats.poolLiveBytes += pool.live * GetBlockSize(pool.sizeClass);
+        stats.poolFree += pool.free;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state.arenaMutex);
+        stats.arenaPages = state.arenaPages.pages;
+    }
+    stats.arenaLive = state.arenaLive.load(std::memory_order_relaxed);
+    stats.largeLive = state.largeLive.load(std::memory_order_relaxed);
+    return stats;
+}
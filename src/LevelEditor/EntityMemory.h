@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+struct EntityMemoryStats
+{
+    size_t poolPages = 0;
+    size_t poolLive = 0;
+    size_t poolLiveBytes = 0;
+    // Blocks on the free lists, what fragmentation looks like here (freed slots between live ones)
+    size_t poolFree = 0;
+    size_t arenaPages = 0;
+    size_t arenaLive = 0;
+    size_t largeLive = 0;
+};
+
+// Where GameEntities and Components come from, their operator new/delete go through here.
+// Objects are grouped by size (16 byte steps, so in practice one pool per type) into 64KB pages, the same type ends
+// up next to each other in memory and making one is popping a free list or bumping a pointer instead of a malloc.
+// Between BeginLevelArena and EndLevelArena (LoadLevel) everything comes out of the level arena instead: every thread
+// bumps through its own page per size, nothing gets locked, and ReleaseLevelArena hands all of it back at once.
+// Pages are aligned to their size and start with a header, so Free finds the owner from the pointer alone.
+class EntityMemory
+{
+public:
+    static constexpr size_t PAGE_SIZE = 64 * 1024;
+    static constexpr size_t GRANULARITY = 16;
+    // Bigger than this gets a page (or a few) of its own, nothing in the editor is close
+    static constexpr size_t MAX_POOLED_SIZE = 1024;
+
+    static void *Allocate(size_t size);
+    static void Free(void *object);
+
+    // Not nested, the loading thread calls these around the bulk create (the job threads creating in between count too)
+    static void BeginLevelArena();
+    static void EndLevelArena();
+    // Drops every arena page in one go (they stay around for the next load). Only does it once nothing from the arena
+    // is alive anymore, returns whether it did
+    static bool ReleaseLevelArena();
+
+    static EntityMemoryStats GetStats();
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "gameEntity.h"
+
+template <typename... Ts>
+struct ViewItem
+{
+    GameEntity *entity;
+    // Position in the entity list, for whatever is kept per entity (world matrices, visibility flags, pick ids)
+    uint32_t index;
+    std::tuple<Ts *...> components;
+
+    template <typename T>
+    T *Get() const { return std::get<T *>(components); }
+};
+
+// Every entity that has all of Ts, packed together with its component pointers and in entity order. Scanning the
+// entities only happens when something structural changed since the last Update (see GameEntity::GetStructureVersion)
+// or it's a different list, every other frame it hands back the same items.
+template <typename... Ts>
+class EntityView
+{
+public:
+    static_assert(sizeof...(Ts) > 0, "A view needs at least one component type");
+    static constexpr ComponentMask MASK = (GetComponentBit<Ts>() | ...);
+
+    const std::vector<ViewItem<Ts...>> &Update(const std::vector<GameEntity *> &entities)
+    {
+        uint32_t version = GameEntity::GetStructureVersion();
+        if (built && version == builtVersion && entities.data() == source && entities.size() == sourceSize)
+            return items;
+
+        items.clear();
+        for (size_t i = 0; i < entities.size(); ++i)
+        {
+            GameEntity *entity = entities[i];
+            if ((entity->GetComponentMask() & MASK) == MASK)
+                items.push_back({entity, static_cast<uint32_t>(i), std::tuple<Ts *...>(entity->GetComponent<Ts>()...)});
+        }
+
+        built = true;
+        builtVersion = version;
+        source = entities.data();
+        sourceSize = entities.size();
+        ++rebuilds;
+        return items;
+    }
+
+    const std::vector<ViewItem<Ts...>> &GetItems() const { return items; }
+    size_t GetRebuildCount() const { return rebuilds; }
+
+private:
+    std::vector<ViewItem<Ts...>> items;
+    bool built = false;
+    uint32_t builtVersion = 0;
+    GameEntity *const *source = nullptr;
+    size_t sourceSize = 0;
+    size_t rebuilds = 0;
+};
+
+// Shared cached view per component set, for code that doesn't hold on to an EntityView itself.
+// Main thread only, everyone asking for the same Ts gets the same cache
+template <typename... Ts>
+const std::vector<ViewItem<Ts...>> &View(const std::vector<GameEntity *> &entities)
+{
+    static EntityView<Ts...> view;
+    return view.Update(entities);
+}
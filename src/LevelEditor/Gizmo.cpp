@@ -1,4 +1,5 @@
-#include "gizmo.h"
+#include "Gizmo.h"
+#include "../EngineInputs/InputState.h"
 #include <float.h>
 
 /**
@@ -603,7 +604,7 @@ float GizmoSystem::GetUniformScaleAmount(const Ray &mouseRay, Camera camera) con
     if (!targetPosition)
         return 1.0f;
 
-    Vector2 currMousePos = GetMousePosition();
+    Vector2 currMousePos = InputState::GetMousePosition();
     float deltaY = dragStartScreenPos.y - currMousePos.y;
 
     float sensitivity = 0.005f;
@@ -742,8 +743,8 @@ bool GizmoSystem::Update(Camera camera, Ray mouseRay, Vector3 &position, Quatern
         return false;
 
     bool changed = false;
-    bool isPressed = IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
-    bool isReleased = IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
+    bool isPressed = InputState::IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    bool isReleased = InputState::IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
 
     if (isPressed && !isDragging)
     {
@@ -808,7 +809,7 @@ bool GizmoSystem::Update(Camera camera, Ray mouseRay, Vector3 &position, Quatern
 
                 if (selectedAxis == 3)
                 {
-                    dragStartScreenPos = GetMousePosition();
+                    dragStartScreenPos = InputState::GetMousePosition();
                     dragStartMovement = 1.0f;
                 }
                 else
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <raylib.h>
+#include <raymath.h>
+#include <cmath>
+
+// World space box that keeps its rotation, what a rotated cube actually covers. The axes are unit length,
+// halfExtents is how far the box goes along each of them.
+struct OrientedBox
+{
+    Vector3 center = {0, 0, 0};
+    Vector3 axes[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    Vector3 halfExtents = {0, 0, 0};
+
+    static OrientedBox FromRotation(Vector3 center, Quaternion rotation, Vector3 halfExtents)
+    {
+        Matrix rotationMatrix = QuaternionToMatrix(rotation);
+
+        OrientedBox box;
+        box.center = center;
+        box.axes[0] = {rotationMatrix.m0, rotationMatrix.m1, rotationMatrix.m2};
+        box.axes[1] = {rotationMatrix.m4, rotationMatrix.m5, rotationMatrix.m6};
+        box.axes[2] = {rotationMatrix.m8, rotationMatrix.m9, rotationMatrix.m10};
+        box.halfExtents = halfExtents;
+        return box;
+    }
+
+    // Local box through a scale/rotation/translation matrix (shear isn't a thing in the editor)
+    static OrientedBox FromTransform(const BoundingBox &local, const Matrix &transform)
+    {
+        Vector3 localCenter = Vector3Scale(Vector3Add(local.min, local.max), 0.5f);
+        Vector3 localHalf = Vector3Scale(Vector3Subtract(local.max, local.min), 0.5f);
+        Vector3 columns[3] = {{transform.m0, transform.m1, transform.m2}, {transform.m4, transform.m5, transform.m6}, {transform.m8, transform.m9, transform.m10}};
+        float halves[3] = {localHalf.x, localHalf.y, localHalf.z};
+
+        OrientedBox box;
+        box.center = Vector3Transform(localCenter, transform);
+        float extents[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            // Scale ends up in the column length, move it over to the extents so the axes stay unit length
+            float length = Vector3Length(columns[i]);
+            if (length > 0.0f)
+                box.axes[i] = Vector3Scale(columns[i], 1.0f / length);
+            extents[i] = halves[i] * length;
+        }
+        box.halfExtents = {extents[0], extents[1], extents[2]};
+        return box;
+    }
+
+    // Bit i of the index picks the + or - side along axis i
+    Vector3 GetCorner(int index) const
+    {
+        Vector3 corner = center;
+        corner = Vector3Add(corner, Vector3Scale(axes[0], (index & 1) ? halfExtents.x : -halfExtents.x));
+        corner = Vector3Add(corner, Vector3Scale(axes[1], (index & 2) ? halfExtents.y : -halfExtents.y));
+        corner = Vector3Add(corner, Vector3Scale(axes[2], (index & 4) ? halfExtents.z : -halfExtents.z));
+        return corner;
+    }
+
+    // Smallest AABB around it, good for broad phase stuff that only deals with AABBs
+    BoundingBox GetBoundingBox() const
+    {
+        Vector3 extent = {
+            fabsf(axes[0].x) * halfExtents.x + fabsf(axes[1].x) * halfExtents.y + fabsf(axes[2].x) * halfExtents.z,
+            fabsf(axes[0].y) * halfExtents.x + fabsf(axes[1].y) * halfExtents.y + fabsf(axes[2].y) * halfExtents.z,
+            fabsf(axes[0].z) * halfExtents.x + fabsf(axes[1].z) * halfExtents.y + fabsf(axes[2].z) * halfExtents.z};
+        return {Vector3Subtract(center, extent), Vector3Add(center, extent)};
+    }
+};
+
+// The 6 planes of a view projection, kept as separate x/y/z/d arrays so 4 planes get tested at once.
+// The last 2 slots are padding planes everything is inside of.
+struct Frustum
+{
+    alignas(16) float normalX[8];
+    alignas(16) float normalY[8];
+    alignas(16) float normalZ[8];
+    alignas(16) float distance[8];
+
+    // Planes come straight out of the matrix rows (Gribb/Hartmann), inside is n.p + d >= 0
+    static Frustum FromMatrix(const Matrix &m)
+    {
+        const float rowX[4] = {m.m0, m.m4, m.m8, m.m12};
+        const float rowY[4] = {m.m1, m.m5, m.m9, m.m13};
+        const float rowZ[4] = {m.m2, m.m6, m.m10, m.m14};
+        const float rowW[4] = {m.m3, m.m7, m.m11, m.m15};
+        const float *rows[3] = {rowX, rowY, rowZ};
+
+        Frustum frustum;
+        for (int i = 0; i < 6; ++i)
+        {
+            const float *row = rows[i / 2];
+            float sign = (i & 1) ? -1.0f : 1.0f;
+            float plane[4];
+            for (int j = 0; j < 4; ++j)
+                plane[j] = rowW[j] + sign * row[j];
+
+            float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            frustum.normalX[i] = plane[0] * scale;
+            frustum.normalY[i] = plane[1] * scale;
+            frustum.normalZ[i] = plane[2] * scale;
+            frustum.distance[i] = plane[3] * scale;
+        }
+        for (int i = 6; i < 8; ++i)
+        {
+            frustum.normalX[i] = frustum.normalY[i] = frustum.normalZ[i] = 0.0f;
+            frustum.distance[i] = 1.0f;
+        }
+        return frustum;
+    }
+};
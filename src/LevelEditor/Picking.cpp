@@ -0,0 +1,74 @@
+#include "Picking.h"
+#include "Collision.h"
+#include "EntityView.h"
+#include "../Profiling/Profiler.h"
+
+namespace
+{
+    RayCollision RayCube(const CubeComponent *cube, Ray ray)
+    {
+        return Collision::RayOrientedBox(ray, cube->GetOrientedBox());
+    }
+
+    RayCollision RaySphere(const GameEntity *entity, const SphereComponent *sphere, Ray ray)
+    {
+        return Collision::RaySphere(ray, entity->EntityTransform.position, sphere->GetScaledRadius());
+    }
+
+    RayCollision RayModel(const GameEntity *entity, const ModelComponent *model, Ray ray)
+    {
+        // Not loaded yet (or headless) means there is no mesh to hit
+        if (!model->IsLoaded())
+            return {0};
+
+        // The renderer translates separately from the scale/rotation matrix, so do the same here
+        Matrix transform = MatrixMultiply(entity->EntityTransform.GetTransformMatrix(),
+                                          MatrixTranslate(entity->EntityTransform.position.x, entity->EntityTransform.position.y, entity->EntityTransform.position.z));
+        return Collision::RayMesh(ray, model->model->meshes[0], transform);
+    }
+}
+
+RayCollision Picking::RayEntity(GameEntity *entity, Ray ray)
+{
+    RayCollision collision = {0};
+
+    if (auto cube = entity->GetComponent<CubeComponent>())
+        collision = RayCube(cube, ray);
+    else if (auto sphere = entity->GetComponent<SphereComponent>())
+        collision = RaySphere(entity, sphere, ray);
+    else if (auto model = entity->GetComponent<ModelComponent>())
+        collision = RayModel(entity, model, ray);
+
+    return collision;
+}
+
+GameEntity *Picking::PickEntity(const std::vector<GameEntity *> &entities, Ray ray)
+{
+    PROFILE_SCOPE("Picking::PickEntity");
+
+    GameEntity *closestEntity = nullptr;
+    uint32_t closestIndex = 0;
+    float closestDistance = 0.0f;
+
+    // One shape after the other, a tie goes to whoever is first in the list like it did when this was one loop
+    auto consider = [&](const RayCollision &collision, GameEntity *entity, uint32_t index)
+    {
+        if (!collision.hit)
+            return;
+        if (!closestEntity || collision.distance < closestDistance || (collision.distance == closestDistance && index < closestIndex))
+        {
+            closestEntity = entity;
+            closestIndex = index;
+            closestDistance = collision.distance;
+        }
+    };
+
+    for (const auto &item : View<CubeComponent>(entities))
+        consider(RayCube(item.Get<CubeComponent>(), ray), item.entity, item.index);
+    for (const auto &item : View<SphereComponent>(entities))
+        consider(RaySphere(item.entity, item.Get<SphereComponent>(), ray), item.entity, item.index);
+    for (const auto &item : View<ModelComponent>(entities))
+        consider(RayModel(item.entity, item.Get<ModelComponent>(), ray), item.entity, item.index);
+
+    return closestEntity;
+}
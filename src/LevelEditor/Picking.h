@@ -0,0 +1,15 @@
+#pragma once
+
+#include <raylib.h>
+#include <vector>
+#include "gameEntity.h"
+
+class Picking
+{
+public:
+    // Closest entity the ray hits, nullptr if it hits nothing
+    static GameEntity *PickEntity(const std::vector<GameEntity *> &entities, Ray ray);
+
+    // Ray test against whatever shape the entity has, no hit if it has no object component
+    static RayCollision RayEntity(GameEntity *entity, Ray ray);
+};
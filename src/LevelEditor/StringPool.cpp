@@ -0,0 +1,165 @@
+#include "StringPool.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "../Logging/Logger.h"
+
+namespace
+{
+    // Entries are kept in fixed pages that never move, so Get can read them while another thread adds one
+    constexpr size_t PAGE_BITS = 12;
+    constexpr size_t PAGE_SIZE = size_t(1) << PAGE_BITS;
+    // 64M strings, the page table itself is 128KB
+    constexpr size_t MAX_PAGES = 16384;
+    // Strings longer than this get a block of their own
+    constexpr size_t BLOCK_BYTES = 64 * 1024;
+
+    struct Entry
+    {
+        const char *data;
+        uint32_t length;
+    };
+
+    struct PoolState
+    {
+        std::shared_mutex mutex;
+        // Keys point into the blocks, not into whatever the caller passed in
+        std::unordered_map<std::string_view, StringId> ids;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *cursor = nullptr;
+        size_t blockLeft = 0;
+
+        std::atomic<Entry *> pages[MAX_PAGES];
+        std::vector<std::unique_ptr<Entry[]>> ownedPages;
+        // Published last, an id below it has its entry filled in
+        std::atomic<uint32_t> count{0};
+        size_t bytes = 0;
+        size_t reservedBytes = 0;
+
+        PoolState()
+        {
+            for (auto &page : pages)
+                page.store(nullptr, std::memory_order_relaxed);
+
+            Add("");
+            Add("Entity");
+        }
+
+        char *Allocate(size_t size)
+        {
+            if (size > blockLeft)
+            {
+                size_t blockSize = size > BLOCK_BYTES / 4 ? size : BLOCK_BYTES;
+                blocks.emplace_back(new char[blockSize]);
+                reservedBytes += blockSize;
+                // Oversized ones don't replace the current block, there's usually room left in it
+                if (blockSize != BLOCK_BYTES)
+                    return blocks.back().get();
+
+                cursor = blocks.back().get();
+                blockLeft = blockSize;
+            }
+
+            char *result = cursor;
+            cursor += size;
+            blockLeft -= size;
+            return result;
+        }
+
+        // Caller holds the unique lock (or is the constructor)
+        StringId Add(std::string_view value)
+        {
+            uint32_t id = count.load(std::memory_order_relaxed);
+            size_t page = id >> PAGE_BITS;
+            if (page >= MAX_PAGES)
+            {
+                DebugError("String pool is full, dropping string:", std::string(value));
+                return StringPool::EMPTY;
+            }
+
+            if (!pages[page].load(std::memory_order_relaxed))
+            {
+                ownedPages.emplace_back(new Entry[PAGE_SIZE]);
+                pages[page].store(ownedPages.back().get(), std::memory_order_relaxed);
+            }
+
+            char *data = Allocate(value.size() + 1);
+            std::memcpy(data, value.data(), value.size());
+            data[value.size()] = '\0';
+            bytes += value.size() + 1;
+
+            pages[page].load(std::memory_order_relaxed)[id & (PAGE_SIZE - 1)] = {data, static_cast<uint32_t>(value.size())};
+            ids.emplace(std::string_view(data, value.size()), id);
+            count.store(id + 1, std::memory_order_release);
+            return id;
+        }
+
+        const Entry *Find(StringId id)
+        {
+            if (id >= count.load(std::memory_order_acquire))
+                return nullptr;
+            return &pages[id >> PAGE_BITS].load(std::memory_order_relaxed)[id & (PAGE_SIZE - 1)];
+        }
+    };
+
+    PoolState &GetState()
+    {
+        static PoolState state;
+        return state;
+    }
+}
+
+StringId StringPool::Intern(std::string_view value)
+{
+    if (value.empty())
+        return EMPTY;
+
+    PoolState &state = GetState();
+    {
+        // Nearly every call is a name that's already in here, those only need the shared lock
+        std::shared_lock<std::shared_mutex> lock(state.mutex);
+        auto it = state.ids.find(value);
+        if (it != state.ids.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(state.mutex);
+    // Someone else could have added it in between the locks
+    auto it = state.ids.find(value);
+    if (it != state.ids.end())
+        return it->second;
+    return state.Add(value);
+}
+
+std::string_view StringPool::Get(StringId id)
+{
+    const Entry *entry = GetState().Find(id);
+    return entry ? std::string_view(entry->data, entry->length) : std::string_view();
+}
+
+const char *StringPool::GetCString(StringId id)
+{
+    const Entry *entry = GetState().Find(id);
+    return entry ? entry->data : "";
+}
+
+size_t StringPool::GetCount()
+{
+    return GetState().count.load(std::memory_order_acquire);
+}
+
+StringPoolStats StringPool::GetStats()
+{
+    PoolState &state = GetState();
+    std::shared_lock<std::shared_mutex> lock(state.mutex);
+
+    StringPoolStats stats;
+    stats.strings = state.count.load(std::memory_order_relaxed);
+    stats.bytes = state.bytes;
+    stats.reservedBytes = state.reservedBytes;
+    return stats;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Index into the StringPool, stays the same for as long as the program runs
+using StringId = uint32_t;
+
+struct StringPoolStats
+{
+    size_t strings = 0;
+    // Characters including the terminators, and what the arena blocks holding them add up to
+    size_t bytes = 0;
+    size_t reservedBytes = 0;
+};
+
+// Every entity name and asset path lives in here exactly once, entities and components only keep the 32 bit id.
+// Characters go into big arena blocks that never move or get freed, so a string_view from Get stays good forever.
+// Interning is safe from any thread (levels load on the JobSystem), Get doesn't lock at all.
+class StringPool
+{
+public:
+    // Both are there before anything gets interned, new GameEntities start out with the default name without a lookup
+    static constexpr StringId EMPTY = 0;
+    static constexpr StringId DEFAULT_ENTITY_NAME = 1;
+
+    // Id of the string, adds it the first time it shows up
+    static StringId Intern(std::string_view value);
+    // Ids that never came out of Intern read as the empty string
+    static std::string_view Get(StringId id);
+    // Null terminated, straight into ImGui
+    static const char *GetCString(StringId id);
+
+    // Ids go from 0 to GetCount() - 1, the save code sizes its remap tables with this
+    static size_t GetCount();
+    static StringPoolStats GetStats();
+};
@@ -3,10 +3,16 @@
 #include <raylib.h>
 #include <vector>
 #include <memory>
-#include <unordered_map>
-#include <typeindex>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
 #include <raymath.h>
 #include <string>
+#include <string_view>
+#include <cstring>
+#include "EntityMemory.h"
+#include "OrientedBox.h"
+#include "StringPool.h"
 #include "../Logging/Logger.h"
 
 // Forward declaration, otherwise the component it doesn't know (kinda need it cuz templates have to be here)
@@ -18,6 +24,32 @@ enum class ComponentCategory
     Object,
 };
 
+// Dense ids, every component type says which one is its with a static TYPE. Index into the entity's component slots
+// and the bit in its mask, so looking one up is a bit test and an array read. New types go in front of Count
+enum class ComponentType : uint8_t
+{
+    Cube,
+    Sphere,
+    Model,
+    Count,
+};
+
+using ComponentMask = uint32_t;
+constexpr size_t COMPONENT_TYPE_COUNT = static_cast<size_t>(ComponentType::Count);
+static_assert(COMPONENT_TYPE_COUNT <= sizeof(ComponentMask) * 8, "ComponentMask needs more bits");
+
+template <typename T>
+constexpr ComponentMask GetComponentBit()
+{
+    return ComponentMask(1) << static_cast<uint32_t>(T::TYPE);
+}
+
+template <typename T>
+constexpr uint32_t GetCategoryBit()
+{
+    return uint32_t(1) << static_cast<uint32_t>(T::CATEGORY);
+}
+
 class Component
 {
 public:
@@ -27,6 +59,10 @@ public:
     const ComponentCategory category;
 
     Component(ComponentCategory componentCategory) : category(componentCategory) {}
+
+    // Pooled per type (or the level arena while loading), the destructor is virtual so delete through here finds the right one
+    static void *operator new(size_t size) { return EntityMemory::Allocate(size); }
+    static void operator delete(void *object) { EntityMemory::Free(object); }
 };
 
 struct EntityTransform
@@ -165,35 +201,44 @@ struct EntityTransform
 class GameEntity
 {
 public:
-    GameEntity() : name("Entity"), EntityTransform() {}
-    ~GameEntity() = default;
+    GameEntity() : EntityTransform() {}
+    ~GameEntity()
+    {
+        for (Component *component : components)
+            delete component;
+        BumpStructureVersion();
+    }
 
-    // Default to "Entity" as name
-    std::string name;
-    EntityTransform EntityTransform;
+    // Owns its components through plain pointers
+    GameEntity(const GameEntity &) = delete;
+    GameEntity &operator=(const GameEntity &) = delete;
+
+    // Same pools as the components, see EntityMemory
+    static void *operator new(size_t size) { return EntityMemory::Allocate(size); }
+    static void operator delete(void *object) { EntityMemory::Free(object); }
+
+    // Interned, default to "Entity" as name
+    StringId nameId = StringPool::DEFAULT_ENTITY_NAME;
+    // Qualified, otherwise GCC complains the member changes the meaning of the type name
+    ::EntityTransform EntityTransform;
 
     template <typename T, typename... Args>
     T *AddComponent(Args &&...args)
     {
-        // Create a new component of type T and making it unique
-        auto component = std::make_unique<T>(std::forward<Args>(args)...);
+        static_assert(std::is_base_of<Component, T>::value, "Components have to derive from Component");
 
-        // Just check all the components if theres one with the same category
-        for (const auto &pair : components)
-        {
-            const auto &existingComponent = pair.second;
-            if (existingComponent->category == component->category)
-            {
-                return nullptr;
-            }
-        }
+        // Only one per category, checked before anything gets made
+        if (categoryMask & GetCategoryBit<T>())
+            return nullptr;
 
         // Can't be null, so no reference, so we make it a pointer instead of direct
-        T *componentPtr = component.get();
+        T *componentPtr = new T(std::forward<Args>(args)...);
         componentPtr->entity = this;
 
-        // Store the uPointer in the map using the type index as the key
-        components[std::type_index(typeid(T))] = std::move(component);
+        components[static_cast<size_t>(T::TYPE)] = componentPtr;
+        componentMask |= GetComponentBit<T>();
+        categoryMask |= GetCategoryBit<T>();
+        BumpStructureVersion();
 
         return componentPtr;
     }
@@ -201,51 +246,72 @@ public:
     template <typename T>
     T *GetComponent()
     {
-        auto component = components.find(std::type_index(typeid(T)));
-
-        if (component != components.end())
-        {
-            // Return as pointer of T
-            return static_cast<T *>(component->second.get());
-        }
-
-        return nullptr;
+        // Empty slots are null, no need to test the bit first
+        return static_cast<T *>(components[static_cast<size_t>(T::TYPE)]);
     }
 
     template <typename T>
-    T *RemoveComponent()
+    const T *GetComponent() const
     {
-        auto component = components.find(std::type_index(typeid(T)));
-
-        if (component != components.end())
-        {
-            T *componentPtr = static_cast<T *>(component->second.get());
-            componentPtr->entity = nullptr;
-            components.erase(component);
+        return static_cast<const T *>(components[static_cast<size_t>(T::TYPE)]);
+    }
 
-            return componentPtr;
-        }
-        return nullptr;
+    // Deletes it, returns whether there was one
+    template <typename T>
+    bool RemoveComponent()
+    {
+        Component *&component = components[static_cast<size_t>(T::TYPE)];
+        if (!component)
+            return false;
+
+        delete component;
+        component = nullptr;
+        componentMask &= ~GetComponentBit<T>();
+        categoryMask &= ~GetCategoryBit<T>();
+        BumpStructureVersion();
+        return true;
     }
 
     template <typename T>
-    bool HasComponent()
+    bool HasComponent() const
     {
-        return components.find(std::type_index(typeid(T))) != components.end();
+        return (componentMask & GetComponentBit<T>()) != 0;
     }
 
-    void SetName(std::string name) { this->name = name; }
-    const std::string &GetName() const { return name; }
+    // One bit per ComponentType, for checking a bunch of them at once
+    ComponentMask GetComponentMask() const { return componentMask; }
+
+    // Goes up whenever any entity gets deleted or gains/loses a component, what the cached EntityViews check against.
+    // An entity without components doesn't show up in any view, so creating one doesn't count
+    static uint32_t GetStructureVersion() { return structureVersion.load(std::memory_order_acquire); }
+
+    void SetName(std::string_view name) { nameId = StringPool::Intern(name); }
+    void SetNameId(StringId id) { nameId = id; }
+    // Points into the pool, stays valid after the entity is gone
+    std::string_view GetName() const { return StringPool::Get(nameId); }
+    StringId GetNameId() const { return nameId; }
 
 private:
-    std::unordered_map<std::type_index, std::unique_ptr<Component>> components;
+    static void BumpStructureVersion() { structureVersion.fetch_add(1, std::memory_order_release); }
+
+    static inline std::atomic<uint32_t> structureVersion{0};
+
+    Component *components[COMPONENT_TYPE_COUNT] = {};
+    ComponentMask componentMask = 0;
+    // Bit per ComponentCategory that's taken
+    uint32_t categoryMask = 0;
 };
 
 struct CubeComponent : Component
 {
-    CubeComponent() : Component(ComponentCategory::Object) {}
+    static constexpr ComponentType TYPE = ComponentType::Cube;
+    static constexpr ComponentCategory CATEGORY = ComponentCategory::Object;
+
+    CubeComponent() : Component(CATEGORY) {}
     Vector3 size = {1, 1, 1};
     Color color = GRAY;
+    // Big walls/floors, they hide whatever is behind them in the scene view (see OcclusionCuller)
+    bool occluder = false;
 
     Vector3 GetScaledSize() const
     {
@@ -259,6 +325,27 @@ struct CubeComponent : Component
         return size;
     }
 
+    // What the cube covers in the world, rotation included. Cached, only gets rebuilt when the
+    // transform or size is different from last time (comparing is a lot cheaper than the quaternion -> axes)
+    const OrientedBox &GetOrientedBox() const
+    {
+        BoxKey key = {};
+        if (entity)
+            key = {entity->EntityTransform.position, entity->EntityTransform.rotation, entity->EntityTransform.scale, size};
+        else
+            key = {{0, 0, 0}, QuaternionIdentity(), {1, 1, 1}, size};
+
+        if (!boxCached || std::memcmp(&key, &cachedKey, sizeof(BoxKey)) != 0)
+        {
+            Vector3 half = Vector3Scale(Vector3Multiply(key.size, key.scale), 0.5f);
+            cachedBox = OrientedBox::FromRotation(key.position, key.rotation, {fabsf(half.x), fabsf(half.y), fabsf(half.z)});
+            cachedKey = key;
+            boxCached = true;
+        }
+        return cachedBox;
+    }
+
+    // Tight AABB around the rotated cube
     BoundingBox GetBoundingBox() const
     {
         if (!entity)
@@ -266,16 +353,30 @@ struct CubeComponent : Component
             return {Vector3{0, 0, 0}, Vector3{0, 0, 0}};
         }
 
-        Vector3 scaledSize = GetScaledSize();
-        return {
-            Vector3Subtract(entity->EntityTransform.position, Vector3Scale(scaledSize, 0.5f)),
-            Vector3Add(entity->EntityTransform.position, Vector3Scale(scaledSize, 0.5f))};
+        return GetOrientedBox().GetBoundingBox();
     }
+
+private:
+    // All floats, no padding, so memcmp works for the comparison
+    struct BoxKey
+    {
+        Vector3 position;
+        Quaternion rotation;
+        Vector3 scale;
+        Vector3 size;
+    };
+
+    mutable BoxKey cachedKey = {};
+    mutable OrientedBox cachedBox;
+    mutable bool boxCached = false;
 };
 
 struct SphereComponent : Component
 {
-    SphereComponent() : Component(ComponentCategory::Object) {}
+    static constexpr ComponentType TYPE = ComponentType::Sphere;
+    static constexpr ComponentCategory CATEGORY = ComponentCategory::Object;
+
+    SphereComponent() : Component(CATEGORY) {}
     float radius = 1.0f;
     Color color = GRAY;
 
@@ -292,11 +393,20 @@ struct SphereComponent : Component
 
 struct ModelComponent : Component
 {
-    ModelComponent() : Component(ComponentCategory::Object) {}
+    static constexpr ComponentType TYPE = ComponentType::Model;
+    static constexpr ComponentCategory CATEGORY = ComponentCategory::Object;
 
-    Model model = {0};
-    Material material = LoadMaterialDefault();
-    std::string filePath;
+    ModelComponent() : Component(CATEGORY) {}
+
+    // Interned path, StringPool::EMPTY when there's no file
+    StringId filePathId = StringPool::EMPTY;
+    // Owned by the renderer's ModelCache and filled in lazily once there is a GL context, so the component itself
+    // can be created (level loading, tools, benchmarks) without a window
+    const Model *model = nullptr;
+    // Model space bounds, filled in together with model
+    BoundingBox bounds = {{0, 0, 0}, {0, 0, 0}};
+    // Rasterized into the occlusion buffer with its real triangles, only worth it for big low poly things
+    bool occluder = false;
 
     Vector3 GetPosition() const
     {
@@ -313,55 +423,39 @@ struct ModelComponent : Component
         return entity ? entity->EntityTransform.scale : Vector3{1, 1, 1};
     }
 
-    // Load a full model from file (clears previous data!)
-    bool LoadModelFromFile(const std::string &path)
+    // Points the component at a new file, the renderer picks it up the next time it draws
+    void SetFilePath(std::string_view path)
     {
-        DebugPrint("Loading model: ", path, entity, entity->GetName());
-        ClearModel();
-
-        model = LoadModel(path.c_str());
-        if (IsModelValid(model) && model.meshCount > 0)
-        {
-            filePath = path;
-
-            if (model.materialCount > 0)
-                material = model.materials[0];
-
-            return true;
-        }
+        SetFilePathId(StringPool::Intern(path));
+    }
 
-        filePath.clear();
-        model = {0};
-        return false;
+    void SetFilePathId(StringId id)
+    {
+        filePathId = id;
+        model = nullptr;
     }
 
+    std::string_view GetFilePath() const { return StringPool::Get(filePathId); }
+    bool HasFilePath() const { return filePathId != StringPool::EMPTY; }
+
     void ClearModel()
     {
-        if (IsModelValid(model))
-        {
-            UnloadModel(model);
-            model = {0};
-        }
-        filePath.clear();
+        filePathId = StringPool::EMPTY;
+        model = nullptr;
     }
 
     bool IsLoaded() const
     {
-        return IsModelValid(model) && model.meshCount > 0 && !filePath.empty();
+        return model && model->meshCount > 0 && HasFilePath();
     }
 
     int GetVertexCount() const
     {
-        return IsLoaded() ? model.meshes[0].vertexCount : 0;
+        return IsLoaded() ? model->meshes[0].vertexCount : 0;
     }
 
     int GetTriangleCount() const
     {
-        return IsLoaded() ? model.meshes[0].triangleCount : 0;
-    }
-
-    ~ModelComponent()
-    {
-        ClearModel();
+        return IsLoaded() ? model->meshes[0].triangleCount : 0;
     }
 };
@@ -5,7 +5,11 @@
 #include "../imgui/imfilebrowser.h"
 #include "../typedef.h"
 #include "objectsUI.h"
-#include "GameEntity.h"
+#include "gameEntity.h"
+#include "../Rendering/ModelCache.h"
+#include "../Rendering/FrameScheduler.h"
+#include "../Rendering/OcclusionCuller.h"
+#include "../Rendering/ThumbnailCache.h"
 #include <vector>
 #include <string>
 
@@ -43,14 +47,14 @@ void ObjectUI::UpdateAndRenderGizmos(Camera camera, GameEntity *selectedEntity,
         lastRotationTarget = &selectedEntity->EntityTransform.rotation;
         lastScaleTarget = &selectedEntity->EntityTransform.scale;
     }
-    gizmoSystem.Update(camera, mouseRay, selectedEntity->EntityTransform.position, selectedEntity->EntityTransform.rotation, selectedEntity->EntityTransform.scale, &selectedEntity->EntityTransform);
+    if (gizmoSystem.Update(camera, mouseRay, selectedEntity->EntityTransform.position, selectedEntity->EntityTransform.rotation, selectedEntity->EntityTransform.scale, &selectedEntity->EntityTransform))
+        FrameScheduler::MarkDirty(DIRTY_ENTITY);
 
     gizmoSystem.Render(camera, mouseRay);
 }
 
 void ObjectUI::RenderGeneralUI(GameEntity **selectedEntity, std::vector<GameEntity *> &entities, GizmoSystem &gizmoSystem)
 {
-    // ImGui::DockSpaceOverViewport(ImGuiDockNodeFlags_PassthruCentralNode);
     ImGui::Begin("Entity Editor");
 
     if (*selectedEntity == nullptr)
@@ -147,14 +151,22 @@ void ObjectUI::RenderGeneralUI(GameEntity **selectedEntity, std::vector<GameEnti
 
     ImGui::Begin("Entity Hierarchy");
 
-    for (auto &entity : entities)
+    // Names come straight out of the StringPool, the pointer keeps the ImGui ids apart when names repeat
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(entities.size()));
+    while (clipper.Step())
     {
-        std::string entityName = "Entity " + std::to_string(reinterpret_cast<uintptr_t>(entity));
-
-        bool isSelected = (*selectedEntity == entity);
-        if (ImGui::Selectable(entityName.c_str(), isSelected))
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
         {
-            *selectedEntity = entity;
+            GameEntity *entity = entities[i];
+
+            ImGui::PushID(entity);
+            bool isSelected = (*selectedEntity == entity);
+            if (ImGui::Selectable(StringPool::GetCString(entity->GetNameId()), isSelected))
+            {
+                *selectedEntity = entity;
+            }
+            ImGui::PopID();
         }
     }
 
@@ -427,6 +439,11 @@ void ObjectUI::RenderCubeComponentUI(CubeComponent *cube)
         {
             cube->color = rlImGuiColors::Convert(colorVec);
         }
+
+        if (ImGui::Checkbox("Occluder", &cube->occluder))
+            FrameScheduler::MarkDirty(DIRTY_ENTITY);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Hides things behind it in the scene view, tick it for big walls and floors");
     }
 }
 
@@ -470,13 +487,16 @@ void ObjectUI::RenderModelComponentUI(ModelComponent *model)
     {
         fileDialog.SetTitle("Select Model File");
         fileDialog.SetTypeFilters({".obj", ".iqm", ".gltf", ".glb", ".vox"});
+        // Only the rows in view ask for theirs, so scrolling through a big folder doesn't render all of it
+        fileDialog.SetFileIconCallback([](const std::filesystem::path &path, float size)
+                                       { ThumbnailCache::Draw(path.string(), size); },
+                                       48.0f);
         fileBrowserInitialized = true;
     }
 
     ImGui::Text("Model File");
 
-    std::string currentFile = model->filePath.empty() ? "No file selected" : model->filePath;
-    ImGui::TextWrapped("Current: %s", currentFile.c_str());
+    ImGui::TextWrapped("Current: %s", model->HasFilePath() ? StringPool::GetCString(model->filePathId) : "No file selected");
 
     if (ImGui::Button("Browse..."))
     {
@@ -484,25 +504,29 @@ void ObjectUI::RenderModelComponentUI(ModelComponent *model)
     }
 
     fileDialog.Display();
+    // The listing streams in from the scan thread, nothing else wakes the idle loop up while that's going
+    if (fileDialog.IsScanning())
+        FrameScheduler::MarkDirty(DIRTY_ANIMATION);
 
     if (fileDialog.HasSelected())
     {
         std::string selectedPath = fileDialog.GetSelected().string();
 
-        if (model->LoadModelFromFile(selectedPath))
+        model->SetFilePath(selectedPath);
+        if (ModelCache::Resolve(model))
         {
-            model->filePath = selectedPath;
             ImGui::OpenPopup("ModelLoadSuccess");
         }
         else
         {
+            model->ClearModel();
             ImGui::OpenPopup("ModelLoadError");
         }
 
         fileDialog.ClearSelected();
     }
 
-    if (!model->filePath.empty())
+    if (model->HasFilePath())
     {
         ImGui::SameLine();
         if (ImGui::Button("Clear"))
@@ -512,12 +536,17 @@ void ObjectUI::RenderModelComponentUI(ModelComponent *model)
     }
 
     // I just like seeing this
-    if (!model->filePath.empty() && model->IsLoaded())
+    if (model->IsLoaded())
     {
         ImGui::Separator();
         ImGui::Text("Model Info:");
         ImGui::TextDisabled("Vertices: %d", model->GetVertexCount());
         ImGui::TextDisabled("Triangles: %d", model->GetTriangleCount());
+
+        if (ImGui::Checkbox("Occluder", &model->occluder))
+            FrameScheduler::MarkDirty(DIRTY_ENTITY);
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("Hides things behind it in the scene view, only used up to %d triangles", OcclusionCuller::MAX_MODEL_OCCLUDER_TRIANGLES);
     }
 
     ImGui::Separator();
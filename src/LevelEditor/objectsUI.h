@@ -1,7 +1,7 @@
 #pragma once
 #include <vector>
 #include "gameEntity.h"
-#include "gizmo.h"
+#include "Gizmo.h"
 #include "../typedef.h"
 
 class ObjectUI
@@ -1,27 +1,55 @@
 #include "Logger.h"
 #include "../../imgui/imgui.h"
 #include "../../imgui/textselect.hpp"
+#include "../Profiling/Profiler.h"
 
-void RenderConsoleUI(std::vector<LogEntry> &logBuffer)
+void RenderConsoleUI(LogRing &logBuffer)
 {
+    PROFILE_SCOPE("RenderConsoleUI");
     static bool autoScroll = true;
 
-    auto getLine = [&logBuffer](size_t idx) -> std::string_view
+    // Loaders and job threads log while this draws, so logMutex is only held for short copies of what's on screen.
+    // Rows are numbered from where the ring was at the start of the frame, anything pushed after that shows up next
+    // frame and anything that fell off the front in between reads as an empty line
+    static size_t frameRemoved = 0;
+    static size_t frameSize = 0;
+
+    // Caller holds logMutex
+    auto getEntry = [&logBuffer](size_t idx) -> const LogEntry *
+    {
+        size_t removed = logBuffer.GetRemovedCount();
+        size_t absolute = frameRemoved + idx;
+        if (absolute < removed || absolute - removed >= logBuffer.size())
+            return nullptr;
+        return &logBuffer[absolute - removed];
+    };
+
+    auto getLine = [getEntry](size_t idx) -> std::string_view
     {
-        return logBuffer[idx].message;
+        const LogEntry *entry = getEntry(idx);
+        return entry ? std::string_view(entry->message) : std::string_view();
     };
 
-    auto getNumLines = [&logBuffer]() -> size_t
+    auto getNumLines = []() -> size_t
     {
-        return logBuffer.size();
+        return frameSize;
     };
 
     static TextSelect textSelect(getLine, getNumLines);
 
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        // Whatever fell off the front since last frame, the selection moves up with the text
+        textSelect.linesRemoved(logBuffer.GetRemovedCount() - frameRemoved);
+        frameRemoved = logBuffer.GetRemovedCount();
+        frameSize = logBuffer.size();
+    }
+
     ImGui::Begin("Console");
 
     if (ImGui::Button("Clear"))
     {
+        std::lock_guard<std::mutex> lock(logMutex);
         logBuffer.clear();
     }
 
@@ -31,30 +59,50 @@ void RenderConsoleUI(std::vector<LogEntry> &logBuffer)
 
     ImGui::BeginChild("ConsoleScrollRegion", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoMove);
 
-    for (size_t i = 0; i < logBuffer.size(); ++i)
+    // Only the lines in view get submitted, the clipper skips over the rest. They get copied out first, a log call
+    // from in here would otherwise deadlock on logMutex
+    static std::vector<LogEntry> rows;
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(frameSize));
+    while (clipper.Step())
     {
-        const auto &entry = logBuffer[i];
-
-        ImU32 color;
-        switch (entry.level)
+        rows.clear();
         {
-        case LogLevel::Warning:
-            color = IM_COL32(255, 180, 50, 255);
-            break;
-        case LogLevel::Error:
-            color = IM_COL32(255, 60, 60, 255);
-            break;
-        default:
-            color = ImGui::GetColorU32(ImGuiCol_Text);
-            break;
+            std::lock_guard<std::mutex> lock(logMutex);
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+            {
+                const LogEntry *entry = getEntry(i);
+                rows.push_back(entry ? *entry : LogEntry{"", LogLevel::Info});
+            }
         }
 
-        ImGui::PushStyleColor(ImGuiCol_Text, color);
-        ImGui::TextUnformatted(entry.message.c_str());
-        ImGui::PopStyleColor();
+        for (const LogEntry &entry : rows)
+        {
+            ImU32 color;
+            switch (entry.level)
+            {
+            case LogLevel::Warning:
+                color = IM_COL32(255, 180, 50, 255);
+                break;
+            case LogLevel::Error:
+                color = IM_COL32(255, 60, 60, 255);
+                break;
+            default:
+                color = ImGui::GetColorU32(ImGuiCol_Text);
+                break;
+            }
+
+            ImGui::PushStyleColor(ImGuiCol_Text, color);
+            ImGui::TextUnformatted(entry.message.c_str());
+            ImGui::PopStyleColor();
+        }
     }
 
-    textSelect.update();
+    {
+        // The views getLine hands out point into the ring, they only stay good while it's locked. TextSelect doesn't log
+        std::lock_guard<std::mutex> lock(logMutex);
+        textSelect.update();
+    }
 
     if (autoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 5.0f)
         ImGui::SetScrollHereY(1.0f);
@@ -3,4 +3,4 @@
 #include <string>
 #include "Logger.h"
 
-void RenderConsoleUI(std::vector<LogEntry> &logBuffer);
+void RenderConsoleUI(LogRing &logBuffer);
@@ -3,6 +3,7 @@
 #include <vector>
 #include <sstream>
 #include <typeinfo>
+#include <mutex>
 
 enum class LogLevel
 {
@@ -17,15 +18,121 @@ struct LogEntry
     LogLevel level;
 };
 
-inline std::vector<LogEntry> logBuffer;
-// Log buffer so it doesn't get too big, Value not yet determined
-constexpr size_t MAX_LOG_ENTRIES = 1000;
+// Keeps the newest entries, once it's full every push overwrites the oldest one instead of shifting everything down
+class LogRing
+{
+public:
+    explicit LogRing(size_t capacity) : capacity(capacity) {}
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // 0 is the oldest entry still in there
+    const LogEntry &operator[](size_t index) const
+    {
+        size_t slot = head + index;
+        return entries[slot >= entries.size() ? slot - entries.size() : slot];
+    }
+
+    void push_back(const LogEntry &entry)
+    {
+        if (entries.size() < capacity)
+        {
+            entries.push_back(entry);
+            return;
+        }
+
+        entries[head] = entry;
+        head = head + 1 == capacity ? 0 : head + 1;
+        ++removed;
+    }
+
+    // Keeps the newest entries that still fit, the rest count as removed
+    void SetCapacity(size_t newCapacity)
+    {
+        newCapacity = newCapacity > 0 ? newCapacity : 1;
+        size_t keep = entries.size() < newCapacity ? entries.size() : newCapacity;
+        std::vector<LogEntry> kept;
+        kept.reserve(keep);
+        for (size_t i = entries.size() - keep; i < entries.size(); ++i)
+        {
+            size_t slot = head + i;
+            kept.push_back(std::move(entries[slot >= entries.size() ? slot - entries.size() : slot]));
+        }
+
+        removed += entries.size() - keep;
+        entries = std::move(kept);
+        head = 0;
+        capacity = newCapacity;
+    }
+
+    void clear()
+    {
+        removed += entries.size();
+        entries.clear();
+        head = 0;
+    }
+
+    // Entries dropped off the front (or cleared) so far, lets the console shift its selection along with the text
+    size_t GetRemovedCount() const { return removed; }
+
+private:
+    std::vector<LogEntry> entries;
+    size_t capacity;
+    size_t head = 0;
+    size_t removed = 0;
+};
+
+// Log buffer so it doesn't get too big. The headless tools only need the last few entries, the editor raises it to
+// EDITOR_LOG_ENTRIES at startup: pushing is O(1) with the ring and the console only looks at what's on screen, so it can
+// keep a good while of history
+constexpr size_t DEFAULT_LOG_ENTRIES = 1000;
+constexpr size_t EDITOR_LOG_ENTRIES = 1 << 20;
+inline LogRing logBuffer(DEFAULT_LOG_ENTRIES);
+
+// Guards the buffer, the loaders and job threads log from workers. The console only holds it to copy out the rows in view
+inline std::mutex logMutex;
+
+// Set on a thread to also get everything that thread logs, level_tool uses it to print the errors with the file they're about
+inline thread_local std::vector<LogEntry> *threadLogCapture = nullptr;
+
+inline void SetLogCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(logMutex);
+    logBuffer.SetCapacity(capacity);
+}
 
 inline void PushLogEntry(const LogEntry &entry)
 {
-    if (logBuffer.size() >= MAX_LOG_ENTRIES)
-        logBuffer.erase(logBuffer.begin());
-    logBuffer.push_back(entry);
+    if (threadLogCapture)
+        threadLogCapture->push_back(entry);
+
+    if (entry.message.find('\n') == std::string::npos)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        logBuffer.push_back(entry);
+        return;
+    }
+
+    // The console draws every entry as one row of text, multi-line messages (exception text, dumps) go in line by line
+    std::vector<LogEntry> lines;
+    size_t begin = 0;
+    while (begin < entry.message.size())
+    {
+        size_t end = entry.message.find('\n', begin);
+        if (end == std::string::npos)
+            end = entry.message.size();
+
+        size_t length = end - begin;
+        if (length > 0 && entry.message[end - 1] == '\r')
+            --length;
+        lines.push_back({entry.message.substr(begin, length), entry.level});
+        begin = end + 1;
+    }
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    for (const LogEntry &line : lines)
+        logBuffer.push_back(line);
 }
 
 // Converting primitives to strings
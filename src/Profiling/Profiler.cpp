@@ -0,0 +1,107 @@
+#include "Profiler.h"
+#include "TraceCapture.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <chrono>
+
+std::mutex Profiler::threadsMutex;
+std::vector<std::unique_ptr<ProfilerThreadBuffer>> Profiler::threads;
+
+std::mutex Profiler::framesMutex;
+ProfileFrame Profiler::frames[Profiler::MAX_FRAMES];
+size_t Profiler::frameCount = 0;
+int64_t Profiler::currentFrameStart = 0;
+
+#ifdef PROFILER_USE_RDTSC
+// Rough guess until the first calibration, gets corrected after a few frames
+std::atomic<double> Profiler::msPerTick{1.0 / 3.0e6};
+#else
+std::atomic<double> Profiler::msPerTick{1.0e-6};
+#endif
+
+namespace
+{
+    int64_t SteadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Reference points for converting rdtsc ticks to wall time
+    const int64_t calibrationStartTicks = Profiler::Now();
+    const int64_t calibrationStartNs = SteadyNowNs();
+}
+
+ProfilerThreadBuffer *Profiler::RegisterThread()
+{
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    threads.push_back(std::make_unique<ProfilerThreadBuffer>());
+    threads.back()->threadIndex = static_cast<uint32_t>(threads.size() - 1);
+    return threads.back().get();
+}
+
+void Profiler::Calibrate()
+{
+#ifdef PROFILER_USE_RDTSC
+    int64_t elapsedNs = SteadyNowNs() - calibrationStartNs;
+    int64_t elapsedTicks = Now() - calibrationStartTicks;
+
+    // Wait a bit before trusting it, otherwise the error is huge
+    if (elapsedNs > 50'000'000 && elapsedTicks > 0)
+        msPerTick.store((static_cast<double>(elapsedNs) / static_cast<double>(elapsedTicks)) * 1.0e-6, std::memory_order_relaxed);
+#endif
+}
+
+void Profiler::BeginFrame()
+{
+    currentFrameStart = Now();
+}
+
+void Profiler::EndFrame()
+{
+    int64_t end = Now();
+    Calibrate();
+
+    ProfileFrame frame = {currentFrameStart, end};
+    {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        frames[frameCount % MAX_FRAMES] = frame;
+        frameCount++;
+    }
+
+    if (TraceCapture::IsCapturing())
+        TraceCapture::CollectFrame(frame, GetThreadBuffer().threadIndex);
+}
+
+double Profiler::TicksToMs(int64_t ticks)
+{
+    return static_cast<double>(ticks) * msPerTick.load(std::memory_order_relaxed);
+}
+
+std::vector<ProfileFrame> Profiler::GetFrames()
+{
+    std::lock_guard<std::mutex> lock(framesMutex);
+
+    size_t count = frameCount < MAX_FRAMES ? frameCount : MAX_FRAMES;
+    std::vector<ProfileFrame> result;
+    result.reserve(count);
+
+    for (size_t i = frameCount - count; i < frameCount; ++i)
+        result.push_back(frames[i % MAX_FRAMES]);
+
+    return result;
+}
+
+std::vector<ProfilerThreadBuffer *> Profiler::GetThreadBuffers()
+{
+    std::lock_guard<std::mutex> lock(threadsMutex);
+
+    std::vector<ProfilerThreadBuffer *> result;
+    result.reserve(threads.size());
+    for (auto &thread : threads)
+        result.push_back(thread.get());
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,169 @@
+#pragma once
+
+// Frame profiler, every zone is just two timestamps pushed into a ring buffer owned by the thread that recorded it.
+// Build without PROFILER_ENABLED and all the macros below turn into nothing, so release builds pay zero for it.
+//
+// Usage:
+//     PROFILE_SCOPE("Picking");       // times until the end of the current scope, the name MUST be a string literal
+//     PROFILE_BEGIN_FRAME();          // top of the main loop
+//     PROFILE_END_FRAME();            // after EndDrawing
+
+#ifdef PROFILER_ENABLED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if !defined(PROFILER_USE_STEADY_CLOCK) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86))
+#define PROFILER_USE_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+struct ProfileZone
+{
+    // Only the pointer is stored, so it has to outlive the profiler (string literals do)
+    const char *name;
+    int64_t start;
+    int64_t end;
+    uint32_t depth;
+};
+
+struct ProfilerThreadBuffer
+{
+    // Power of two so wrapping is a mask, 64k zones is a couple thousand frames worth of history
+    static constexpr uint64_t CAPACITY = 1 << 16;
+    static constexpr uint64_t MASK = CAPACITY - 1;
+    // Readers start this far short of a full lap, the oldest slots are the next ones the owner overwrites
+    static constexpr uint64_t READ_MARGIN = 1024;
+
+    ProfileZone zones[CAPACITY];
+    // Only the owning thread writes, readers (the UI, trace capture) take a snapshot of the index and check OldestIntact after copying
+    std::atomic<uint64_t> writeIndex{0};
+    uint32_t depth = 0;
+    uint32_t threadIndex = 0;
+
+    void Push(const char *name, int64_t start, int64_t end, uint32_t zoneDepth)
+    {
+        uint64_t index = writeIndex.load(std::memory_order_relaxed);
+        zones[index & MASK] = {name, start, end, zoneDepth};
+        writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    // Oldest index worth reading given a writeIndex snapshot
+    static uint64_t OldestReadable(uint64_t index)
+    {
+        return index > CAPACITY - READ_MARGIN ? index - (CAPACITY - READ_MARGIN) : 0;
+    }
+
+    // The owner doesn't wait for readers, so a zone copied out is only good if its slot wasn't lapped meanwhile.
+    // Call after the copy, anything older than this may be torn
+    uint64_t OldestIntact() const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t index = writeIndex.load(std::memory_order_relaxed);
+        // The owner may be halfway through writing slot index & MASK
+        return index >= CAPACITY ? index - CAPACITY + 1 : 0;
+    }
+};
+
+struct ProfileFrame
+{
+    int64_t start;
+    int64_t end;
+};
+
+class Profiler
+{
+public:
+    static constexpr size_t MAX_FRAMES = 300;
+
+    static inline int64_t Now()
+    {
+#ifdef PROFILER_USE_RDTSC
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // Lazily registers the calling thread the first time it records something
+    static inline ProfilerThreadBuffer &GetThreadBuffer()
+    {
+        thread_local ProfilerThreadBuffer *buffer = RegisterThread();
+        return *buffer;
+    }
+
+    static void BeginFrame();
+    static void EndFrame();
+
+    static double TicksToMs(int64_t ticks);
+
+    // Copies out the last frames, oldest first
+    static std::vector<ProfileFrame> GetFrames();
+    static std::vector<ProfilerThreadBuffer *> GetThreadBuffers();
+
+private:
+    static ProfilerThreadBuffer *RegisterThread();
+    static void Calibrate();
+
+    static std::mutex threadsMutex;
+    static std::vector<std::unique_ptr<ProfilerThreadBuffer>> threads;
+
+    static std::mutex framesMutex;
+    static ProfileFrame frames[MAX_FRAMES];
+    static size_t frameCount;
+    static int64_t currentFrameStart;
+
+    // Written by the main thread while calibrating, read by the UI and the trace writer
+    static std::atomic<double> msPerTick;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *zoneName)
+        : name(zoneName), buffer(Profiler::GetThreadBuffer())
+    {
+        depth = buffer.depth++;
+        start = Profiler::Now();
+    }
+
+    ~ProfileScope()
+    {
+        int64_t end = Profiler::Now();
+        buffer.depth--;
+        buffer.Push(name, start, end, depth);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name;
+    ProfilerThreadBuffer &buffer;
+    int64_t start;
+    uint32_t depth;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_BEGIN_FRAME() Profiler::BeginFrame()
+#define PROFILE_END_FRAME() Profiler::EndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_BEGIN_FRAME()
+#define PROFILE_END_FRAME()
+
+#endif
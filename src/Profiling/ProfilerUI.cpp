@@ -0,0 +1,184 @@
+#include "ProfilerUI.h"
+#include "Profiler.h"
+#include "TraceCapture.h"
+
+#ifdef PROFILER_ENABLED
+
+#include "../../imgui/imgui.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // Same zone name always gets the same color, easier to follow between frames
+    ImU32 GetZoneColor(const char *name)
+    {
+        uint64_t hash = reinterpret_cast<uintptr_t>(name);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        float hue = static_cast<float>(hash % 360) / 360.0f;
+        return ImColor::HSV(hue, 0.55f, 0.85f);
+    }
+
+    // Zones are pushed when they end, so walking backwards from the newest one we can stop at the first one that ended before the range
+    void CollectZones(ProfilerThreadBuffer *buffer, int64_t rangeStart, int64_t rangeEnd, std::vector<ProfileZone> &out, uint32_t &maxDepth)
+    {
+        uint64_t writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+        uint64_t oldest = ProfilerThreadBuffer::OldestReadable(writeIndex);
+
+        for (uint64_t i = writeIndex; i-- > oldest;)
+        {
+            ProfileZone zone = buffer->zones[i & ProfilerThreadBuffer::MASK];
+            // Lapped while we got here, this one and everything older is overwritten
+            if (i < buffer->OldestIntact())
+                break;
+            if (zone.end < rangeStart)
+                break;
+            if (zone.start > rangeEnd)
+                continue;
+
+            out.push_back(zone);
+            maxDepth = std::max(maxDepth, zone.depth);
+        }
+    }
+}
+
+void RenderProfilerUI()
+{
+    static bool paused = false;
+    static int framesShown = 1;
+    static int selectedFrame = -1; // -1 follows the newest frame
+    static std::vector<ProfileFrame> frames;
+    static std::vector<float> frameTimes;
+    static std::vector<ProfileZone> laneZones;
+
+    ImGui::Begin("Profiler");
+
+    if (!paused)
+        frames = Profiler::GetFrames();
+
+    if (frames.empty())
+    {
+        ImGui::Text("No frames recorded yet");
+        ImGui::End();
+        return;
+    }
+
+    int frameCount = static_cast<int>(frames.size());
+    frameTimes.resize(frames.size());
+    float totalMs = 0.0f;
+    float maxMs = 0.0f;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        frameTimes[i] = static_cast<float>(Profiler::TicksToMs(frames[i].end - frames[i].start));
+        totalMs += frameTimes[i];
+        maxMs = std::max(maxMs, frameTimes[i]);
+    }
+    float avgMs = totalMs / frameCount;
+
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+    if (ImGui::Button("Latest"))
+    {
+        selectedFrame = -1;
+        paused = false;
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(150.0f);
+    ImGui::SliderInt("Frames shown", &framesShown, 1, 30);
+
+    if (TraceCapture::IsCapturing())
+    {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "REC %s (%llu events, %llu dropped)", TraceCapture::GetPath().c_str(),
+                           static_cast<unsigned long long>(TraceCapture::GetWrittenEvents()), static_cast<unsigned long long>(TraceCapture::GetDroppedEvents()));
+    }
+    else
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("F9 to capture a trace");
+    }
+
+    ImGui::Text("Avg: %.2f ms (%.0f FPS)   Max: %.2f ms", avgMs, avgMs > 0.0f ? 1000.0f / avgMs : 0.0f, maxMs);
+
+    ImGui::PlotHistogram("##FrameTimes", frameTimes.data(), frameCount, 0, nullptr, 0.0f, maxMs * 1.1f, ImVec2(-1, 80));
+
+    // Clicking the graph picks the frame to inspect, pausing too so it doesn't scroll away underneath you
+    if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+    {
+        ImVec2 graphMin = ImGui::GetItemRectMin();
+        ImVec2 graphMax = ImGui::GetItemRectMax();
+        float t = (ImGui::GetIO().MousePos.x - graphMin.x) / std::max(1.0f, graphMax.x - graphMin.x);
+        selectedFrame = std::clamp(static_cast<int>(t * frameCount), 0, frameCount - 1);
+        paused = true;
+    }
+
+    int lastFrame = selectedFrame < 0 ? frameCount - 1 : std::min(selectedFrame, frameCount - 1);
+    int firstFrame = std::max(0, lastFrame - framesShown + 1);
+    int64_t rangeStart = frames[firstFrame].start;
+    int64_t rangeEnd = frames[lastFrame].end;
+    double rangeTicks = static_cast<double>(std::max<int64_t>(1, rangeEnd - rangeStart));
+
+    ImGui::Text("Frame %d: %.2f ms", lastFrame, frameTimes[lastFrame]);
+    ImGui::Separator();
+
+    ImGui::BeginChild("FlameChart", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    float width = ImGui::GetContentRegionAvail().x;
+    float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    ImVec2 mousePos = ImGui::GetIO().MousePos;
+
+    for (ProfilerThreadBuffer *buffer : Profiler::GetThreadBuffers())
+    {
+        laneZones.clear();
+        uint32_t maxDepth = 0;
+        CollectZones(buffer, rangeStart, rangeEnd, laneZones, maxDepth);
+        if (laneZones.empty())
+            continue;
+
+        ImGui::TextDisabled("Thread %u", buffer->threadIndex);
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float laneHeight = (maxDepth + 1) * rowHeight;
+
+        // Frame boundaries, only really useful when showing more than one frame
+        for (int i = firstFrame + 1; i <= lastFrame; ++i)
+        {
+            float x = origin.x + static_cast<float>((frames[i].start - rangeStart) / rangeTicks) * width;
+            drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, origin.y + laneHeight), IM_COL32(255, 255, 255, 80));
+        }
+
+        for (const ProfileZone &zone : laneZones)
+        {
+            float x0 = origin.x + static_cast<float>((std::max(zone.start, rangeStart) - rangeStart) / rangeTicks) * width;
+            float x1 = origin.x + static_cast<float>((std::min(zone.end, rangeEnd) - rangeStart) / rangeTicks) * width;
+            x1 = std::max(x1, x0 + 1.0f);
+            float y0 = origin.y + zone.depth * rowHeight;
+            float y1 = y0 + rowHeight - 1.0f;
+
+            drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), GetZoneColor(zone.name));
+
+            ImVec2 textSize = ImGui::CalcTextSize(zone.name);
+            if (x1 - x0 > textSize.x + 4.0f)
+                drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(20, 20, 20, 255), zone.name);
+
+            if (ImGui::IsWindowHovered() && mousePos.x >= x0 && mousePos.x < x1 && mousePos.y >= y0 && mousePos.y < y1)
+                ImGui::SetTooltip("%s\n%.3f ms", zone.name, Profiler::TicksToMs(zone.end - zone.start));
+        }
+
+        ImGui::Dummy(ImVec2(width, laneHeight));
+    }
+
+    ImGui::EndChild();
+    ImGui::End();
+}
+
+#else
+
+void RenderProfilerUI()
+{
+}
+
+#endif
@@ -0,0 +1,4 @@
+#pragma once
+
+// Frame graph + flame chart window, only does anything when the profiler is compiled in
+void RenderProfilerUI();
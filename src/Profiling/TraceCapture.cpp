@@ -0,0 +1,197 @@
+#include "TraceCapture.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <cstdio>
+
+std::atomic<bool> TraceCapture::capturing{false};
+std::string TraceCapture::path;
+std::ofstream TraceCapture::file;
+std::thread TraceCapture::writer;
+
+std::mutex TraceCapture::queueMutex;
+std::condition_variable TraceCapture::queueCondition;
+std::vector<TraceEvent> TraceCapture::pending;
+bool TraceCapture::stopRequested = false;
+
+std::vector<uint64_t> TraceCapture::cursors;
+int64_t TraceCapture::captureStart = 0;
+
+std::atomic<uint64_t> TraceCapture::writtenEvents{0};
+std::atomic<uint64_t> TraceCapture::droppedEvents{0};
+
+// Marks the frame boundaries in the trace, shows up as the outermost zone on the main thread
+static const char *FRAME_EVENT_NAME = "Frame";
+// Enough for a few hundred zones per frame without growing, the queue can still grow up to MAX_PENDING_EVENTS
+static constexpr size_t INITIAL_RESERVE = 1 << 14;
+
+bool TraceCapture::Start(const std::string &capturePath)
+{
+    if (IsCapturing())
+        return false;
+
+    file.open(capturePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    path = capturePath;
+    writtenEvents = 0;
+    droppedEvents = 0;
+    stopRequested = false;
+    pending.clear();
+    pending.reserve(INITIAL_RESERVE);
+    captureStart = Profiler::Now();
+
+    // Skip everything that was recorded before the capture started
+    cursors.clear();
+    for (ProfilerThreadBuffer *buffer : Profiler::GetThreadBuffers())
+    {
+        if (cursors.size() <= buffer->threadIndex)
+            cursors.resize(buffer->threadIndex + 1, 0);
+        cursors[buffer->threadIndex] = buffer->writeIndex.load(std::memory_order_acquire);
+    }
+
+    writer = std::thread(WriterLoop);
+    capturing = true;
+    return true;
+}
+
+void TraceCapture::Stop()
+{
+    if (!IsCapturing())
+        return;
+
+    capturing = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+    }
+    queueCondition.notify_one();
+
+    if (writer.joinable())
+        writer.join();
+    file.close();
+}
+
+void TraceCapture::CollectFrame(const ProfileFrame &frame, uint32_t frameThreadIndex)
+{
+    std::vector<ProfilerThreadBuffer *> buffers = Profiler::GetThreadBuffers();
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+
+    auto push = [](const TraceEvent &event)
+    {
+        if (pending.size() < MAX_PENDING_EVENTS)
+            pending.push_back(event);
+        else
+            droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    push({FRAME_EVENT_NAME, frame.start, frame.end, frameThreadIndex});
+
+    for (ProfilerThreadBuffer *buffer : buffers)
+    {
+        // Threads that registered after the capture started begin at 0, which is what we want
+        if (cursors.size() <= buffer->threadIndex)
+            cursors.resize(buffer->threadIndex + 1, 0);
+
+        uint64_t &cursor = cursors[buffer->threadIndex];
+        uint64_t writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+
+        // The ring lapped us, those zones are gone
+        uint64_t oldest = ProfilerThreadBuffer::OldestReadable(writeIndex);
+        if (cursor < oldest)
+        {
+            droppedEvents.fetch_add(oldest - cursor, std::memory_order_relaxed);
+            cursor = oldest;
+        }
+
+        for (; cursor < writeIndex; ++cursor)
+        {
+            ProfileZone zone = buffer->zones[cursor & ProfilerThreadBuffer::MASK];
+            // The owner can still lap us while we copy, a torn zone is dropped rather than written out
+            if (cursor < buffer->OldestIntact())
+                droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            else
+                push({zone.name, zone.start, zone.end, buffer->threadIndex});
+        }
+    }
+
+    queueCondition.notify_one();
+}
+
+void TraceCapture::WriteEvent(std::string &out, const TraceEvent &event, bool &first)
+{
+    // Zone names are string literals, but escape them anyway so a weird one can't break the whole file
+    std::string name;
+    for (const char *c = event.name; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            name += '\\';
+        name += *c;
+    }
+
+    double timestampUs = Profiler::TicksToMs(event.start - captureStart) * 1000.0;
+    double durationUs = Profiler::TicksToMs(event.end - event.start) * 1000.0;
+
+    char line[128];
+    snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}", timestampUs, durationUs, event.threadIndex);
+
+    out += first ? "{\"name\":\"" : ",\n{\"name\":\"";
+    out += name;
+    out += line;
+    first = false;
+}
+
+void TraceCapture::WriterLoop()
+{
+    std::vector<TraceEvent> batch;
+    batch.reserve(INITIAL_RESERVE);
+    std::vector<bool> namedThreads;
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+
+    while (true)
+    {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, []
+                                { return stopRequested || !pending.empty(); });
+            // Swapping keeps both vectors at their reserved size, no allocations after the first frames
+            batch.swap(pending);
+            stopping = stopRequested;
+        }
+
+        for (const TraceEvent &event : batch)
+        {
+            if (namedThreads.size() <= event.threadIndex)
+                namedThreads.resize(event.threadIndex + 1, false);
+
+            if (!namedThreads[event.threadIndex])
+            {
+                char meta[128];
+                snprintf(meta, sizeof(meta), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}", first ? "" : ",\n", event.threadIndex, event.threadIndex);
+                out += meta;
+                first = false;
+                namedThreads[event.threadIndex] = true;
+            }
+
+            WriteEvent(out, event, first);
+        }
+
+        writtenEvents.fetch_add(batch.size(), std::memory_order_relaxed);
+        batch.clear();
+
+        file << out;
+        out.clear();
+
+        if (stopping)
+            break;
+    }
+
+    file << "\n]}\n";
+    file.flush();
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+// Streams profiler zones to a Chrome trace-event JSON file (open it in chrome://tracing or ui.perfetto.dev).
+// The main thread only copies zones into a bounded queue at the end of every frame, a background thread does the
+// formatting and writing, so a capture can run for a whole editing session without hitching or eating memory.
+
+#ifdef PROFILER_ENABLED
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Profiler.h"
+
+struct TraceEvent
+{
+    const char *name;
+    int64_t start;
+    int64_t end;
+    uint32_t threadIndex;
+};
+
+class TraceCapture
+{
+public:
+    // Caps the queue between the main thread and the writer, roughly 8MB, anything past that gets dropped and counted
+    static constexpr size_t MAX_PENDING_EVENTS = 1 << 18;
+
+    static bool Start(const std::string &path);
+    static void Stop();
+    static bool IsCapturing() { return capturing.load(std::memory_order_relaxed); }
+    static const std::string &GetPath() { return path; }
+    static uint64_t GetWrittenEvents() { return writtenEvents.load(std::memory_order_relaxed); }
+    static uint64_t GetDroppedEvents() { return droppedEvents.load(std::memory_order_relaxed); }
+
+    // Called by the profiler at the end of every frame, grabs everything recorded since the last call
+    static void CollectFrame(const ProfileFrame &frame, uint32_t frameThreadIndex);
+
+private:
+    static void WriterLoop();
+    static void WriteEvent(std::string &out, const TraceEvent &event, bool &first);
+
+    static std::atomic<bool> capturing;
+    static std::string path;
+    static std::ofstream file;
+    static std::thread writer;
+
+    static std::mutex queueMutex;
+    static std::condition_variable queueCondition;
+    static std::vector<TraceEvent> pending;
+    static bool stopRequested;
+
+    // Per profiler thread buffer, how far we already copied
+    static std::vector<uint64_t> cursors;
+    static int64_t captureStart;
+
+    static std::atomic<uint64_t> writtenEvents;
+    static std::atomic<uint64_t> droppedEvents;
+};
+
+#endif
@@ -0,0 +1,303 @@
+#include "DepthRasterizer.h"
+#include <raymath.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include "../Simd.h"
+
+namespace
+{
+    const Vector3 BOX_CORNERS[8] = {
+        {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}, {0.5f, 0.5f, -0.5f},
+        {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}};
+
+    // Winding doesn't matter, both sides get rasterized
+    const int BOX_TRIANGLES[36] = {
+        0, 1, 3, 0, 3, 2, // -z
+        4, 6, 7, 4, 7, 5, // +z
+        0, 2, 6, 0, 6, 4, // -x
+        1, 5, 7, 1, 7, 3, // +x
+        0, 4, 5, 0, 5, 1, // -y
+        2, 3, 7, 2, 7, 6, // +y
+    };
+
+    Vector4 TransformClip(Vector3 p, const Matrix &m)
+    {
+        return {
+            m.m0 * p.x + m.m4 * p.y + m.m8 * p.z + m.m12,
+            m.m1 * p.x + m.m5 * p.y + m.m9 * p.z + m.m13,
+            m.m2 * p.x + m.m6 * p.y + m.m10 * p.z + m.m14,
+            m.m3 * p.x + m.m7 * p.y + m.m11 * p.z + m.m15};
+    }
+
+    Vector4 LerpClip(Vector4 a, Vector4 b, float t)
+    {
+        return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t};
+    }
+}
+
+DepthRasterizer::DepthRasterizer() : viewProjection(MatrixIdentity())
+{
+    for (int level = 0; level < LEVEL_COUNT; ++level)
+        levels[level].assign((WIDTH >> level) * (HEIGHT >> level), 0.0f);
+}
+
+void DepthRasterizer::Begin(const Matrix &matrix)
+{
+    viewProjection = matrix;
+    triangleCount = 0;
+    std::fill(levels[0].begin(), levels[0].end(), 0.0f);
+}
+
+void DepthRasterizer::RasterizeBox(const Matrix &transform)
+{
+    Matrix mvp = MatrixMultiply(transform, viewProjection);
+
+    Vector4 corners[8];
+    for (int i = 0; i < 8; ++i)
+        corners[i] = TransformClip(BOX_CORNERS[i], mvp);
+
+    for (int i = 0; i < 36; i += 3)
+        RasterizeClipTriangle(corners[BOX_TRIANGLES[i]], corners[BOX_TRIANGLES[i + 1]], corners[BOX_TRIANGLES[i + 2]]);
+}
+
+void DepthRasterizer::RasterizeMesh(const Mesh &mesh, const Matrix &transform)
+{
+    if (!mesh.vertices)
+        return;
+
+    Matrix mvp = MatrixMultiply(transform, viewProjection);
+
+    // Indexed meshes share vertices between triangles, transform each one once
+    clipVertices.resize(mesh.vertexCount);
+    for (int i = 0; i < mesh.vertexCount; ++i)
+        clipVertices[i] = TransformClip({mesh.vertices[i * 3], mesh.vertices[i * 3 + 1], mesh.vertices[i * 3 + 2]}, mvp);
+
+    for (int i = 0; i < mesh.triangleCount; ++i)
+    {
+        int a = mesh.indices ? mesh.indices[i * 3 + 0] : i * 3 + 0;
+        int b = mesh.indices ? mesh.indices[i * 3 + 1] : i * 3 + 1;
+        int c = mesh.indices ? mesh.indices[i * 3 + 2] : i * 3 + 2;
+        RasterizeClipTriangle(clipVertices[a], clipVertices[b], clipVertices[c]);
+    }
+}
+
+void DepthRasterizer::RasterizeClipTriangle(Vector4 a, Vector4 b, Vector4 c)
+{
+    // Completely outside one side of the frustum, nothing to draw
+    if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+        (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w))
+        return;
+
+    ++triangleCount;
+
+    // Only the near plane gets clipped for real, the screen edges are handled by clamping the bounding rect
+    Vector4 input[3] = {a, b, c};
+    Vector4 clipped[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const Vector4 &current = input[i];
+        const Vector4 &next = input[(i + 1) % 3];
+        bool currentInside = current.w >= NEAR_W;
+        bool nextInside = next.w >= NEAR_W;
+
+        if (currentInside)
+            clipped[count++] = current;
+        if (currentInside != nextInside)
+            clipped[count++] = LerpClip(current, next, (NEAR_W - current.w) / (next.w - current.w));
+    }
+    if (count < 3)
+        return;
+
+    ScreenVertex screen[4];
+    for (int i = 0; i < count; ++i)
+    {
+        float invW = 1.0f / clipped[i].w;
+        screen[i] = {(clipped[i].x * invW * 0.5f + 0.5f) * WIDTH, (0.5f - clipped[i].y * invW * 0.5f) * HEIGHT, invW};
+    }
+
+    RasterizeScreenTriangle(screen[0], screen[1], screen[2]);
+    if (count == 4)
+        RasterizeScreenTriangle(screen[0], screen[2], screen[3]);
+}
+
+void DepthRasterizer::RasterizeScreenTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c)
+{
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (fabsf(area) < 1e-8f)
+        return;
+    if (area < 0.0f)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    // Clamp while still floats, near plane vertices can land way outside the int range
+    float left = std::max(0.0f, std::min({a.x, b.x, c.x}));
+    float right = std::min(WIDTH - 1.0f, std::max({a.x, b.x, c.x}));
+    float top = std::max(0.0f, std::min({a.y, b.y, c.y}));
+    float bottom = std::min(HEIGHT - 1.0f, std::max({a.y, b.y, c.y}));
+    if (left > right || top > bottom)
+        return;
+
+    int minX = static_cast<int>(left);
+    int maxX = static_cast<int>(right);
+    int minY = static_cast<int>(top);
+    int maxY = static_cast<int>(bottom);
+
+    // Edge functions as A*x + B*y + C, each one is the (area scaled) weight of the opposite vertex
+    float a0 = b.y - c.y, b0 = c.x - b.x, c0 = -(a0 * b.x + b0 * b.y);
+    float a1 = c.y - a.y, b1 = a.x - c.x, c1 = -(a1 * c.x + b1 * c.y);
+    float a2 = a.y - b.y, b2 = b.x - a.x, c2 = -(a2 * a.x + b2 * a.y);
+
+    // 1/w is linear in screen space, so depth is a plane too
+    float invArea = 1.0f / area;
+    float zA = (a0 * a.z + a1 * b.z + a2 * c.z) * invArea;
+    float zB = (b0 * a.z + b1 * b.z + b2 * c.z) * invArea;
+    float zC = (c0 * a.z + c1 * b.z + c2 * c.z) * invArea;
+
+    float *depth = levels[0].data();
+
+#ifdef EDITOR_SSE2
+    // 4 pixels at a time, starting on a multiple of 4 is fine since WIDTH is one and the edge test drops the extras
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 edgeA0 = _mm_set1_ps(a0), edgeA1 = _mm_set1_ps(a1), edgeA2 = _mm_set1_ps(a2), depthA = _mm_set1_ps(zA);
+    int startX = minX & ~3;
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float py = y + 0.5f;
+        __m128 row0 = _mm_set1_ps(b0 * py + c0);
+        __m128 row1 = _mm_set1_ps(b1 * py + c1);
+        __m128 row2 = _mm_set1_ps(b2 * py + c2);
+        __m128 rowZ = _mm_set1_ps(zB * py + zC);
+        float *row = depth + y * WIDTH;
+
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA0, px), row0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA1, px), row1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA2, px), row2);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            if (!_mm_movemask_ps(inside))
+                continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(depthA, px), rowZ);
+            __m128 old = _mm_loadu_ps(row + x);
+            __m128 closest = _mm_max_ps(old, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, old)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y)
+    {
+        float py = y + 0.5f;
+        float *row = depth + y * WIDTH;
+        for (int x = minX; x <= maxX; ++x)
+        {
+            float px = x + 0.5f;
+            if (a0 * px + b0 * py + c0 < 0.0f || a1 * px + b1 * py + c1 < 0.0f || a2 * px + b2 * py + c2 < 0.0f)
+                continue;
+            row[x] = std::max(row[x], zA * px + zB * py + zC);
+        }
+    }
+#endif
+}
+
+void DepthRasterizer::BuildHierarchy()
+{
+    // Every texel keeps the farthest (smallest 1/w) of the 2x2 below it, so it never claims more occlusion than there is
+    for (int level = 1; level < LEVEL_COUNT; ++level)
+    {
+        const float *source = levels[level - 1].data();
+        float *target = levels[level].data();
+        int sourceWidth = WIDTH >> (level - 1);
+        int width = WIDTH >> level;
+        int height = HEIGHT >> level;
+
+        for (int y = 0; y < height; ++y)
+        {
+            const float *row0 = source + (y * 2) * sourceWidth;
+            const float *row1 = row0 + sourceWidth;
+            float *out = target + y * width;
+
+#ifdef EDITOR_SSE2
+            for (int x = 0; x < width; x += 4)
+            {
+                __m128 low = _mm_min_ps(_mm_loadu_ps(row0 + x * 2), _mm_loadu_ps(row1 + x * 2));
+                __m128 high = _mm_min_ps(_mm_loadu_ps(row0 + x * 2 + 4), _mm_loadu_ps(row1 + x * 2 + 4));
+                __m128 even = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 odd = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_ps(out + x, _mm_min_ps(even, odd));
+            }
+#else
+            for (int x = 0; x < width; ++x)
+                out[x] = std::min(std::min(row0[x * 2], row0[x * 2 + 1]), std::min(row1[x * 2], row1[x * 2 + 1]));
+#endif
+        }
+    }
+}
+
+bool DepthRasterizer::IsVisible(const OrientedBox &box) const
+{
+    float left = FLT_MAX, right = -FLT_MAX, top = FLT_MAX, bottom = -FLT_MAX;
+    float nearest = 0.0f;
+    int behind = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        Vector4 clip = TransformClip(box.GetCorner(i), viewProjection);
+        if (clip.w < NEAR_W)
+        {
+            ++behind;
+            continue;
+        }
+
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+        float y = (0.5f - clip.y * invW * 0.5f) * HEIGHT;
+        left = std::min(left, x);
+        right = std::max(right, x);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y);
+        nearest = std::max(nearest, invW);
+    }
+
+    if (behind == 8)
+        return false;
+    // Goes through the near plane, the corners in front don't bound it on screen anymore
+    if (behind > 0)
+        return true;
+    if (right < 0.0f || bottom < 0.0f || left > WIDTH || top > HEIGHT)
+        return false;
+
+    // One texel of margin, occluders cover whole texels when the center is inside, so a box peeking out from
+    // behind an edge by less than a texel would get culled otherwise
+    int minX = static_cast<int>(std::max(0.0f, left - 1.0f));
+    int maxX = static_cast<int>(std::min(WIDTH - 1.0f, right + 1.0f));
+    int minY = static_cast<int>(std::max(0.0f, top - 1.0f));
+    int maxY = static_cast<int>(std::min(HEIGHT - 1.0f, bottom + 1.0f));
+
+    // Coarsest level where the rect still spans at most 4x4 texels
+    int level = 0;
+    while (level < LEVEL_COUNT - 1 && ((maxX >> level) - (minX >> level) > 3 || (maxY >> level) - (minY >> level) > 3))
+        ++level;
+
+    // Bit of slack, faces lying exactly on an occluder (like an occluder's own front face) shouldn't cull themselves
+    float threshold = nearest * 1.001f;
+    const float *texels = levels[level].data();
+    int width = WIDTH >> level;
+    for (int y = minY >> level; y <= maxY >> level; ++y)
+    {
+        for (int x = minX >> level; x <= maxX >> level; ++x)
+        {
+            if (texels[y * width + x] < threshold)
+                return true;
+        }
+    }
+    return false;
+}
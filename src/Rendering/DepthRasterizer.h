@@ -0,0 +1,52 @@
+#pragma once
+
+#include <raylib.h>
+#include <vector>
+#include "../LevelEditor/OrientedBox.h"
+
+// Low resolution software depth buffer for occlusion culling. Big occluders get rasterized on the CPU, then a pyramid
+// of "farthest depth in this block" levels is built over it, so testing a box only reads a few texels no matter how
+// big it is on screen. Depth is 1/w (bigger = closer, 0 = nothing drawn). Plain memory, no GL context needed.
+class DepthRasterizer
+{
+public:
+    // Both have to stay divisible by 2^(LEVEL_COUNT - 1), width by 4 times that for the SIMD paths
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 128;
+    static constexpr int LEVEL_COUNT = 5;
+    // Same as rlgl's RL_CULL_DISTANCE_NEAR, anything closer than this never gets drawn anyway
+    static constexpr float NEAR_W = 0.01f;
+
+    DepthRasterizer();
+
+    // Clears the buffer, everything after this goes through viewProjection
+    void Begin(const Matrix &viewProjection);
+
+    // The -0.5..0.5 cube through transform (size, scale, rotation and position all baked in)
+    void RasterizeBox(const Matrix &transform);
+    // Every triangle of the mesh, uses the CPU copy of the vertices raylib keeps after uploading
+    void RasterizeMesh(const Mesh &mesh, const Matrix &transform);
+
+    // After the last occluder and before the first IsVisible
+    void BuildHierarchy();
+
+    // False when the whole box is off screen or behind what got rasterized
+    bool IsVisible(const OrientedBox &box) const;
+
+    int GetTriangleCount() const { return triangleCount; }
+    const float *GetLevel(int level) const { return levels[level].data(); }
+
+private:
+    struct ScreenVertex
+    {
+        float x, y, z;
+    };
+
+    void RasterizeClipTriangle(Vector4 a, Vector4 b, Vector4 c);
+    void RasterizeScreenTriangle(ScreenVertex a, ScreenVertex b, ScreenVertex c);
+
+    Matrix viewProjection;
+    std::vector<float> levels[LEVEL_COUNT];
+    std::vector<Vector4> clipVertices;
+    int triangleCount = 0;
+};
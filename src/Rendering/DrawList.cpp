@@ -0,0 +1,161 @@
+#include "DrawList.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "../Jobs/JobSystem.h"
+#include "../LevelEditor/Collision.h"
+#include "../LevelEditor/EntityView.h"
+#include "../Profiling/Profiler.h"
+
+void DrawList::Build(const std::vector<GameEntity *> &entities, const Camera3D &camera, float aspect, GameEntity *selectedEntity,
+                     const std::vector<uint8_t> *visible)
+{
+    PROFILE_SCOPE("DrawList::Build");
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = entities.size();
+    size_t chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    transforms.Resize(count);
+    worldMatrices.resize(count);
+    slots.resize(count);
+    keep.assign(count, 0);
+    chunkCounts.assign(chunkCount, 0);
+
+    // The culler already threw out everything off screen, no point doing the planes twice
+    bool testFrustum = !visible && camera.projection == CAMERA_PERSPECTIVE && aspect > 0.0f;
+    Frustum frustum = {};
+    if (testFrustum)
+        frustum = Frustum::FromMatrix(OcclusionCuller::GetViewProjection(camera, aspect));
+    std::atomic<int> outsideFrustum{0};
+
+    // World matrices for everything in one go first, a chunk at a time so the copy is still warm for the kernel
+    auto buildMatrices = [&](size_t begin, size_t end)
+    {
+        PROFILE_SCOPE("DrawList Matrices");
+        for (size_t i = begin; i < end; ++i)
+            transforms.Set(i, entities[i]->EntityTransform);
+        TransformBatch::ComputeWorldMatrices(transforms, begin, end, worldMatrices.data());
+    };
+    JobSystem::ParallelFor(count, CHUNK_SIZE, buildMatrices);
+
+    // Only what has something to draw, one view per shape. Every entity is in at most one of them (they share a
+    // category) and only writes its own slot, so they go wide and the packing below still comes out in entity order
+    const auto &cubes = View<CubeComponent>(entities);
+    const auto &spheres = View<SphereComponent>(entities);
+    const auto &models = View<ModelComponent>(entities);
+
+    // What all shapes share, getBox gets the world matrix and says whether there are bounds. 1 when it's off screen
+    auto place = [&](GameEntity *entity, uint32_t index, DrawShape shape, Component *component, auto getBox)
+    {
+        bool selected = entity == selectedEntity;
+        if (visible && !(*visible)[index] && !selected)
+            return 0;
+
+        const Matrix &world = worldMatrices[index];
+
+        OrientedBox box;
+        if (testFrustum && getBox(world, box) && !selected && !Collision::FrustumOrientedBox(frustum, box))
+            return 1;
+
+        slots[index] = {index, shape, selected, component};
+        keep[index] = 1;
+        return 0;
+    };
+
+    auto buildCubes = [&](size_t begin, size_t end)
+    {
+        PROFILE_SCOPE("DrawList Cubes");
+        int outside = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            CubeComponent *cube = cubes[i].Get<CubeComponent>();
+            outside += place(cubes[i].entity, cubes[i].index, DrawShape::Cube, cube, [&](const Matrix &, OrientedBox &box)
+                             {
+                                 box = cube->GetOrientedBox();
+                                 return true;
+                             });
+        }
+        outsideFrustum += outside;
+    };
+    auto buildSpheres = [&](size_t begin, size_t end)
+    {
+        PROFILE_SCOPE("DrawList Spheres");
+        int outside = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            SphereComponent *sphere = spheres[i].Get<SphereComponent>();
+            outside += place(spheres[i].entity, spheres[i].index, DrawShape::Sphere, sphere, [&](const Matrix &world, OrientedBox &box)
+                             {
+                                 float radius = sphere->radius;
+                                 box = OrientedBox::FromTransform({{-radius, -radius, -radius}, {radius, radius, radius}}, world);
+                                 return true;
+                             });
+        }
+        outsideFrustum += outside;
+    };
+    auto buildModels = [&](size_t begin, size_t end)
+    {
+        PROFILE_SCOPE("DrawList Models");
+        int outside = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            ModelComponent *model = models[i].Get<ModelComponent>();
+            outside += place(models[i].entity, models[i].index, DrawShape::Model, model, [&](const Matrix &world, OrientedBox &box)
+                             {
+                                 // Not loaded yet = no bounds, that happens on the main thread when it gets drawn
+                                 if (!model->IsLoaded())
+                                     return false;
+                                 box = OrientedBox::FromTransform(model->bounds, world);
+                                 return true;
+                             });
+        }
+        outsideFrustum += outside;
+    };
+    JobSystem::ParallelFor(cubes.size(), CHUNK_SIZE, buildCubes);
+    JobSystem::ParallelFor(spheres.size(), CHUNK_SIZE, buildSpheres);
+    JobSystem::ParallelFor(models.size(), CHUNK_SIZE, buildModels);
+
+    auto countChunks = [&](size_t firstChunk, size_t lastChunk)
+    {
+        for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+        {
+            size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+            size_t kept = 0;
+            for (size_t i = chunk * CHUNK_SIZE; i < end; ++i)
+                kept += keep[i];
+            chunkCounts[chunk] = kept;
+        }
+    };
+    JobSystem::ParallelFor(chunkCount, 4, countChunks);
+
+    // Chunk offsets, then every chunk copies its items over in parallel. Keeps entity order, so drawing looks the same
+    size_t total = 0;
+    for (size_t &chunkSize : chunkCounts)
+    {
+        size_t offset = total;
+        total += chunkSize;
+        chunkSize = offset;
+    }
+    items.resize(total);
+
+    auto packChunks = [&](size_t firstChunk, size_t lastChunk)
+    {
+        for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+        {
+            size_t out = chunkCounts[chunk];
+            size_t end = std::min(count, (chunk + 1) * CHUNK_SIZE);
+            for (size_t i = chunk * CHUNK_SIZE; i < end; ++i)
+            {
+                if (keep[i])
+                    items[out++] = slots[i];
+            }
+        }
+    };
+    JobSystem::ParallelFor(chunkCount, 4, packChunks);
+
+    stats.entities = static_cast<int>(count);
+    stats.drawn = static_cast<int>(total);
+    stats.outsideFrustum = outsideFrustum.load();
+    stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <raylib.h>
+#include <cstdint>
+#include <vector>
+#include "TransformBatch.h"
+#include "../LevelEditor/gameEntity.h"
+
+enum class DrawShape : uint8_t
+{
+    Cube,
+    Sphere,
+    Model,
+};
+
+struct DrawItem
+{
+    // Into the world matrices of the DrawList, which are in entity order
+    uint32_t index;
+    DrawShape shape;
+    bool selected;
+    Component *component;
+};
+
+struct DrawListStats
+{
+    int entities = 0;
+    int drawn = 0;
+    // Only counted when there was no occlusion result, the culler already does the frustum otherwise
+    int outsideFrustum = 0;
+    double buildMs = 0.0;
+};
+
+// Everything the scene draw needs worked out ahead of time on the job system: world matrices, bounds, frustum test
+// and the list of what to draw. Renderer::RenderComponents then only has to push it to GL on the main thread.
+class DrawList
+{
+public:
+    // Entities per job, also the chunk size the item list gets stitched together from
+    static constexpr size_t CHUNK_SIZE = 1024;
+
+    // visible is the occlusion result (one flag per entity) or nullptr. The selected entity always makes it in
+    void Build(const std::vector<GameEntity *> &entities, const Camera3D &camera, float aspect, GameEntity *selectedEntity,
+               const std::vector<uint8_t> *visible);
+
+    const std::vector<DrawItem> &GetItems() const { return items; }
+    const Matrix &GetWorldMatrix(uint32_t index) const { return worldMatrices[index]; }
+    const DrawListStats &GetStats() const { return stats; }
+
+private:
+    // Copied out of the entities every build, TransformBatch turns them into worldMatrices
+    TransformSoA transforms;
+    std::vector<Matrix> worldMatrices;
+    // Per entity, whether and as what it gets drawn, written in parallel and then packed into items
+    std::vector<DrawItem> slots;
+    std::vector<uint8_t> keep;
+    std::vector<size_t> chunkCounts;
+    std::vector<DrawItem> items;
+    DrawListStats stats;
+};
@@ -0,0 +1,118 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <cstring>
+#include <raylib.h>
+
+namespace
+{
+    constexpr int ACTIVE_FPS = 60;
+    constexpr int LINGER_FRAMES = 3;
+    constexpr uint32_t SCENE_REASONS = DIRTY_INPUT | DIRTY_CAMERA | DIRTY_ENTITY | DIRTY_ASSET_LOAD | DIRTY_WINDOW;
+}
+
+FrameMode FrameScheduler::mode = FrameMode::Adaptive;
+// First frame always draws
+uint32_t FrameScheduler::frameReasons = DIRTY_WINDOW;
+int FrameScheduler::lingerFrames = LINGER_FRAMES;
+bool FrameScheduler::waiting = false;
+double FrameScheduler::lastFrameStart = 0.0;
+float FrameScheduler::lastFrameMs = -1.0f;
+
+double FrameScheduler::windowStart = 0.0;
+double FrameScheduler::idleTime = 0.0;
+int FrameScheduler::frames = 0;
+int FrameScheduler::sceneRenders = 0;
+int FrameScheduler::windowReasonCounts[DIRTY_REASON_COUNT] = {};
+
+float FrameScheduler::framesPerSecond = 0.0f;
+float FrameScheduler::scenesPerSecond = 0.0f;
+float FrameScheduler::idleRatio = 0.0f;
+int FrameScheduler::reasonCounts[DIRTY_REASON_COUNT] = {};
+
+void FrameScheduler::SetMode(FrameMode newMode)
+{
+    mode = newMode;
+    SetTargetFPS(mode == FrameMode::Uncapped ? 0 : ACTIVE_FPS);
+
+    if (mode != FrameMode::Adaptive && waiting)
+    {
+        DisableEventWaiting();
+        waiting = false;
+    }
+    MarkDirty(DIRTY_WINDOW);
+}
+
+void FrameScheduler::BeginFrame()
+{
+    double now = GetTime();
+    if (windowStart == 0.0)
+        windowStart = now;
+
+    lastFrameMs = lastFrameStart > 0.0 && !waiting ? static_cast<float>((now - lastFrameStart) * 1000.0) : -1.0f;
+    lastFrameStart = now;
+
+    // Roll the stats over once a second, the panel shows the last complete one
+    double elapsed = now - windowStart;
+    if (elapsed >= 1.0)
+    {
+        framesPerSecond = static_cast<float>(frames / elapsed);
+        scenesPerSecond = static_cast<float>(sceneRenders / elapsed);
+        idleRatio = static_cast<float>(idleTime / elapsed);
+        std::memcpy(reasonCounts, windowReasonCounts, sizeof(reasonCounts));
+
+        windowStart = now;
+        idleTime = 0.0;
+        frames = 0;
+        sceneRenders = 0;
+        std::memset(windowReasonCounts, 0, sizeof(windowReasonCounts));
+    }
+
+    ++frames;
+    frameReasons = IsWindowResized() ? DIRTY_WINDOW : DIRTY_NONE;
+}
+
+void FrameScheduler::MarkInput(const InputFrame &current, const InputFrame &previous)
+{
+    // Held keys/buttons count too, raylib's fly cam scales by GetFrameTime so it must not sleep while you're moving
+    if (current.keys.any() || current.mouseButtons != 0 || previous.keys != current.keys || previous.mouseButtons != current.mouseButtons ||
+        current.mouseWheel.x != 0.0f || current.mouseWheel.y != 0.0f)
+        MarkDirty(DIRTY_INPUT);
+
+    if (current.mousePosition.x != previous.mousePosition.x || current.mousePosition.y != previous.mousePosition.y)
+        MarkDirty(DIRTY_MOUSE_MOVE);
+}
+
+bool FrameScheduler::ShouldRenderScene()
+{
+    return mode != FrameMode::Adaptive || (frameReasons & SCENE_REASONS) != 0;
+}
+
+void FrameScheduler::Present()
+{
+    for (int i = 0; i < DIRTY_REASON_COUNT; ++i)
+    {
+        if (frameReasons & (1u << i))
+            windowReasonCounts[i]++;
+    }
+
+    if (mode == FrameMode::Adaptive)
+    {
+        lingerFrames = frameReasons != DIRTY_NONE ? LINGER_FRAMES : std::max(lingerFrames - 1, 0);
+
+        // Waiting only kicks in inside EndDrawing, so this decides whether the gap after this frame blocks
+        bool shouldWait = lingerFrames <= 0;
+        if (shouldWait != waiting)
+        {
+            if (shouldWait)
+                EnableEventWaiting();
+            else
+                DisableEventWaiting();
+            waiting = shouldWait;
+        }
+    }
+
+    // Time in here is waiting on the frame cap or on events, either way not working
+    double start = GetTime();
+    EndDrawing();
+    idleTime += GetTime() - start;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include "../EngineInputs/InputFrame.h"
+
+// Why a frame had to be drawn, several can be set at once
+enum DirtyReason : uint32_t
+{
+    DIRTY_NONE = 0,
+    DIRTY_INPUT = 1 << 0,      // keys/buttons pressed or held, wheel
+    DIRTY_MOUSE_MOVE = 1 << 1, // only hover changes, the scene itself didn't change
+    DIRTY_CAMERA = 1 << 2,
+    DIRTY_ENTITY = 1 << 3,
+    DIRTY_ASSET_LOAD = 1 << 4,
+    DIRTY_ANIMATION = 1 << 5, // something wants to keep ticking (trace capture, text cursor)
+    DIRTY_WINDOW = 1 << 6,
+};
+
+constexpr int DIRTY_REASON_COUNT = 7;
+constexpr const char *DIRTY_REASON_NAMES[DIRTY_REASON_COUNT] = {"Input", "Mouse move", "Camera", "Entity", "Asset load", "Animation", "Window"};
+
+enum class FrameMode
+{
+    Adaptive, // 60 FPS while something happens, sleeps until the next event otherwise
+    Capped,   // always 60 FPS, the old behaviour
+    Uncapped, // as fast as possible, benchmarks and replays
+};
+
+// Decides whether the loop redraws the scene and whether it blocks waiting for events after presenting.
+// Idle, the editor sits in EndDrawing waiting on the OS instead of burning a core redrawing the same picture.
+class FrameScheduler
+{
+public:
+    static void SetMode(FrameMode mode);
+    static FrameMode GetMode() { return mode; }
+
+    static void BeginFrame();
+    static void MarkDirty(uint32_t reasons) { frameReasons |= reasons; }
+    static void MarkInput(const InputFrame &current, const InputFrame &previous);
+
+    // False when nothing that ends up in the scene texture changed, the last one can be reused then
+    static bool ShouldRenderScene();
+    static void NotifySceneRendered() { ++sceneRenders; }
+
+    // EndDrawing, plus picking between blocking on events or not for the next frame
+    static void Present();
+
+    static uint32_t GetFrameReasons() { return frameReasons; }
+    // How long the previous frame took, -1 if it slept waiting for events (that time says nothing about load)
+    static float GetLastFrameMs() { return lastFrameMs; }
+
+    // Stats over the last full second
+    static float GetFramesPerSecond() { return framesPerSecond; }
+    static float GetScenesPerSecond() { return scenesPerSecond; }
+    static float GetIdleRatio() { return idleRatio; }
+    static const int *GetReasonCounts() { return reasonCounts; }
+
+private:
+    static FrameMode mode;
+    static uint32_t frameReasons;
+    // Keeps drawing a few frames after the last change so ImGui hover/active states catch up
+    static int lingerFrames;
+    static bool waiting;
+    static double lastFrameStart;
+    static float lastFrameMs;
+
+    static double windowStart;
+    static double idleTime;
+    static int frames;
+    static int sceneRenders;
+    static int windowReasonCounts[DIRTY_REASON_COUNT];
+
+    static float framesPerSecond;
+    static float scenesPerSecond;
+    static float idleRatio;
+    static int reasonCounts[DIRTY_REASON_COUNT];
+};
@@ -0,0 +1,98 @@
+#include "FrameStatsUI.h"
+#include "FrameScheduler.h"
+#include "SceneViewport.h"
+#include "OcclusionCuller.h"
+#include "DrawList.h"
+#include "IdPicker.h"
+#include "ThumbnailCache.h"
+#include "../Jobs/JobSystem.h"
+#include "../../imgui/imgui.h"
+#include "../../imgui/rlImGui.h"
+
+void RenderFrameStatsUI(SceneViewport &sceneViewport, OcclusionCuller &occlusionCuller, const DrawList &drawList, IdPicker &idPicker)
+{
+    ImGui::Begin("Frame Stats");
+
+    static const char *MODE_NAMES[] = {"Adaptive", "Capped (60)", "Uncapped"};
+    int mode = static_cast<int>(FrameScheduler::GetMode());
+    if (ImGui::Combo("Mode", &mode, MODE_NAMES, IM_ARRAYSIZE(MODE_NAMES)))
+        FrameScheduler::SetMode(static_cast<FrameMode>(mode));
+
+    float fps = FrameScheduler::GetFramesPerSecond();
+    ImGui::Text("FPS: %.1f (%.2f ms)", fps, fps > 0.0f ? 1000.0f / fps : 0.0f);
+    ImGui::Text("Scene renders: %.1f/s", FrameScheduler::GetScenesPerSecond());
+    ImGui::Text("Idle: %.0f%%", FrameScheduler::GetIdleRatio() * 100.0f);
+
+    ImGui::SeparatorText("Dirty reasons");
+
+    // Highlighted = woke up this frame, the counts are per second
+    uint32_t reasons = FrameScheduler::GetFrameReasons();
+    const int *counts = FrameScheduler::GetReasonCounts();
+    for (int i = 0; i < DIRTY_REASON_COUNT; ++i)
+    {
+        bool active = (reasons & (1u << i)) != 0;
+        ImGui::TextColored(active ? ImVec4(1.0f, 0.8f, 0.3f, 1.0f) : ImGui::GetStyle().Colors[ImGuiCol_TextDisabled], "%-12s %3d/s", DIRTY_REASON_NAMES[i], counts[i]);
+    }
+
+    ImGui::SeparatorText("Scene resolution");
+
+    DynamicResolutionSettings &settings = sceneViewport.GetSettings();
+    Rectangle rect = sceneViewport.GetRect();
+    ImGui::Text("%d x %d (%.0f%% of %.0f x %.0f)", sceneViewport.GetTargetWidth(), sceneViewport.GetTargetHeight(),
+                sceneViewport.GetScale() * 100.0f, rect.width, rect.height);
+    ImGui::Checkbox("Dynamic resolution", &settings.enabled);
+    ImGui::SliderFloat("Frame budget (ms)", &settings.budgetMs, 8.0f, 50.0f, "%.1f");
+    ImGui::SliderFloat("Min scale", &settings.minScale, 0.25f, 1.0f, "%.2f");
+
+    ImGui::SeparatorText("Occlusion culling");
+
+    bool cullingEnabled = occlusionCuller.IsEnabled();
+    if (ImGui::Checkbox("Enabled", &cullingEnabled))
+    {
+        occlusionCuller.SetEnabled(cullingEnabled);
+        FrameScheduler::MarkDirty(DIRTY_ENTITY);
+    }
+
+    // Numbers are from the last scene render, they don't change while the editor is idle
+    const OcclusionStats &stats = occlusionCuller.GetStats();
+    ImGui::Text("Occluders: %d (%d triangles)", stats.occluders, stats.triangles);
+    ImGui::Text("Culled: %d of %d (%d outside the view)", stats.culled, stats.tested, stats.outsideFrustum);
+    ImGui::Text("Cull: %.2f ms, waited %.2f ms", stats.cullMs, stats.waitMs);
+
+    ImGui::SeparatorText("Draw list");
+
+    const DrawListStats &drawStats = drawList.GetStats();
+    ImGui::Text("Drawn: %d of %d (%d outside the view)", drawStats.drawn, drawStats.entities, drawStats.outsideFrustum);
+    ImGui::Text("Build: %.2f ms on %d threads", drawStats.buildMs, JobSystem::GetThreadCount());
+
+    ImGui::SeparatorText("UI");
+
+    // Stats are from the previous frame, this one isn't rendered yet
+    bool bufferedUi = rlImGuiIsBufferedRendering();
+    if (ImGui::Checkbox("Buffered UI rendering", &bufferedUi))
+        rlImGuiSetBufferedRendering(bufferedUi);
+    rlImGuiRenderStats uiStats = rlImGuiGetRenderStats();
+    ImGui::Text("%d vertices, %d indices, %d draw calls", uiStats.vertices, uiStats.indices, uiStats.drawCalls);
+    ImGui::Text("Render: %.2f ms, uploaded %.1f KB", uiStats.renderMs, uiStats.uploadBytes / 1024.0f);
+
+    ThumbnailStats thumbnails = ThumbnailCache::GetStats();
+    ImGui::Text("Thumbnails: %d stored, %d on the GPU, %d queued", thumbnails.stored, thumbnails.resident, thumbnails.queued);
+    ImGui::Text("Rendered %d this session, last took %.2f ms", thumbnails.rendered, thumbnails.lastRenderMs);
+
+    ImGui::SeparatorText("Picking");
+
+    static const char *PICKING_NAMES[] = {"Ray cast", "ID buffer"};
+    int pickingMode = static_cast<int>(idPicker.mode);
+    if (ImGui::Combo("Picking", &pickingMode, PICKING_NAMES, IM_ARRAYSIZE(PICKING_NAMES)))
+        idPicker.mode = static_cast<PickingMode>(pickingMode);
+
+    if (idPicker.mode == PickingMode::IdBuffer)
+    {
+        ImGui::Checkbox("Compare with ray cast", &idPicker.compareWithRayCast);
+        ImGui::Text("Draw: %.2f ms, read back: %.2f ms", idPicker.GetRequestMs(), idPicker.GetReadbackMs());
+        if (idPicker.compareWithRayCast)
+            ImGui::Text("Ray cast: %.2f ms, %d mismatches", idPicker.GetRayCastMs(), idPicker.GetMismatchCount());
+    }
+
+    ImGui::End();
+}
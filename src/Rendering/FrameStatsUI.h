@@ -0,0 +1,9 @@
+#pragma once
+
+class SceneViewport;
+class OcclusionCuller;
+class DrawList;
+class IdPicker;
+
+// Frame rate, how much of the time the editor sleeps and what woke it up, plus the scene view settings (resolution, culling, draw list, UI backend, picking)
+void RenderFrameStatsUI(SceneViewport &sceneViewport, OcclusionCuller &occlusionCuller, const DrawList &drawList, IdPicker &idPicker);
@@ -0,0 +1,201 @@
+#include "IdPicker.h"
+#include "ModelCache.h"
+#include "SceneViewport.h"
+#include <rlgl.h>
+#include <raymath.h>
+#include <chrono>
+#include "../LevelEditor/EntityView.h"
+#include "../LevelEditor/Picking.h"
+#include "../Logging/Logger.h"
+#include "../Profiling/Profiler.h"
+
+namespace
+{
+    // Batched shapes (cubes, spheres) carry the id as their vertex color, meshes get it through colDiffuse
+    // since their own vertex colors would get in the way
+    const char *ID_VERTEX_SHADER = R"(#version 330
+in vec3 vertexPosition;
+in vec4 vertexColor;
+uniform mat4 mvp;
+out vec4 fragColor;
+void main()
+{
+    fragColor = vertexColor;
+    gl_Position = mvp * vec4(vertexPosition, 1.0);
+})";
+
+    const char *ID_FRAGMENT_SHADER = R"(#version 330
+in vec4 fragColor;
+uniform vec4 colDiffuse;
+uniform int useVertexColor;
+out vec4 finalColor;
+void main()
+{
+    finalColor = useVertexColor != 0 ? fragColor : colDiffuse;
+})";
+
+    Color IdToColor(uint32_t id)
+    {
+        return {static_cast<unsigned char>(id & 0xFF), static_cast<unsigned char>((id >> 8) & 0xFF), static_cast<unsigned char>((id >> 16) & 0xFF), 255};
+    }
+
+    float MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void IdPicker::Load()
+{
+    target = LoadRenderTexture(1, 1);
+    shader = LoadShaderFromMemory(ID_VERTEX_SHADER, ID_FRAGMENT_SHADER);
+    useVertexColorLoc = GetShaderLocation(shader, "useVertexColor");
+
+    material = LoadMaterialDefault();
+    material.shader = shader;
+}
+
+void IdPicker::Unload()
+{
+    // Takes the shader with it
+    UnloadMaterial(material);
+    UnloadRenderTexture(target);
+    material = {0};
+    shader = {0};
+    target = {0};
+}
+
+void IdPicker::Request(const std::vector<GameEntity *> &entities, const Camera3D &camera, const SceneViewport &viewport, Vector2 mousePosition)
+{
+    PROFILE_SCOPE("IdPicker::Request");
+    auto start = std::chrono::steady_clock::now();
+
+    Rectangle rect = viewport.GetRect();
+    if (target.id == 0 || rect.width <= 0.0f || rect.height <= 0.0f)
+        return;
+
+    if (compareWithRayCast)
+    {
+        auto rayStart = std::chrono::steady_clock::now();
+        rayCastResult = Picking::PickEntity(entities, viewport.GetMouseRay(mousePosition, camera));
+        rayCastMs = MsSince(rayStart);
+    }
+
+    // Same projection as BeginMode3D, then zoomed in so the one screen pixel under the mouse fills the whole target
+    float centerX = (mousePosition.x - rect.x) / rect.width * 2.0f - 1.0f;
+    float centerY = 1.0f - (mousePosition.y - rect.y) / rect.height * 2.0f;
+    Matrix zoom = MatrixIdentity();
+    zoom.m0 = rect.width;
+    zoom.m5 = rect.height;
+    zoom.m12 = -centerX * rect.width;
+    zoom.m13 = -centerY * rect.height;
+
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, rect.width / rect.height, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    projection = MatrixMultiply(projection, zoom);
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+
+    // BeginMode3D by hand, it would build its own projection. EndMode3D undoes it the same way
+    rlDrawRenderBatchActive();
+    rlMatrixMode(RL_PROJECTION);
+    rlPushMatrix();
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(projection));
+    rlMatrixMode(RL_MODELVIEW);
+    rlLoadIdentity();
+    rlMultMatrixf(MatrixToFloat(view));
+    rlEnableDepthTest();
+
+    BeginShaderMode(shader);
+    int useVertexColor = 1;
+    SetShaderValue(shader, useVertexColorLoc, &useVertexColor, SHADER_UNIFORM_INT);
+
+    // Same transforms as Renderer::RenderComponents, otherwise this would pick something slightly different than what you see.
+    // Ids are the position in the entity list + 1, the views keep that around
+    auto pushTransform = [](const GameEntity *entity)
+    {
+        rlPushMatrix();
+        rlTranslatef(entity->EntityTransform.position.x, entity->EntityTransform.position.y, entity->EntityTransform.position.z);
+        rlMultMatrixf(MatrixToFloat(entity->EntityTransform.GetTransformMatrix()));
+    };
+
+    for (const auto &item : View<CubeComponent>(entities))
+    {
+        pushTransform(item.entity);
+        DrawCubeV(Vector3{0, 0, 0}, item.Get<CubeComponent>()->size, IdToColor(item.index + 1));
+        rlPopMatrix();
+    }
+    for (const auto &item : View<SphereComponent>(entities))
+    {
+        pushTransform(item.entity);
+        DrawSphere(Vector3{0, 0, 0}, item.Get<SphereComponent>()->radius, IdToColor(item.index + 1));
+        rlPopMatrix();
+    }
+    rlDrawRenderBatchActive();
+
+    // Meshes draw right away instead of going through the batch, so the uniform can switch in between
+    useVertexColor = 0;
+    SetShaderValue(shader, useVertexColorLoc, &useVertexColor, SHADER_UNIFORM_INT);
+    for (const auto &item : View<ModelComponent>(entities))
+    {
+        GameEntity *entity = item.entity;
+        ModelComponent *model = item.Get<ModelComponent>();
+        if (!ModelCache::Resolve(model))
+            continue;
+
+        const Vector3 &position = entity->EntityTransform.position;
+        Matrix world = MatrixMultiply(entity->EntityTransform.GetTransformMatrix(), MatrixTranslate(position.x, position.y, position.z));
+        world = MatrixMultiply(model->model->transform, world);
+
+        material.maps[MATERIAL_MAP_DIFFUSE].color = IdToColor(item.index + 1);
+        for (int mesh = 0; mesh < model->model->meshCount; ++mesh)
+            DrawMesh(model->model->meshes[mesh], material, world);
+    }
+
+    EndShaderMode();
+    EndMode3D();
+    EndTextureMode();
+
+    requestVersion = GameEntity::GetStructureVersion();
+    requestSource = entities.data();
+    requestCount = entities.size();
+    pending = true;
+    requestMs = MsSince(start);
+}
+
+bool IdPicker::Poll(const std::vector<GameEntity *> &entities, GameEntity **picked)
+{
+    if (!pending)
+        return false;
+    pending = false;
+
+    PROFILE_SCOPE("IdPicker::Readback");
+    auto start = std::chrono::steady_clock::now();
+
+    uint32_t id = 0;
+    Image image = LoadImageFromTexture(target.texture);
+    if (image.data)
+    {
+        const unsigned char *pixel = static_cast<const unsigned char *>(image.data);
+        id = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+    }
+    UnloadImage(image);
+    readbackMs = MsSince(start);
+
+    // Something could have been deleted since the click, a new entity can even sit at the old one's address then
+    bool unchanged = GameEntity::GetStructureVersion() == requestVersion && entities.data() == requestSource && entities.size() == requestCount;
+    *picked = nullptr;
+    if (unchanged && id > 0 && id <= entities.size())
+        *picked = entities[id - 1];
+
+    if (compareWithRayCast && *picked != rayCastResult)
+    {
+        ++mismatches;
+        DebugWarn("Ray cast picked", rayCastResult ? std::string(rayCastResult->GetName()) : std::string("nothing"), "but the id buffer has",
+                  *picked ? std::string((*picked)->GetName()) : std::string("nothing"));
+    }
+
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <raylib.h>
+#include <vector>
+#include "../LevelEditor/gameEntity.h"
+
+class SceneViewport;
+
+enum class PickingMode
+{
+    RayCast,
+    IdBuffer,
+};
+
+// Picking by drawing entity ids (index + 1 as the RGB color) into a 1x1 target that only sees the pixel under the
+// mouse, so it picks exactly what is drawn, rotated cubes, squashed spheres and every mesh of a model included.
+// The read back happens the frame after the click, by then the GPU is done with it and the read doesn't stall.
+class IdPicker
+{
+public:
+    // Needs the GL context, after InitWindow / before CloseWindow
+    void Load();
+    void Unload();
+
+    // Draws the ids for the pixel under the mouse, the result comes out of Poll next frame
+    void Request(const std::vector<GameEntity *> &entities, const Camera3D &camera, const SceneViewport &viewport, Vector2 mousePosition);
+
+    // Once a frame before handling clicks. True when a request got resolved, picked is nullptr for empty space
+    // (or when entities got added/deleted in the meantime, the ids don't line up anymore then)
+    bool Poll(const std::vector<GameEntity *> &entities, GameEntity **picked);
+
+    PickingMode mode = PickingMode::RayCast;
+    // Also ray casts every click and warns when the two disagree, for checking the ray tests against what's drawn
+    bool compareWithRayCast = false;
+
+    float GetRequestMs() const { return requestMs; }
+    float GetReadbackMs() const { return readbackMs; }
+    float GetRayCastMs() const { return rayCastMs; }
+    int GetMismatchCount() const { return mismatches; }
+
+private:
+    RenderTexture2D target = {0};
+    Shader shader = {0};
+    Material material = {0};
+    int useVertexColorLoc = -1;
+
+    bool pending = false;
+    // Ids are indices into the list as it was when drawn, only used when it still looks the same
+    // (see GameEntity::GetStructureVersion)
+    uint32_t requestVersion = 0;
+    GameEntity *const *requestSource = nullptr;
+    size_t requestCount = 0;
+    GameEntity *rayCastResult = nullptr;
+
+    float requestMs = 0.0f;
+    float readbackMs = 0.0f;
+    float rayCastMs = 0.0f;
+    int mismatches = 0;
+};
@@ -0,0 +1,100 @@
+#include "ModelCache.h"
+#include "FrameScheduler.h"
+#include <cstring>
+#include <fstream>
+#include "../Logging/Logger.h"
+#include "../Profiling/Profiler.h"
+#include "../SaveLevel/AssetPrefetch.h"
+
+std::unordered_map<std::string, Model> ModelCache::models;
+
+namespace
+{
+    // raylib reads model files (and the buffers/textures they point at) through LoadFileData, this hands it the bytes
+    // LoadLevel already read when there are any and goes to the disk like raylib would otherwise
+    unsigned char *LoadPrefetchedFile(const char *fileName, int *dataSize)
+    {
+        *dataSize = 0;
+        std::vector<unsigned char> bytes;
+        if (!AssetPrefetch::Take(fileName, bytes))
+        {
+            std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                return nullptr;
+
+            bytes.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char *>(bytes.data()), bytes.size()))
+                return nullptr;
+        }
+
+        // Freed by raylib with UnloadFileData, so it has to come from its allocator
+        unsigned char *data = static_cast<unsigned char *>(MemAlloc(static_cast<unsigned int>(bytes.size())));
+        if (data && !bytes.empty())
+            std::memcpy(data, bytes.data(), bytes.size());
+        *dataSize = static_cast<int>(bytes.size());
+        return data;
+    }
+}
+
+const Model *ModelCache::Get(const std::string &path)
+{
+    auto it = models.find(path);
+    if (it == models.end())
+    {
+        PROFILE_SCOPE("ModelCache::Load");
+        DebugPrint("Loading model:", path);
+
+        // Only for this load, everything else raylib reads keeps going through its own loader
+        SetLoadFileDataCallback(LoadPrefetchedFile);
+        Model model = LoadModel(path.c_str());
+        SetLoadFileDataCallback(nullptr);
+        if (!IsModelValid(model) || model.meshCount == 0)
+        {
+            DebugError("Could not load model:", path);
+            if (IsModelValid(model))
+                UnloadModel(model);
+            // Remember the failure, a missing file shouldn't hit the disk every frame
+            model = {0};
+        }
+
+        it = models.emplace(path, model).first;
+        FrameScheduler::MarkDirty(DIRTY_ASSET_LOAD);
+    }
+
+    return it->second.meshCount > 0 ? &it->second : nullptr;
+}
+
+bool ModelCache::Resolve(ModelComponent *model)
+{
+    if (!model->model && model->HasFilePath())
+    {
+        model->model = Get(std::string(model->GetFilePath()));
+        if (model->model)
+            model->bounds = GetModelBoundingBox(*model->model);
+    }
+
+    return model->IsLoaded();
+}
+
+void ModelCache::ResolveAll(const std::vector<GameEntity *> &entities)
+{
+    PROFILE_SCOPE("ModelCache::ResolveAll");
+    for (auto entity : entities)
+    {
+        if (auto model = entity->GetComponent<ModelComponent>())
+            Resolve(model);
+    }
+    AssetPrefetch::Clear();
+}
+
+void ModelCache::UnloadAll()
+{
+    for (auto &pair : models)
+    {
+        if (pair.second.meshCount > 0)
+            UnloadModel(pair.second);
+    }
+    models.clear();
+    AssetPrefetch::Clear();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <raylib.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../LevelEditor/gameEntity.h"
+
+// Owns every GPU model, one per file path, so entities using the same file share it.
+// ModelComponents only keep a pointer into here, which is why they can exist without a GL context.
+class ModelCache
+{
+public:
+    // Loads on first use, nullptr if the file can't be loaded (and it won't retry that path every frame)
+    static const Model *Get(const std::string &path);
+
+    // Fills in model->model from its filePath if that didn't happen yet, returns whether it has a usable model
+    static bool Resolve(ModelComponent *model);
+
+    // Resolve for every model in the list, the upload step right after LoadLevel so the first frame doesn't stall on it.
+    // Drops whatever AssetPrefetch still holds afterwards
+    static void ResolveAll(const std::vector<GameEntity *> &entities);
+
+    static void UnloadAll();
+
+private:
+    static std::unordered_map<std::string, Model> models;
+};
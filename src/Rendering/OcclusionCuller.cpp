@@ -0,0 +1,259 @@
+#include "OcclusionCuller.h"
+#include <raymath.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include "../Jobs/JobSystem.h"
+#include "../LevelEditor/Collision.h"
+#include "../LevelEditor/EntityView.h"
+#include "../Profiling/Profiler.h"
+
+namespace
+{
+    // Same order the renderer applies them in: scale, rotation, then the rlTranslatef
+    Matrix GetWorldMatrix(const GameEntity *entity)
+    {
+        const Vector3 &position = entity->EntityTransform.position;
+        return MatrixMultiply(entity->EntityTransform.GetTransformMatrix(), MatrixTranslate(position.x, position.y, position.z));
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+OcclusionCuller::OcclusionCuller()
+{
+    worker = std::thread(&OcclusionCuller::WorkerLoop, this);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+Matrix OcclusionCuller::GetViewProjection(const Camera3D &camera, float aspect)
+{
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, DepthRasterizer::NEAR_W, CAMERA_FAR);
+    return MatrixMultiply(view, projection);
+}
+
+void OcclusionCuller::BuildSnapshot(const std::vector<GameEntity *> &entities, const Matrix &viewProjection, OcclusionSnapshot &snapshot)
+{
+    PROFILE_SCOPE("OcclusionCuller::BuildSnapshot");
+
+    snapshot.viewProjection = viewProjection;
+    snapshot.boxOccluders.clear();
+    snapshot.meshOccluders.clear();
+    snapshot.bounds.resize(entities.size());
+    // Entities without anything drawable (or a model that didn't load yet) keep these at 0
+    snapshot.hasBounds.assign(entities.size(), 0);
+    snapshot.occluderFlags.assign(entities.size(), 0);
+    snapshot.structureVersion = GameEntity::GetStructureVersion();
+    snapshot.source = entities.data();
+    snapshot.entityCount = entities.size();
+
+    // Bounds in parallel, one view per shape so there's no failed lookups. Occluders only get marked here since the
+    // lists have to stay in entity order
+    const auto &cubes = View<CubeComponent>(entities);
+    const auto &spheres = View<SphereComponent>(entities);
+    const auto &models = View<ModelComponent>(entities);
+
+    auto cubeBounds = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const CubeComponent *cube = cubes[i].Get<CubeComponent>();
+            uint32_t index = cubes[i].index;
+            snapshot.bounds[index] = cube->GetOrientedBox();
+            snapshot.hasBounds[index] = 1;
+            snapshot.occluderFlags[index] = cube->occluder;
+        }
+    };
+    auto sphereBounds = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            float radius = spheres[i].Get<SphereComponent>()->radius;
+            uint32_t index = spheres[i].index;
+            snapshot.bounds[index] = OrientedBox::FromTransform({{-radius, -radius, -radius}, {radius, radius, radius}}, GetWorldMatrix(spheres[i].entity));
+            snapshot.hasBounds[index] = 1;
+        }
+    };
+    auto modelBounds = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const ModelComponent *model = models[i].Get<ModelComponent>();
+            if (!model->IsLoaded())
+                continue;
+
+            uint32_t index = models[i].index;
+            snapshot.bounds[index] = OrientedBox::FromTransform(model->bounds, GetWorldMatrix(models[i].entity));
+            snapshot.hasBounds[index] = 1;
+            snapshot.occluderFlags[index] = model->occluder;
+        }
+    };
+    JobSystem::ParallelFor(cubes.size(), BOUNDS_GRAIN, cubeBounds);
+    JobSystem::ParallelFor(spheres.size(), BOUNDS_GRAIN, sphereBounds);
+    JobSystem::ParallelFor(models.size(), BOUNDS_GRAIN, modelBounds);
+
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        if (!snapshot.occluderFlags[i])
+            continue;
+
+        GameEntity *entity = entities[i];
+        Matrix world = GetWorldMatrix(entity);
+        if (auto cube = entity->GetComponent<CubeComponent>())
+        {
+            snapshot.boxOccluders.push_back(MatrixMultiply(MatrixScale(cube->size.x, cube->size.y, cube->size.z), world));
+        }
+        else if (auto model = entity->GetComponent<ModelComponent>())
+        {
+            int triangles = 0;
+            for (int mesh = 0; mesh < model->model->meshCount; ++mesh)
+                triangles += model->model->meshes[mesh].triangleCount;
+            if (triangles <= MAX_MODEL_OCCLUDER_TRIANGLES)
+                snapshot.meshOccluders.push_back({model->model, MatrixMultiply(model->model->transform, world)});
+        }
+    }
+}
+
+void OcclusionCuller::Cull(const OcclusionSnapshot &snapshot, DepthRasterizer &rasterizer, std::vector<uint8_t> &visible, OcclusionStats &stats)
+{
+    PROFILE_SCOPE("OcclusionCuller::Cull");
+    auto start = std::chrono::steady_clock::now();
+
+    rasterizer.Begin(snapshot.viewProjection);
+    {
+        PROFILE_SCOPE("Rasterize Occluders");
+        for (const Matrix &box : snapshot.boxOccluders)
+            rasterizer.RasterizeBox(box);
+        for (const OcclusionMeshOccluder &occluder : snapshot.meshOccluders)
+        {
+            for (int mesh = 0; mesh < occluder.model->meshCount; ++mesh)
+                rasterizer.RasterizeMesh(occluder.model->meshes[mesh], occluder.transform);
+        }
+        rasterizer.BuildHierarchy();
+    }
+
+    stats.occluders = static_cast<int>(snapshot.boxOccluders.size() + snapshot.meshOccluders.size());
+    stats.triangles = rasterizer.GetTriangleCount();
+    std::atomic<int> tested{0};
+    std::atomic<int> culled{0};
+    std::atomic<int> outsideFrustum{0};
+
+    {
+        PROFILE_SCOPE("Test Bounds");
+        Frustum frustum = Frustum::FromMatrix(snapshot.viewProjection);
+        visible.assign(snapshot.bounds.size(), 1);
+
+        // The hierarchy is only read from here on, so the tests can go wide
+        auto testBounds = [&](size_t begin, size_t end)
+        {
+            int chunkTested = 0, chunkCulled = 0, chunkOutside = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!snapshot.hasBounds[i])
+                    continue;
+
+                ++chunkTested;
+                // Planes first, way cheaper than projecting the 8 corners
+                if (!Collision::FrustumOrientedBox(frustum, snapshot.bounds[i]))
+                {
+                    visible[i] = 0;
+                    ++chunkCulled;
+                    ++chunkOutside;
+                }
+                else if (!rasterizer.IsVisible(snapshot.bounds[i]))
+                {
+                    visible[i] = 0;
+                    ++chunkCulled;
+                }
+            }
+            tested += chunkTested;
+            culled += chunkCulled;
+            outsideFrustum += chunkOutside;
+        };
+        JobSystem::ParallelFor(snapshot.bounds.size(), BOUNDS_GRAIN, testBounds);
+    }
+
+    stats.tested = tested.load();
+    stats.culled = culled.load();
+    stats.outsideFrustum = outsideFrustum.load();
+
+    stats.cullMs = MsSince(start);
+}
+
+void OcclusionCuller::Kick(const std::vector<GameEntity *> &entities, const Camera3D &camera, float aspect)
+{
+    // Orthographic cameras have the same w everywhere, 1/w depth can't tell anything apart there
+    if (!enabled || camera.projection != CAMERA_PERSPECTIVE || aspect <= 0.0f)
+        return;
+
+    // Previous cull never got collected, it has to be done before its snapshot gets overwritten
+    if (kicked)
+        Wait(entities);
+
+    BuildSnapshot(entities, GetViewProjection(camera, aspect), snapshot);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = true;
+    }
+    kicked = true;
+    wake.notify_one();
+}
+
+const std::vector<uint8_t> *OcclusionCuller::Wait(const std::vector<GameEntity *> &entities)
+{
+    if (!kicked)
+        return nullptr;
+    kicked = false;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("OcclusionCuller::Wait");
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]()
+                      { return !pending; });
+    }
+    lastStats = stats;
+    lastStats.waitMs = MsSince(start);
+
+    // UI ran in between, if it added or deleted something the flags don't line up with the entities anymore
+    if (!enabled || GameEntity::GetStructureVersion() != snapshot.structureVersion || entities.data() != snapshot.source ||
+        entities.size() != snapshot.entityCount)
+        return nullptr;
+
+    return &visible;
+}
+
+void OcclusionCuller::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]()
+                  { return pending || quit; });
+        if (quit)
+            return;
+
+        // Main thread doesn't touch the snapshot or the results until pending goes back to false
+        lock.unlock();
+        Cull(snapshot, rasterizer, visible, stats);
+        lock.lock();
+
+        pending = false;
+        finished.notify_one();
+    }
+}
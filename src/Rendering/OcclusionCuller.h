@@ -0,0 +1,98 @@
+#pragma once
+
+#include <raylib.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DepthRasterizer.h"
+#include "../LevelEditor/gameEntity.h"
+
+struct OcclusionMeshOccluder
+{
+    const Model *model;
+    Matrix transform;
+};
+
+// Everything a cull needs, copied out of the entities on the main thread so the worker never touches them
+struct OcclusionSnapshot
+{
+    Matrix viewProjection;
+    std::vector<Matrix> boxOccluders;
+    std::vector<OcclusionMeshOccluder> meshOccluders;
+    // World bounds per entity in entity order, the ones without bounds (models that didn't load yet) always get drawn
+    std::vector<OrientedBox> bounds;
+    std::vector<uint8_t> hasBounds;
+    // Set for the entities that go into boxOccluders/meshOccluders
+    std::vector<uint8_t> occluderFlags;
+    // What the entity list looked like (see GameEntity::GetStructureVersion), Wait only hands out the flags when it
+    // still looks the same. Cheaper than comparing every pointer, and catches a deleted entity whose address got reused
+    uint32_t structureVersion = 0;
+    GameEntity *const *source = nullptr;
+    size_t entityCount = 0;
+};
+
+struct OcclusionStats
+{
+    int occluders = 0;
+    int triangles = 0;
+    int tested = 0;
+    int culled = 0;
+    // Part of culled, the ones the frustum test already threw out before the depth test
+    int outsideFrustum = 0;
+    double cullMs = 0.0;
+    // How long the main thread sat in Wait, ideally ~0 since ImGui submission runs in between
+    double waitMs = 0.0;
+};
+
+// Software occlusion culling for the scene view. Kick copies the entities and camera into a snapshot and a worker
+// rasterizes the flagged occluders and tests every entity's bounds while the main thread builds the ImGui frame,
+// Wait then hands the renderer one visible flag per entity. Snapshot bounds and the tests are split over the JobSystem.
+class OcclusionCuller
+{
+public:
+    // Same as rlgl's RL_CULL_DISTANCE_FAR, BeginMode3D builds its projection with it
+    static constexpr float CAMERA_FAR = 1000.0f;
+    // Models with more triangles than this are still culled but don't occlude, rasterizing them would cost more than it saves
+    static constexpr int MAX_MODEL_OCCLUDER_TRIANGLES = 4096;
+    // Entities per job for the bounds and the tests
+    static constexpr size_t BOUNDS_GRAIN = 2048;
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    static Matrix GetViewProjection(const Camera3D &camera, float aspect);
+    static void BuildSnapshot(const std::vector<GameEntity *> &entities, const Matrix &viewProjection, OcclusionSnapshot &snapshot);
+    // What the worker does with a snapshot, runs right on the calling thread (the benchmark times this)
+    static void Cull(const OcclusionSnapshot &snapshot, DepthRasterizer &rasterizer, std::vector<uint8_t> &visible, OcclusionStats &stats);
+
+    // Snapshot the scene and start culling it on the worker, returns straight away
+    void Kick(const std::vector<GameEntity *> &entities, const Camera3D &camera, float aspect);
+    // Blocks until the kicked cull is done. One flag per entity, or nullptr when everything should be drawn
+    // (culling is off, nothing was kicked, or entities got added/removed since Kick)
+    const std::vector<uint8_t> *Wait(const std::vector<GameEntity *> &entities);
+
+    bool IsEnabled() const { return enabled; }
+    void SetEnabled(bool enable) { enabled = enable; }
+    // From the last finished cull, safe to read while the worker is busy
+    const OcclusionStats &GetStats() const { return lastStats; }
+
+private:
+    void WorkerLoop();
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    bool pending = false;
+    bool quit = false;
+    bool kicked = false;
+    bool enabled = true;
+
+    OcclusionSnapshot snapshot;
+    DepthRasterizer rasterizer;
+    std::vector<uint8_t> visible;
+    OcclusionStats stats;
+    OcclusionStats lastStats;
+};
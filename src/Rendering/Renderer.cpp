@@ -1,35 +1,35 @@
 #include "Renderer.h"
+#include "ModelCache.h"
 #include <rlgl.h>
 #include <raymath.h>
+#include "../Profiling/Profiler.h"
 
-void Renderer::RenderComponents(const std::vector<GameEntity *> &entities, GameEntity *selectedEntity)
+void Renderer::RenderComponents(const DrawList &drawList)
 {
-    for (auto entity : entities)
+    PROFILE_SCOPE("Renderer::RenderComponents");
+    for (const DrawItem &item : drawList.GetItems())
     {
         rlPushMatrix();
-        rlTranslatef(entity->EntityTransform.position.x, entity->EntityTransform.position.y, entity->EntityTransform.position.z);
+        rlMultMatrixf(MatrixToFloat(drawList.GetWorldMatrix(item.index)));
 
-        Matrix transformMatrix = entity->EntityTransform.GetTransformMatrix();
-        rlMultMatrixf(MatrixToFloat(transformMatrix));
-
-        if (auto cube = entity->GetComponent<CubeComponent>())
+        if (item.shape == DrawShape::Cube)
         {
+            auto cube = static_cast<const CubeComponent *>(item.component);
             DrawCubeV(Vector3{0, 0, 0}, cube->size, cube->color);
-            if (entity == selectedEntity)
+            if (item.selected)
                 DrawCubeWiresV(Vector3{0, 0, 0}, Vector3{cube->size.x + 0.02f, cube->size.y + 0.02f, cube->size.z + 0.02f}, BLACK);
         }
-        else if (auto sphere = entity->GetComponent<SphereComponent>())
+        else if (item.shape == DrawShape::Sphere)
         {
+            auto sphere = static_cast<const SphereComponent *>(item.component);
             DrawSphere(Vector3{0, 0, 0}, sphere->radius, sphere->color);
-            if (entity == selectedEntity)
+            if (item.selected)
                 DrawSphereWires(Vector3{0, 0, 0}, sphere->radius + 0.01f, 16, 16, BLACK);
         }
-        else if (auto model = entity->GetComponent<ModelComponent>())
+        else if (ModelCache::Resolve(static_cast<ModelComponent *>(item.component)))
         {
-            if (model->IsLoaded())
-            {
-                DrawModel(model->model, Vector3{0, 0, 0}, 1.0f, WHITE);
-            }
+            auto model = static_cast<const ModelComponent *>(item.component);
+            DrawModel(*model->model, Vector3{0, 0, 0}, 1.0f, WHITE);
         }
 
         rlPopMatrix();
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <raylib.h>
-#include <vector>
-#include "../LevelEditor/gameEntity.h"
+#include "DrawList.h"
 
 class Renderer
 {
 public:
-    static void RenderComponents(const std::vector<GameEntity *> &entities, GameEntity *selectedEntity);
+    // Everything in there is already transformed and culled (see DrawList::Build), this only pushes it to GL
+    static void RenderComponents(const DrawList &drawList);
 };
@@ -0,0 +1,148 @@
+#include "SceneViewport.h"
+#include <algorithm>
+#include <cmath>
+#include <rlgl.h>
+
+namespace
+{
+    constexpr int OVER_BUDGET_FRAMES = 15;
+    constexpr int MIN_SCALE_UP_DELAY = 120;
+    constexpr int MAX_SCALE_UP_DELAY = 1920;
+
+    // Link incase I forget how it works
+    // https://www.raylib.com/examples/shaders/loader.html?name=shaders_write_depth
+    RenderTexture2D LoadRenderTextureDepthTex(int width, int height)
+    {
+        RenderTexture2D target = {0};
+        target.id = rlLoadFramebuffer();
+        if (target.id > 0)
+        {
+            rlEnableFramebuffer(target.id);
+
+            target.texture.id = rlLoadTexture(0, width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+            target.texture.width = width;
+            target.texture.height = height;
+            target.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+            target.texture.mipmaps = 1;
+
+            target.depth.id = rlLoadTextureDepth(width, height, false);
+            target.depth.width = width;
+            target.depth.height = height;
+            target.depth.format = 19;
+            target.depth.mipmaps = 1;
+
+            rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
+            rlFramebufferAttach(target.id, target.depth.id, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
+
+            if (rlFramebufferComplete(target.id))
+                TRACELOG(LOG_INFO, "FBO: [ID %i] Framebuffer object created successfully", target.id);
+
+            rlDisableFramebuffer();
+        }
+        else
+            TRACELOG(LOG_WARNING, "FBO: Framebuffer object can not be created");
+
+        return target;
+    }
+
+    void UnloadRenderTextureDepthTex(RenderTexture2D target)
+    {
+        if (target.id > 0)
+        {
+            rlUnloadTexture(target.texture.id);
+            rlUnloadTexture(target.depth.id);
+            rlUnloadFramebuffer(target.id);
+        }
+    }
+}
+
+void SceneViewport::SetRect(Rectangle screenRect)
+{
+    rect = screenRect;
+}
+
+bool SceneViewport::UpdateResolution(float frameMs)
+{
+    if (settings.enabled && frameMs >= 0.0f)
+    {
+        averageMs = averageMs == 0.0f ? frameMs : averageMs * 0.9f + frameMs * 0.1f;
+
+        if (averageMs > settings.budgetMs)
+        {
+            underBudgetFrames = 0;
+            if (++overBudgetFrames >= OVER_BUDGET_FRAMES && scale > settings.minScale)
+            {
+                // Went up to this scale not long ago and it didn't hold, wait longer before trying again
+                if (scale >= lastFailedScale - 0.001f)
+                    scaleUpDelay = std::min(scaleUpDelay * 2, MAX_SCALE_UP_DELAY);
+                lastFailedScale = scale;
+
+                scale = std::max(settings.minScale, scale - settings.step);
+                overBudgetFrames = 0;
+                averageMs = 0.0f;
+            }
+        }
+        else
+        {
+            overBudgetFrames = 0;
+            if (averageMs < settings.budgetMs * 0.95f && ++underBudgetFrames >= scaleUpDelay && scale < 1.0f)
+            {
+                scale = std::min(1.0f, scale + settings.step);
+                underBudgetFrames = 0;
+                averageMs = 0.0f;
+            }
+        }
+    }
+    else if (!settings.enabled)
+    {
+        scale = 1.0f;
+        scaleUpDelay = MIN_SCALE_UP_DELAY;
+        lastFailedScale = 2.0f;
+    }
+
+    scale = std::clamp(scale, settings.minScale, 1.0f);
+
+    int width = std::max(1, static_cast<int>(std::lround(rect.width * scale)));
+    int height = std::max(1, static_cast<int>(std::lround(rect.height * scale)));
+    if (target.id != 0 && width == target.texture.width && height == target.texture.height)
+        return false;
+
+    Recreate(width, height);
+    return true;
+}
+
+void SceneViewport::Recreate(int width, int height)
+{
+    UnloadRenderTextureDepthTex(target);
+    target = LoadRenderTextureDepthTex(width, height);
+    // Only matters below 100%, at full size it's a 1:1 copy
+    SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
+}
+
+void SceneViewport::BeginScene()
+{
+    BeginTextureMode(target);
+}
+
+void SceneViewport::EndScene()
+{
+    EndTextureMode();
+}
+
+void SceneViewport::Draw() const
+{
+    Rectangle source = {0, 0, static_cast<float>(target.texture.width), static_cast<float>(-target.texture.height)}; // Flip Y
+    DrawTexturePro(target.texture, source, rect, Vector2{0, 0}, 0.0f, WHITE);
+}
+
+Ray SceneViewport::GetMouseRay(Vector2 mousePosition, Camera camera) const
+{
+    Vector2 local = {mousePosition.x - rect.x, mousePosition.y - rect.y};
+    return GetScreenToWorldRayEx(local, camera, std::max(1, static_cast<int>(rect.width)), std::max(1, static_cast<int>(rect.height)));
+}
+
+void SceneViewport::Unload()
+{
+    UnloadRenderTextureDepthTex(target);
+    target = {0};
+}
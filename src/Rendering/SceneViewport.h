@@ -0,0 +1,57 @@
+#pragma once
+
+#include <raylib.h>
+
+// Settings for dropping the scene's internal resolution when frames get too slow
+struct DynamicResolutionSettings
+{
+    bool enabled = true;
+    float budgetMs = 20.0f;
+    float minScale = 0.5f;
+    float step = 0.1f;
+};
+
+// The render target the 3D scene goes into. Follows the size of the area it's shown in (the middle of the dockspace)
+// and renders at a fraction of it when the editor can't keep up, the blit back up is bilinear.
+class SceneViewport
+{
+public:
+    // Screen space area the scene covers, takes effect at the next UpdateResolution
+    void SetRect(Rectangle screenRect);
+    Rectangle GetRect() const { return rect; }
+
+    // Once per frame before rendering. frameMs < 0 means the last frame doesn't count (it slept waiting for input).
+    // True when the target got recreated, its contents are gone so the scene has to be drawn again
+    bool UpdateResolution(float frameMs);
+
+    void BeginScene();
+    void EndScene();
+    // Upscales the target into the screen rect
+    void Draw() const;
+
+    // Mouse position in window pixels -> world ray through the viewport
+    Ray GetMouseRay(Vector2 mousePosition, Camera camera) const;
+
+    DynamicResolutionSettings &GetSettings() { return settings; }
+    float GetScale() const { return scale; }
+    int GetTargetWidth() const { return target.texture.width; }
+    int GetTargetHeight() const { return target.texture.height; }
+
+    // Before CloseWindow, needs the GL context
+    void Unload();
+
+private:
+    void Recreate(int width, int height);
+
+    RenderTexture2D target = {0};
+    Rectangle rect = {0, 0, 0, 0};
+    DynamicResolutionSettings settings;
+
+    float scale = 1.0f;
+    float averageMs = 0.0f;
+    int overBudgetFrames = 0;
+    int underBudgetFrames = 0;
+    // Frames under budget needed before trying a higher scale, doubles every time going up didn't hold
+    int scaleUpDelay = 120;
+    float lastFailedScale = 2.0f;
+};
@@ -0,0 +1,498 @@
+#include "ThumbnailCache.h"
+#include "FrameScheduler.h"
+#include <raymath.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "../../imgui/imgui.h"
+#include "../../imgui/rlImGui.h"
+#include "../Logging/Logger.h"
+#include "../Profiling/Profiler.h"
+
+std::fstream ThumbnailCache::atlasFile;
+uint32_t ThumbnailCache::atlasRecords = 0;
+std::unordered_map<uint64_t, uint32_t> ThumbnailCache::atlasSlots;
+std::unordered_map<std::string, ThumbnailCache::Entry> ThumbnailCache::entries;
+std::vector<std::string> ThumbnailCache::renderQueue;
+
+Texture2D ThumbnailCache::page = {0};
+std::vector<uint64_t> ThumbnailCache::cellHashes;
+std::vector<uint64_t> ThumbnailCache::cellFrames;
+std::unordered_map<uint64_t, int> ThumbnailCache::residentCells;
+int ThumbnailCache::uploadsThisFrame = 0;
+
+RenderTexture2D ThumbnailCache::target = {0};
+std::string ThumbnailCache::pendingReadback;
+uint64_t ThumbnailCache::frame = 1;
+ThumbnailStats ThumbnailCache::stats;
+
+std::thread ThumbnailCache::worker;
+std::mutex ThumbnailCache::mutex;
+std::condition_variable ThumbnailCache::wake;
+bool ThumbnailCache::quit = false;
+std::vector<std::string> ThumbnailCache::hashQueue;
+std::vector<ThumbnailCache::HashResult> ThumbnailCache::hashResults;
+
+namespace
+{
+    // Atlas file: magic, version, thumbnail size, then one record after another (content hash + RGBA pixels).
+    // Only ever appended to, a record cut short by a crash just gets written over by the next one
+    constexpr char ATLAS_MAGIC[4] = {'T', 'H', 'M', 'B'};
+    constexpr uint32_t ATLAS_VERSION = 1;
+    constexpr size_t ATLAS_HEADER_BYTES = sizeof(ATLAS_MAGIC) + 2 * sizeof(uint32_t);
+    constexpr size_t PIXEL_BYTES = ThumbnailCache::THUMBNAIL_SIZE * ThumbnailCache::THUMBNAIL_SIZE * 4;
+    constexpr size_t RECORD_BYTES = sizeof(uint64_t) + PIXEL_BYTES;
+
+    // Requests older than this many frames are off screen, they leave the queues
+    constexpr uint64_t STALE_FRAMES = 3;
+    // Rendered at twice the size and scaled down, cheap anti aliasing
+    constexpr int RENDER_SIZE = ThumbnailCache::THUMBNAIL_SIZE * 2;
+
+    uint64_t HashBytes(const std::vector<unsigned char> &bytes)
+    {
+        // FNV-1a, plenty to tell model files apart
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char byte : bytes)
+        {
+            hash ^= byte;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    bool ReadFile(const char *path, std::vector<unsigned char> &bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            return false;
+
+        bytes.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        return bytes.empty() || static_cast<bool>(file.read(reinterpret_cast<char *>(bytes.data()), bytes.size()));
+    }
+
+    // The model being rendered, its bytes were already read for the hash
+    const std::string *renderPath = nullptr;
+    const std::vector<unsigned char> *renderBytes = nullptr;
+
+    // Same idea as ModelCache's loader, only the model file itself comes from memory, whatever it points at
+    // (.mtl, .bin, textures) from the disk
+    unsigned char *LoadRenderFile(const char *fileName, int *dataSize)
+    {
+        *dataSize = 0;
+        std::vector<unsigned char> bytes;
+        const std::vector<unsigned char> *source = &bytes;
+        if (renderPath && *renderPath == fileName)
+            source = renderBytes;
+        else if (!ReadFile(fileName, bytes))
+            return nullptr;
+
+        // Freed by raylib with UnloadFileData, so it has to come from its allocator
+        unsigned char *data = static_cast<unsigned char *>(MemAlloc(static_cast<unsigned int>(source->size())));
+        if (data && !source->empty())
+            std::memcpy(data, source->data(), source->size());
+        *dataSize = static_cast<int>(source->size());
+        return data;
+    }
+}
+
+void ThumbnailCache::Load(const std::string &atlasPath)
+{
+    bool valid = false;
+    atlasFile.open(atlasPath, std::ios::in | std::ios::out | std::ios::binary);
+    if (atlasFile.is_open())
+    {
+        char magic[4] = {};
+        uint32_t version = 0, size = 0;
+        atlasFile.read(magic, sizeof(magic));
+        atlasFile.read(reinterpret_cast<char *>(&version), sizeof(version));
+        atlasFile.read(reinterpret_cast<char *>(&size), sizeof(size));
+        valid = atlasFile && std::memcmp(magic, ATLAS_MAGIC, sizeof(magic)) == 0 && version == ATLAS_VERSION && size == THUMBNAIL_SIZE;
+    }
+
+    if (valid)
+    {
+        atlasFile.seekg(0, std::ios::end);
+        size_t fileSize = static_cast<size_t>(atlasFile.tellg());
+        atlasRecords = static_cast<uint32_t>((fileSize - ATLAS_HEADER_BYTES) / RECORD_BYTES);
+
+        // Just the hashes, pixels get read when a thumbnail is shown
+        for (uint32_t slot = 0; slot < atlasRecords; ++slot)
+        {
+            uint64_t hash = 0;
+            atlasFile.seekg(ATLAS_HEADER_BYTES + slot * RECORD_BYTES);
+            atlasFile.read(reinterpret_cast<char *>(&hash), sizeof(hash));
+            atlasSlots.emplace(hash, slot);
+        }
+    }
+    else
+    {
+        // Missing, from an older version or not ours, starts over
+        atlasFile.close();
+        atlasFile.open(atlasPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (atlasFile.is_open())
+        {
+            uint32_t version = ATLAS_VERSION, size = THUMBNAIL_SIZE;
+            atlasFile.write(ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+            atlasFile.write(reinterpret_cast<const char *>(&version), sizeof(version));
+            atlasFile.write(reinterpret_cast<const char *>(&size), sizeof(size));
+            atlasFile.flush();
+        }
+        else
+        {
+            DebugWarn("Could not open thumbnail atlas", atlasPath, "- model files won't get thumbnails");
+        }
+        atlasRecords = 0;
+    }
+
+    Image blank = GenImageColor(PAGE_CELLS * THUMBNAIL_SIZE, PAGE_CELLS * THUMBNAIL_SIZE, BLANK);
+    page = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+    SetTextureFilter(page, TEXTURE_FILTER_BILINEAR);
+    cellHashes.assign(PAGE_CELLS * PAGE_CELLS, 0);
+    cellFrames.assign(PAGE_CELLS * PAGE_CELLS, 0);
+
+    target = LoadRenderTexture(RENDER_SIZE, RENDER_SIZE);
+
+    quit = false;
+    worker = std::thread(&ThumbnailCache::HashWorker);
+}
+
+void ThumbnailCache::Unload()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        hashQueue.clear();
+    }
+    wake.notify_one();
+    if (worker.joinable())
+        worker.join();
+    hashResults.clear();
+
+    UnloadTexture(page);
+    UnloadRenderTexture(target);
+    page = {0};
+    target = {0};
+    atlasFile.close();
+
+    atlasSlots.clear();
+    entries.clear();
+    renderQueue.clear();
+    residentCells.clear();
+    pendingReadback.clear();
+    stats = {};
+}
+
+void ThumbnailCache::Draw(const std::string &path, float size)
+{
+    Entry &entry = entries[path];
+    entry.requestFrame = frame;
+
+    if (entry.state == EntryState::Unknown && atlasFile.is_open())
+    {
+        entry.state = EntryState::Hashing;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hashQueue.push_back(path);
+        }
+        wake.notify_one();
+    }
+
+    int cell = -1;
+    if (entry.state == EntryState::Hashed)
+    {
+        auto slot = atlasSlots.find(entry.hash);
+        if (slot != atlasSlots.end())
+            cell = GetResidentCell(entry.hash);
+    }
+
+    if (cell >= 0)
+    {
+        Rectangle source = {static_cast<float>(cell % PAGE_CELLS * THUMBNAIL_SIZE), static_cast<float>(cell / PAGE_CELLS * THUMBNAIL_SIZE),
+                            static_cast<float>(THUMBNAIL_SIZE), static_cast<float>(THUMBNAIL_SIZE)};
+        rlImGuiImageRect(&page, static_cast<int>(size), static_cast<int>(size), source);
+        return;
+    }
+
+    // Same size as the real thing so the rows don't jump once it shows up
+    ImVec2 min = ImGui::GetCursorScreenPos();
+    ImVec2 max(min.x + size, min.y + size);
+    ImGui::Dummy(ImVec2(size, size));
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(min, max, ImGui::GetColorU32(ImGuiCol_FrameBg));
+    const char *label = entry.state == EntryState::Failed ? "?" : entry.state == EntryState::TooLarge ? "big" : "...";
+    ImVec2 labelSize = ImGui::CalcTextSize(label);
+    drawList->AddText(ImVec2(min.x + (size - labelSize.x) * 0.5f, min.y + (size - labelSize.y) * 0.5f), ImGui::GetColorU32(ImGuiCol_TextDisabled), label);
+}
+
+void ThumbnailCache::Update()
+{
+    PROFILE_SCOPE("ThumbnailCache::Update");
+    ++frame;
+    uploadsThisFrame = 0;
+
+    CollectHashes();
+
+    // Scrolled away or the dialog got closed, no point hashing or rendering those anymore.
+    // They go back to Unknown so showing them again starts over
+    auto isStale = [](const std::string &path)
+    {
+        auto it = entries.find(path);
+        if (it == entries.end() || it->second.requestFrame + STALE_FRAMES >= frame)
+            return false;
+        it->second.state = EntryState::Unknown;
+        std::vector<unsigned char>().swap(it->second.bytes);
+        return true;
+    };
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hashQueue.erase(std::remove_if(hashQueue.begin(), hashQueue.end(), isStale), hashQueue.end());
+        queued = hashQueue.size();
+    }
+    renderQueue.erase(std::remove_if(renderQueue.begin(), renderQueue.end(), isStale), renderQueue.end());
+
+    FinishRender();
+
+    // -1 means it slept waiting for input, plenty of time then
+    if (FrameScheduler::GetLastFrameMs() <= RENDER_BUDGET_MS)
+        RenderNext();
+
+    // Idle frames wait for input, they have to keep coming while there's still work (without redrawing the scene)
+    if (queued > 0 || !renderQueue.empty() || !pendingReadback.empty())
+        FrameScheduler::MarkDirty(DIRTY_ANIMATION);
+}
+
+ThumbnailStats ThumbnailCache::GetStats()
+{
+    ThumbnailStats result = stats;
+    result.stored = static_cast<int>(atlasSlots.size());
+    result.resident = static_cast<int>(residentCells.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.queued = static_cast<int>(hashQueue.size());
+    }
+    result.queued += static_cast<int>(renderQueue.size());
+    return result;
+}
+
+void ThumbnailCache::HashWorker()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, []()
+                  { return quit || !hashQueue.empty(); });
+        if (quit)
+            return;
+
+        // Newest first, that's what is on screen right now
+        HashResult result;
+        result.path = std::move(hashQueue.back());
+        hashQueue.pop_back();
+        lock.unlock();
+
+        // Never going to be rendered, no point reading it all in
+        std::error_code error;
+        uintmax_t size = std::filesystem::file_size(result.path, error);
+        result.tooLarge = !error && size > MAX_RENDER_BYTES;
+        result.ok = result.tooLarge || ReadFile(result.path.c_str(), result.bytes);
+        if (result.ok && !result.tooLarge)
+            result.hash = HashBytes(result.bytes);
+
+        lock.lock();
+        hashResults.push_back(std::move(result));
+    }
+}
+
+void ThumbnailCache::CollectHashes()
+{
+    std::vector<HashResult> results;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results.swap(hashResults);
+    }
+
+    for (HashResult &result : results)
+    {
+        // Could have gone stale while the worker had it
+        auto it = entries.find(result.path);
+        if (it == entries.end() || it->second.state != EntryState::Hashing)
+            continue;
+
+        Entry &entry = it->second;
+        if (!result.ok)
+        {
+            entry.state = EntryState::Failed;
+            continue;
+        }
+        if (result.tooLarge)
+        {
+            entry.state = EntryState::TooLarge;
+            continue;
+        }
+
+        entry.state = EntryState::Hashed;
+        entry.hash = result.hash;
+        if (atlasSlots.find(result.hash) == atlasSlots.end())
+        {
+            entry.bytes = std::move(result.bytes);
+            renderQueue.push_back(result.path);
+        }
+    }
+}
+
+bool ThumbnailCache::ReadPixels(uint32_t slot, std::vector<unsigned char> &pixels)
+{
+    pixels.resize(PIXEL_BYTES);
+    atlasFile.clear();
+    atlasFile.seekg(ATLAS_HEADER_BYTES + slot * RECORD_BYTES + sizeof(uint64_t));
+    return static_cast<bool>(atlasFile.read(reinterpret_cast<char *>(pixels.data()), PIXEL_BYTES));
+}
+
+uint32_t ThumbnailCache::AppendThumbnail(uint64_t hash, const std::vector<unsigned char> &pixels)
+{
+    uint32_t slot = atlasRecords++;
+    atlasFile.clear();
+    atlasFile.seekp(ATLAS_HEADER_BYTES + slot * RECORD_BYTES);
+    atlasFile.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    atlasFile.write(reinterpret_cast<const char *>(pixels.data()), PIXEL_BYTES);
+    atlasFile.flush();
+    return slot;
+}
+
+int ThumbnailCache::GetResidentCell(uint64_t hash)
+{
+    auto resident = residentCells.find(hash);
+    if (resident != residentCells.end())
+    {
+        cellFrames[resident->second] = frame;
+        return resident->second;
+    }
+
+    if (uploadsThisFrame >= MAX_UPLOADS_PER_FRAME)
+        return -1;
+
+    // Least recently shown cell, the ones shown this frame have to stay
+    int cell = 0;
+    for (int i = 1; i < static_cast<int>(cellFrames.size()); ++i)
+    {
+        if (cellFrames[i] < cellFrames[cell])
+            cell = i;
+    }
+    if (cellFrames[cell] == frame)
+        return -1;
+
+    std::vector<unsigned char> pixels;
+    if (!ReadPixels(atlasSlots[hash], pixels))
+        return -1;
+
+    if (cellFrames[cell] != 0)
+        residentCells.erase(cellHashes[cell]);
+
+    Rectangle rect = {static_cast<float>(cell % PAGE_CELLS * THUMBNAIL_SIZE), static_cast<float>(cell / PAGE_CELLS * THUMBNAIL_SIZE),
+                      static_cast<float>(THUMBNAIL_SIZE), static_cast<float>(THUMBNAIL_SIZE)};
+    UpdateTextureRec(page, rect, pixels.data());
+    cellHashes[cell] = hash;
+    cellFrames[cell] = frame;
+    residentCells[hash] = cell;
+    ++uploadsThisFrame;
+    return cell;
+}
+
+void ThumbnailCache::FinishRender()
+{
+    if (pendingReadback.empty())
+        return;
+
+    PROFILE_SCOPE("ThumbnailCache::Readback");
+    Image image = LoadImageFromTexture(target.texture);
+    // Render targets come out upside down
+    ImageFlipVertical(&image);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    ImageResize(&image, THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+
+    auto it = entries.find(pendingReadback);
+    pendingReadback.clear();
+    if (!image.data || it == entries.end())
+    {
+        UnloadImage(image);
+        return;
+    }
+
+    std::vector<unsigned char> pixels(static_cast<unsigned char *>(image.data), static_cast<unsigned char *>(image.data) + PIXEL_BYTES);
+    UnloadImage(image);
+
+    Entry &entry = it->second;
+    entry.state = EntryState::Hashed;
+    if (atlasSlots.find(entry.hash) == atlasSlots.end())
+        atlasSlots[entry.hash] = AppendThumbnail(entry.hash, pixels);
+    ++stats.rendered;
+}
+
+void ThumbnailCache::RenderNext()
+{
+    if (renderQueue.empty() || !pendingReadback.empty())
+        return;
+
+    // One model a frame at most, the most recently shown one
+    auto next = std::max_element(renderQueue.begin(), renderQueue.end(), [](const std::string &l, const std::string &r)
+                                 { return entries[l].requestFrame < entries[r].requestFrame; });
+    std::string path = std::move(*next);
+    renderQueue.erase(next);
+
+    Entry &entry = entries[path];
+    // Another file with the same contents could have been rendered in the meantime
+    if (atlasSlots.find(entry.hash) != atlasSlots.end())
+    {
+        std::vector<unsigned char>().swap(entry.bytes);
+        return;
+    }
+
+    PROFILE_SCOPE("ThumbnailCache::Render");
+    auto start = std::chrono::steady_clock::now();
+
+    renderPath = &path;
+    renderBytes = &entry.bytes;
+    SetLoadFileDataCallback(LoadRenderFile);
+    Model model = LoadModel(path.c_str());
+    SetLoadFileDataCallback(nullptr);
+    renderPath = nullptr;
+    renderBytes = nullptr;
+    std::vector<unsigned char>().swap(entry.bytes);
+
+    if (!IsModelValid(model) || model.meshCount == 0)
+    {
+        if (IsModelValid(model))
+            UnloadModel(model);
+        entry.state = EntryState::Failed;
+        return;
+    }
+
+    // Scaled into a unit sphere around the origin, the camera then always sits at the same spot
+    BoundingBox bounds = GetModelBoundingBox(model);
+    Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+    float radius = std::max(Vector3Distance(bounds.min, bounds.max) * 0.5f, 0.0001f);
+    float scale = 1.0f / radius;
+
+    Camera3D camera = {0};
+    camera.fovy = 40.0f;
+    camera.position = Vector3Scale(Vector3Normalize(Vector3{1.0f, 0.8f, 1.0f}), 1.0f / sinf(camera.fovy * 0.5f * DEG2RAD));
+    camera.target = Vector3{0.0f, 0.0f, 0.0f};
+    camera.up = Vector3{0.0f, 1.0f, 0.0f};
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    BeginTextureMode(target);
+    ClearBackground(Color{45, 45, 48, 255});
+    BeginMode3D(camera);
+    DrawModel(model, Vector3Scale(center, -scale), scale, WHITE);
+    EndMode3D();
+    EndTextureMode();
+    UnloadModel(model);
+
+    entry.state = EntryState::Rendering;
+    pendingReadback = path;
+    stats.lastRenderMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <raylib.h>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ThumbnailStats
+{
+    int stored = 0;
+    int resident = 0;
+    int queued = 0;
+    int rendered = 0;
+    float lastRenderMs = 0.0f;
+};
+
+// Small previews of model files for the file dialog. Thumbnails are keyed by a hash of the file contents and packed
+// into one atlas file, so a copied or renamed model reuses its thumbnail and nothing gets rendered twice across sessions.
+// Hashing happens on a worker thread, rendering a missing one needs the GL context so Update does at most one a frame
+// (none when the last frame was already slow, and never for files over MAX_RENDER_BYTES). Only the thumbnails that are actually on screen get read from the
+// atlas file, they go into one GPU page with the least recently shown ones making room.
+class ThumbnailCache
+{
+public:
+    static constexpr int THUMBNAIL_SIZE = 64;
+    // GPU page is PAGE_CELLS x PAGE_CELLS thumbnails
+    static constexpr int PAGE_CELLS = 16;
+    // Reading a thumbnail is 16KB, still no reason to pull a whole screen of them in one frame
+    static constexpr int MAX_UPLOADS_PER_FRAME = 16;
+    // Previous frame took longer than this, the render waits
+    static constexpr float RENDER_BUDGET_MS = 12.0f;
+    // raylib's loaders parse and upload in one go, so LoadModel can only run on the main thread. Model files bigger than
+    // this would stall the frame it happens in, they keep the placeholder instead of getting a thumbnail
+    static constexpr uintmax_t MAX_RENDER_BYTES = 1 << 20;
+
+    // After InitWindow. Only reads the hashes out of the atlas file, creates it when it's missing
+    static void Load(const std::string &atlasPath);
+    static void Unload();
+
+    // Thumbnail of a model file at size x size, a placeholder until it's ready. Asks for it to be made when it's missing,
+    // whatever isn't drawn for a couple frames gets dropped from the queues again
+    static void Draw(const std::string &path, float size);
+
+    // Once a frame on the main thread, outside BeginDrawing (renders into its own target)
+    static void Update();
+
+    static ThumbnailStats GetStats();
+
+private:
+    enum class EntryState
+    {
+        Unknown,
+        Hashing,
+        Hashed,
+        Rendering,
+        Failed,
+        TooLarge,
+    };
+
+    struct Entry
+    {
+        EntryState state = EntryState::Unknown;
+        uint64_t hash = 0;
+        uint64_t requestFrame = 0;
+        // Only kept while it waits to be rendered, LoadModel gets it instead of reading the file again
+        std::vector<unsigned char> bytes;
+    };
+
+    struct HashResult
+    {
+        std::string path;
+        bool ok = false;
+        bool tooLarge = false;
+        uint64_t hash = 0;
+        std::vector<unsigned char> bytes;
+    };
+
+    static void HashWorker();
+    static bool ReadPixels(uint32_t slot, std::vector<unsigned char> &pixels);
+    static uint32_t AppendThumbnail(uint64_t hash, const std::vector<unsigned char> &pixels);
+    // Cell in the GPU page holding the thumbnail, -1 when it can't be shown this frame
+    static int GetResidentCell(uint64_t hash);
+    static void CollectHashes();
+    static void FinishRender();
+    static void RenderNext();
+
+    static std::fstream atlasFile;
+    static uint32_t atlasRecords;
+    static std::unordered_map<uint64_t, uint32_t> atlasSlots;
+    static std::unordered_map<std::string, Entry> entries;
+    // Hashed but not in the atlas yet, the most recently shown one gets rendered first
+    static std::vector<std::string> renderQueue;
+
+    static Texture2D page;
+    static std::vector<uint64_t> cellHashes;
+    static std::vector<uint64_t> cellFrames;
+    static std::unordered_map<uint64_t, int> residentCells;
+    static int uploadsThisFrame;
+
+    static RenderTexture2D target;
+    // Rendered last frame, read back this one so the read doesn't wait on the GPU
+    static std::string pendingReadback;
+    static uint64_t frame;
+    static ThumbnailStats stats;
+
+    static std::thread worker;
+    static std::mutex mutex;
+    static std::condition_variable wake;
+    static bool quit;
+    static std::vector<std::string> hashQueue;
+    static std::vector<HashResult> hashResults;
+};
@@ -0,0 +1,168 @@
+#include "TransformBatch.h"
+#include "../Simd.h"
+
+namespace
+{
+    // QuaternionToMatrix with each axis scaled, the translation on the end. Same operations in the same order as
+    // raymath, the SIMD versions below do exactly this per lane
+    void ComputeOne(const TransformSoA &t, size_t i, Matrix &m)
+    {
+        float x = t.rotationX[i], y = t.rotationY[i], z = t.rotationZ[i], w = t.rotationW[i];
+        float xx = x * x, yy = y * y, zz = z * z;
+        float xy = x * y, xz = x * z, yz = y * z;
+        float wx = w * x, wy = w * y, wz = w * z;
+        float sx = t.scaleX[i], sy = t.scaleY[i], sz = t.scaleZ[i];
+
+        m.m0 = sx * (1 - 2 * (yy + zz));
+        m.m1 = sx * (2 * (xy + wz));
+        m.m2 = sx * (2 * (xz - wy));
+        m.m3 = 0.0f;
+        m.m4 = sy * (2 * (xy - wz));
+        m.m5 = sy * (1 - 2 * (xx + zz));
+        m.m6 = sy * (2 * (yz + wx));
+        m.m7 = 0.0f;
+        m.m8 = sz * (2 * (xz + wy));
+        m.m9 = sz * (2 * (yz - wx));
+        m.m10 = sz * (1 - 2 * (xx + yy));
+        m.m11 = 0.0f;
+        m.m12 = t.positionX[i];
+        m.m13 = t.positionY[i];
+        m.m14 = t.positionZ[i];
+        m.m15 = 1.0f;
+    }
+
+    // raylib's Matrix is stored m0 m4 m8 m12 / m1 m5 m9 m13 / m2 m6 m10 m14 / m3 m7 m11 m15,
+    // so every one of those rows is 4 floats in a row at these offsets
+    constexpr size_t ROW0 = 0;
+    constexpr size_t ROW1 = 4;
+    constexpr size_t ROW2 = 8;
+    constexpr size_t ROW3 = 12;
+
+#ifdef EDITOR_SSE2
+    struct SseLanes
+    {
+        using Vector = __m128;
+        static constexpr size_t WIDTH = 4;
+
+        static Vector Load(const float *p) { return _mm_loadu_ps(p); }
+        static Vector Set(float value) { return _mm_set1_ps(value); }
+        static Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+
+        // a/b/c/d hold one element each for 4 entities, turned around into one row per entity
+        static void StoreRow(Matrix *out, size_t row, Vector a, Vector b, Vector c, Vector d)
+        {
+            _MM_TRANSPOSE4_PS(a, b, c, d);
+            _mm_storeu_ps(reinterpret_cast<float *>(out + 0) + row, a);
+            _mm_storeu_ps(reinterpret_cast<float *>(out + 1) + row, b);
+            _mm_storeu_ps(reinterpret_cast<float *>(out + 2) + row, c);
+            _mm_storeu_ps(reinterpret_cast<float *>(out + 3) + row, d);
+        }
+    };
+#endif
+
+#ifdef EDITOR_AVX
+    struct AvxLanes
+    {
+        using Vector = __m256;
+        static constexpr size_t WIDTH = 8;
+
+        static Vector Load(const float *p) { return _mm256_loadu_ps(p); }
+        static Vector Set(float value) { return _mm256_set1_ps(value); }
+        static Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+        static Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+        static Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+
+        // Same transpose as SSE, AVX shuffles stay inside their 128 bit half so the low half ends up with entities
+        // 0-3 and the high half with 4-7
+        static void StoreRow(Matrix *out, size_t row, Vector a, Vector b, Vector c, Vector d)
+        {
+            Vector abLow = _mm256_unpacklo_ps(a, b);
+            Vector cdLow = _mm256_unpacklo_ps(c, d);
+            Vector abHigh = _mm256_unpackhi_ps(a, b);
+            Vector cdHigh = _mm256_unpackhi_ps(c, d);
+            Vector rows[4] = {
+                _mm256_shuffle_ps(abLow, cdLow, _MM_SHUFFLE(1, 0, 1, 0)),
+                _mm256_shuffle_ps(abLow, cdLow, _MM_SHUFFLE(3, 2, 3, 2)),
+                _mm256_shuffle_ps(abHigh, cdHigh, _MM_SHUFFLE(1, 0, 1, 0)),
+                _mm256_shuffle_ps(abHigh, cdHigh, _MM_SHUFFLE(3, 2, 3, 2)),
+            };
+            for (int i = 0; i < 4; ++i)
+            {
+                _mm_storeu_ps(reinterpret_cast<float *>(out + i) + row, _mm256_castps256_ps128(rows[i]));
+                _mm_storeu_ps(reinterpret_cast<float *>(out + i + 4) + row, _mm256_extractf128_ps(rows[i], 1));
+            }
+        }
+    };
+#endif
+
+#ifdef EDITOR_SSE2
+    // Lanes::WIDTH entities starting at i
+    template <typename Lanes>
+    void ComputeLanes(const TransformSoA &t, size_t i, Matrix *out)
+    {
+        using Vector = typename Lanes::Vector;
+        Vector x = Lanes::Load(&t.rotationX[i]), y = Lanes::Load(&t.rotationY[i]), z = Lanes::Load(&t.rotationZ[i]), w = Lanes::Load(&t.rotationW[i]);
+        Vector xx = Lanes::Mul(x, x), yy = Lanes::Mul(y, y), zz = Lanes::Mul(z, z);
+        Vector xy = Lanes::Mul(x, y), xz = Lanes::Mul(x, z), yz = Lanes::Mul(y, z);
+        Vector wx = Lanes::Mul(w, x), wy = Lanes::Mul(w, y), wz = Lanes::Mul(w, z);
+        Vector sx = Lanes::Load(&t.scaleX[i]), sy = Lanes::Load(&t.scaleY[i]), sz = Lanes::Load(&t.scaleZ[i]);
+        Vector one = Lanes::Set(1.0f), two = Lanes::Set(2.0f), zero = Lanes::Set(0.0f);
+
+        Vector m0 = Lanes::Mul(sx, Lanes::Sub(one, Lanes::Mul(two, Lanes::Add(yy, zz))));
+        Vector m1 = Lanes::Mul(sx, Lanes::Mul(two, Lanes::Add(xy, wz)));
+        Vector m2 = Lanes::Mul(sx, Lanes::Mul(two, Lanes::Sub(xz, wy)));
+        Vector m4 = Lanes::Mul(sy, Lanes::Mul(two, Lanes::Sub(xy, wz)));
+        Vector m5 = Lanes::Mul(sy, Lanes::Sub(one, Lanes::Mul(two, Lanes::Add(xx, zz))));
+        Vector m6 = Lanes::Mul(sy, Lanes::Mul(two, Lanes::Add(yz, wx)));
+        Vector m8 = Lanes::Mul(sz, Lanes::Mul(two, Lanes::Add(xz, wy)));
+        Vector m9 = Lanes::Mul(sz, Lanes::Mul(two, Lanes::Sub(yz, wx)));
+        Vector m10 = Lanes::Mul(sz, Lanes::Sub(one, Lanes::Mul(two, Lanes::Add(xx, yy))));
+
+        Matrix *first = out + i;
+        Lanes::StoreRow(first, ROW0, m0, m4, m8, Lanes::Load(&t.positionX[i]));
+        Lanes::StoreRow(first, ROW1, m1, m5, m9, Lanes::Load(&t.positionY[i]));
+        Lanes::StoreRow(first, ROW2, m2, m6, m10, Lanes::Load(&t.positionZ[i]));
+        Lanes::StoreRow(first, ROW3, zero, zero, zero, one);
+    }
+#endif
+}
+
+void TransformSoA::Resize(size_t count)
+{
+    for (std::vector<float> *array : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ, &rotationW, &scaleX, &scaleY, &scaleZ})
+        array->resize(count);
+}
+
+void TransformBatch::ComputeWorldMatrices(const TransformSoA &transforms, size_t begin, size_t end, Matrix *out)
+{
+    size_t i = begin;
+#ifdef EDITOR_AVX
+    for (; i + AvxLanes::WIDTH <= end; i += AvxLanes::WIDTH)
+        ComputeLanes<AvxLanes>(transforms, i, out);
+#endif
+#ifdef EDITOR_SSE2
+    for (; i + SseLanes::WIDTH <= end; i += SseLanes::WIDTH)
+        ComputeLanes<SseLanes>(transforms, i, out);
+#endif
+    for (; i < end; ++i)
+        ComputeOne(transforms, i, out[i]);
+}
+
+void TransformBatch::ComputeWorldMatricesScalar(const TransformSoA &transforms, size_t begin, size_t end, Matrix *out)
+{
+    for (size_t i = begin; i < end; ++i)
+        ComputeOne(transforms, i, out[i]);
+}
+
+const char *TransformBatch::GetPathName()
+{
+#if defined(EDITOR_AVX)
+    return "AVX";
+#elif defined(EDITOR_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,145 @@
+#include "UiBenchmark.h"
+#include <raylib.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "../../imgui/imgui.h"
+#include "../../imgui/rlImGui.h"
+
+namespace
+{
+    const int TEXT_LINES = 400;
+    const int TABLE_ROWS = 200;
+    const int BACKGROUND_SHAPES = 6000;
+
+    struct UiFrameTimes
+    {
+        std::vector<double> renderMs;
+        std::vector<double> frameMs;
+        rlImGuiRenderStats stats = {};
+    };
+
+    double MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Every window gets a fixed spot and size so both runs draw exactly the same thing
+    void BuildSyntheticUi(int frame)
+    {
+        float width = static_cast<float>(GetScreenWidth());
+        float height = static_cast<float>(GetScreenHeight());
+
+        ImDrawList *background = ImGui::GetBackgroundDrawList();
+        for (int i = 0; i < BACKGROUND_SHAPES; ++i)
+        {
+            float x = static_cast<float>((i * 37 + frame) % static_cast<int>(width));
+            float y = static_cast<float>((i * 91) % static_cast<int>(height));
+            ImU32 color = IM_COL32((i * 13) & 0xFF, (i * 29) & 0xFF, (i * 53) & 0xFF, 160);
+            if (i % 3 == 0)
+                background->AddCircleFilled(ImVec2(x, y), 6.0f, color, 12);
+            else
+                background->AddRectFilled(ImVec2(x, y), ImVec2(x + 14.0f, y + 9.0f), color, 2.0f);
+        }
+
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(ImVec2(width * 0.5f, height));
+        ImGui::Begin("UI Bench Text", nullptr, ImGuiWindowFlags_NoSavedSettings);
+        for (int i = 0; i < TEXT_LINES; ++i)
+            ImGui::Text("Line %04d: the quick brown fox jumps over the lazy dog %d", i, frame);
+        ImGui::End();
+
+        ImGui::SetNextWindowPos(ImVec2(width * 0.5f, 0));
+        ImGui::SetNextWindowSize(ImVec2(width * 0.5f, height));
+        ImGui::Begin("UI Bench Widgets", nullptr, ImGuiWindowFlags_NoSavedSettings);
+        if (ImGui::BeginTable("Widgets", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+        {
+            static float values[TABLE_ROWS] = {};
+            static bool checks[TABLE_ROWS] = {};
+            for (int row = 0; row < TABLE_ROWS; ++row)
+            {
+                ImGui::PushID(row);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("Entity %d", row);
+                ImGui::TableNextColumn();
+                ImGui::SliderFloat("##value", &values[row], 0.0f, 1.0f);
+                ImGui::TableNextColumn();
+                ImGui::Checkbox("##check", &checks[row]);
+                ImGui::TableNextColumn();
+                ImGui::ProgressBar(static_cast<float>((row + frame) % 100) / 100.0f, ImVec2(-1.0f, 0.0f));
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+    }
+
+    UiFrameTimes RunFrames(int frames, bool buffered)
+    {
+        rlImGuiSetBufferedRendering(buffered);
+
+        UiFrameTimes times;
+        times.renderMs.reserve(frames);
+        times.frameMs.reserve(frames);
+        for (int frame = 0; frame < frames && !WindowShouldClose(); ++frame)
+        {
+            auto frameStart = std::chrono::steady_clock::now();
+
+            BeginDrawing();
+            ClearBackground(DARKGRAY);
+            rlImGuiBegin();
+            BuildSyntheticUi(frame);
+
+            auto renderStart = std::chrono::steady_clock::now();
+            rlImGuiEnd();
+            times.renderMs.push_back(MsSince(renderStart));
+            EndDrawing();
+
+            times.frameMs.push_back(MsSince(frameStart));
+        }
+        times.stats = rlImGuiGetRenderStats();
+        return times;
+    }
+
+    void Report(const char *name, std::vector<double> values)
+    {
+        if (values.empty())
+            return;
+
+        std::sort(values.begin(), values.end());
+        auto percentile = [&](double p)
+        {
+            size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+            return values[index];
+        };
+
+        double total = 0.0;
+        for (double value : values)
+            total += value;
+
+        std::cout << "  " << name << ": avg " << total / values.size() << " ms, p50 " << percentile(0.5) << " ms, p99 " << percentile(0.99)
+                  << " ms, max " << values.back() << " ms\n";
+    }
+}
+
+void RunUiBenchmark(int frames)
+{
+    bool wasBuffered = rlImGuiIsBufferedRendering();
+
+    // One throwaway run first, font atlas upload and the first window layouts shouldn't land in either result
+    RunFrames(std::min(frames, 30), true);
+
+    const bool modes[] = {true, false};
+    for (bool buffered : modes)
+    {
+        UiFrameTimes times = RunFrames(frames, buffered);
+        std::cout << "UI bench (" << (buffered ? "buffered" : "batched") << "): " << times.renderMs.size() << " frames, "
+                  << times.stats.vertices << " vertices, " << times.stats.indices << " indices, " << times.stats.drawCalls << " draw calls\n";
+        Report("rlImGuiEnd", times.renderMs);
+        Report("frame", times.frameMs);
+    }
+
+    rlImGuiSetBufferedRendering(wasBuffered);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Draws the same big synthetic UI (text walls, a widget table, thousands of background shapes) for a number of frames
+// with the buffered and the batched rlImGui backend and prints the render times of both. Needs the window and rlImGuiSetup.
+void RunUiBenchmark(int frames);
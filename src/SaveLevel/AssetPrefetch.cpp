@@ -0,0 +1,60 @@
+#include "AssetPrefetch.h"
+#include <fstream>
+#include "../Jobs/JobSystem.h"
+#include "../Profiling/Profiler.h"
+
+std::mutex AssetPrefetch::mutex;
+std::unordered_map<std::string, std::vector<unsigned char>> AssetPrefetch::files;
+
+size_t AssetPrefetch::Prefetch(const std::vector<std::string> &paths)
+{
+    PROFILE_SCOPE("AssetPrefetch::Prefetch");
+
+    std::vector<std::vector<unsigned char>> data(paths.size());
+    auto readFiles = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            std::ifstream file(paths[i], std::ios::binary | std::ios::ate);
+            if (!file.is_open())
+                continue;
+
+            std::streamoff size = file.tellg();
+            file.seekg(0);
+            data[i].resize(static_cast<size_t>(size));
+            if (size > 0 && !file.read(reinterpret_cast<char *>(data[i].data()), size))
+                data[i].clear();
+        }
+    };
+    // One file per job, they're few and big
+    JobSystem::ParallelFor(paths.size(), 1, readFiles);
+
+    size_t bytes = 0;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (data[i].empty())
+            continue;
+        bytes += data[i].size();
+        files[paths[i]] = std::move(data[i]);
+    }
+    return bytes;
+}
+
+bool AssetPrefetch::Take(const std::string &path, std::vector<unsigned char> &data)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(path);
+    if (it == files.end())
+        return false;
+
+    data = std::move(it->second);
+    files.erase(it);
+    return true;
+}
+
+void AssetPrefetch::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    files.clear();
+}
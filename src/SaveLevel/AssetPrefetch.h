@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Model files read ahead of time by LoadLevel, so the GPU upload after it doesn't sit waiting on the disk.
+// Just the bytes, turning them into a Model needs the GL context (ModelCache takes them from here).
+class AssetPrefetch
+{
+public:
+    // Reads every file spread over the JobSystem, blocks until they're all in. Returns the bytes read,
+    // files that can't be opened are skipped (the real load reports those)
+    static size_t Prefetch(const std::vector<std::string> &paths);
+
+    // Hands the bytes over and forgets them, false when the file wasn't prefetched (or already got taken)
+    static bool Take(const std::string &path, std::vector<unsigned char> &data);
+
+    // Whatever never got taken, models that failed or got removed before they were drawn
+    static void Clear();
+
+private:
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::vector<unsigned char>> files;
+};
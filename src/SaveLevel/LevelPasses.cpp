@@ -0,0 +1,159 @@
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include "LevelPasses.h"
+
+namespace
+{
+    bool IsFinite(Vector3 v)
+    {
+        return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+    }
+
+    bool IsFinite(Quaternion q)
+    {
+        return std::isfinite(q.x) && std::isfinite(q.y) && std::isfinite(q.z) && std::isfinite(q.w);
+    }
+
+    std::string RecordLabel(size_t index)
+    {
+        return "entity " + std::to_string(index);
+    }
+
+    bool BoundsEqual(const BoundingBox &a, const BoundingBox &b)
+    {
+        return std::memcmp(&a, &b, sizeof(BoundingBox)) == 0;
+    }
+}
+
+const std::vector<LevelPass> &GetLevelPasses()
+{
+    static const std::vector<LevelPass> passes = {
+        {"validate", "check indices, component types and transforms", ValidateLevel},
+        {"compact-strings", "drop unused and duplicate strings", CompactLevelStrings},
+        {"bounds", "recompute the level bounds", RecomputeLevelBounds},
+        {"stats", "print entity and string counts", CollectLevelStats},
+    };
+    return passes;
+}
+
+const LevelPass *FindLevelPass(const std::string &name)
+{
+    for (const LevelPass &pass : GetLevelPasses())
+    {
+        if (name == pass.name)
+            return &pass;
+    }
+    return nullptr;
+}
+
+void ValidateLevel(LevelData &level, LevelPassReport &report)
+{
+    uint32_t stringCount = static_cast<uint32_t>(level.strings.size());
+
+    for (size_t i = 0; i < level.entities.size(); ++i)
+    {
+        const LevelEntityRecord &record = level.entities[i];
+
+        if (record.nameIndex != LEVEL_NO_STRING && record.nameIndex >= stringCount)
+            report.errors.push_back(RecordLabel(i) + ": name index " + std::to_string(record.nameIndex) + " is out of range");
+
+        if (record.componentType > LevelComponentType::Model)
+            report.errors.push_back(RecordLabel(i) + ": unknown component type " + std::to_string(static_cast<int>(record.componentType)));
+
+        if (record.componentType == LevelComponentType::Model)
+        {
+            if (record.modelPathIndex == LEVEL_NO_STRING)
+                report.notes.push_back(RecordLabel(i) + ": model without a file");
+            else if (record.modelPathIndex >= stringCount)
+                report.errors.push_back(RecordLabel(i) + ": model path index " + std::to_string(record.modelPathIndex) + " is out of range");
+        }
+
+        if (!IsFinite(record.position) || !IsFinite(record.rotation) || !IsFinite(record.scale) || !IsFinite(record.eulerAngles))
+            report.errors.push_back(RecordLabel(i) + ": transform has NaN or infinite values");
+        else if (record.scale.x == 0.0f || record.scale.y == 0.0f || record.scale.z == 0.0f)
+            report.notes.push_back(RecordLabel(i) + ": zero scale, it can't be seen or picked");
+
+        if (record.componentType == LevelComponentType::Cube && !IsFinite(record.size))
+            report.errors.push_back(RecordLabel(i) + ": cube size has NaN or infinite values");
+        if (record.componentType == LevelComponentType::Sphere && !std::isfinite(record.radius))
+            report.errors.push_back(RecordLabel(i) + ": sphere radius is NaN or infinite");
+    }
+}
+
+void CompactLevelStrings(LevelData &level, LevelPassReport &report)
+{
+    std::vector<std::string> compacted;
+    std::unordered_map<std::string, uint32_t> indices;
+    // Old index -> new index, so every record using the same string only hashes it once
+    std::vector<uint32_t> remap(level.strings.size(), LEVEL_NO_STRING);
+
+    auto remapIndex = [&](uint32_t &index)
+    {
+        if (index == LEVEL_NO_STRING || index >= level.strings.size())
+            return;
+
+        if (remap[index] == LEVEL_NO_STRING)
+        {
+            auto it = indices.find(level.strings[index]);
+            if (it == indices.end())
+            {
+                it = indices.emplace(level.strings[index], static_cast<uint32_t>(compacted.size())).first;
+                compacted.push_back(level.strings[index]);
+            }
+            remap[index] = it->second;
+        }
+        index = remap[index];
+    };
+
+    for (LevelEntityRecord &record : level.entities)
+    {
+        remapIndex(record.nameIndex);
+        if (record.componentType == LevelComponentType::Model)
+            remapIndex(record.modelPathIndex);
+        else
+            record.modelPathIndex = LEVEL_NO_STRING;
+    }
+
+    size_t removed = level.strings.size() - compacted.size();
+    if (removed > 0)
+    {
+        report.notes.push_back("removed " + std::to_string(removed) + " unused or duplicate strings");
+        report.modified = true;
+    }
+
+    level.strings = std::move(compacted);
+}
+
+void RecomputeLevelBounds(LevelData &level, LevelPassReport &report)
+{
+    BoundingBox bounds = ComputeLevelBounds(level.entities);
+    if (!BoundsEqual(bounds, level.bounds))
+    {
+        level.bounds = bounds;
+        report.modified = true;
+    }
+}
+
+void CollectLevelStats(LevelData &level, LevelPassReport &report)
+{
+    size_t counts[4] = {0, 0, 0, 0};
+    std::unordered_set<uint32_t> models;
+    for (const LevelEntityRecord &record : level.entities)
+    {
+        if (record.componentType <= LevelComponentType::Model)
+            counts[static_cast<size_t>(record.componentType)]++;
+        if (record.componentType == LevelComponentType::Model && record.modelPathIndex != LEVEL_NO_STRING)
+            models.insert(record.modelPathIndex);
+    }
+
+    size_t stringBytes = 0;
+    for (const auto &string : level.strings)
+        stringBytes += string.size();
+
+    report.notes.push_back(std::to_string(level.entities.size()) + " entities (" + std::to_string(counts[1]) + " cubes, " +
+                           std::to_string(counts[2]) + " spheres, " + std::to_string(counts[3]) + " models, " +
+                           std::to_string(counts[0]) + " empty), " + std::to_string(models.size()) + " unique models, " +
+                           std::to_string(level.strings.size()) + " strings (" + std::to_string(stringBytes) + " bytes)");
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "save.h"
+
+// Passes that work on a LevelData in file form, no GameEntities involved. Used by level_tool, but nothing
+// stops the editor from running them before a save.
+
+struct LevelPassReport
+{
+    std::vector<std::string> errors;
+    std::vector<std::string> notes;
+    bool modified = false;
+};
+
+typedef void (*LevelPassFunction)(LevelData &level, LevelPassReport &report);
+
+struct LevelPass
+{
+    const char *name;
+    const char *description;
+    LevelPassFunction run;
+};
+
+// Every pass there is, in the order they make sense to run in
+const std::vector<LevelPass> &GetLevelPasses();
+const LevelPass *FindLevelPass(const std::string &name);
+
+// Indices out of range, unknown component types, NaNs, zero scale... anything that would break loading or picking
+void ValidateLevel(LevelData &level, LevelPassReport &report);
+// Drops strings nothing points at and merges duplicates, remapping the record indices
+void CompactLevelStrings(LevelData &level, LevelPassReport &report);
+void RecomputeLevelBounds(LevelData &level, LevelPassReport &report);
+// Doesn't change anything, just counts (entities per type, unique models, string bytes)
+void CollectLevelStats(LevelData &level, LevelPassReport &report);
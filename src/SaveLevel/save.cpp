@@ -1,12 +1,546 @@
+#include <algorithm>
 #include <iostream>
 #include <vector>
+#include <fstream>
+#include <cstring>
+#include <cfloat>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_set>
 #include "save.h"
+#include "AssetPrefetch.h"
+#include "../Jobs/JobSystem.h"
+#include "../Profiling/Profiler.h"
 
-bool SaveLevel()
+namespace
 {
+    template <typename T>
+    void WritePod(std::ofstream &file, const T &value)
+    {
+        file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool ReadPod(std::ifstream &file, T &value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    // Shares one table entry between everything using the same string (lots of "Entity" names, same model paths).
+    // Pool ids are unique already, so that's a plain array lookup instead of hashing every name again
+    class StringTableBuilder
+    {
+    public:
+        explicit StringTableBuilder(std::vector<std::string> &table) : strings(table), indices(StringPool::GetCount(), LEVEL_NO_STRING) {}
+
+        uint32_t Add(StringId id)
+        {
+            // Interned after this got made
+            if (id >= indices.size())
+                indices.resize(StringPool::GetCount(), LEVEL_NO_STRING);
+
+            uint32_t &index = indices[id];
+            if (index == LEVEL_NO_STRING)
+            {
+                index = static_cast<uint32_t>(strings.size());
+                strings.emplace_back(StringPool::Get(id));
+            }
+            return index;
+        }
+
+    private:
+        std::vector<std::string> &strings;
+        std::vector<uint32_t> indices;
+    };
+
+    const std::string *GetString(const LevelData &level, uint32_t index)
+    {
+        return index < level.strings.size() ? &level.strings[index] : nullptr;
+    }
+
+    // Table index -> pool id, done once per level so building the entities doesn't hash a single string
+    std::vector<StringId> InternStrings(const LevelData &level)
+    {
+        std::vector<StringId> ids;
+        ids.reserve(level.strings.size());
+        for (const auto &string : level.strings)
+            ids.push_back(StringPool::Intern(string));
+        return ids;
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // What's left of the file after the current position
+    uint64_t GetBytesLeft(std::ifstream &file)
+    {
+        std::streampos current = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streampos end = file.tellg();
+        file.seekg(current);
+        return end > current ? static_cast<uint64_t>(end - current) : 0;
+    }
+
+    // Everything in front of the records. Leaves the file at the first record, entityCount is how many follow.
+    // Every count in here comes from the file, each one gets checked against what's left of it before anything is sized
+    // with it, a broken file shouldn't be able to ask for gigabytes
+    bool ReadLevelPrelude(std::ifstream &file, const std::string &path, LevelData &level, uint32_t &entityCount, std::vector<uint32_t> &modelPaths)
+    {
+        LevelFileHeader header;
+        if (!ReadPod(file, header) || std::memcmp(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic)) != 0)
+        {
+            DebugError("Not a level file:", path);
+            return false;
+        }
+
+        if (header.version > LEVEL_FILE_VERSION)
+        {
+            DebugError("Level file is from a newer version:", path, static_cast<int>(header.version));
+            return false;
+        }
+
+        uint64_t bytesLeft = GetBytesLeft(file);
+        // Every string has its length in front of it, even the empty ones
+        if (uint64_t(header.stringCount) * sizeof(uint32_t) > bytesLeft)
+        {
+            DebugError("Level file string table doesn't fit in the file:", path, std::to_string(header.stringCount), "strings");
+            return false;
+        }
+
+        level.version = header.version;
+        level.bounds = header.bounds;
+
+        level.strings.clear();
+        level.strings.resize(header.stringCount);
+        for (auto &string : level.strings)
+        {
+            uint32_t length;
+            if (!ReadPod(file, length))
+            {
+                DebugError("Level file string table is truncated:", path);
+                return false;
+            }
+            bytesLeft -= sizeof(uint32_t);
+
+            if (length > bytesLeft)
+            {
+                DebugError("Level file string doesn't fit in the file:", path, std::to_string(length), "bytes");
+                return false;
+            }
+
+            string.resize(length);
+            if (length > 0 && !file.read(&string[0], length))
+            {
+                DebugError("Level file string table is truncated:", path);
+                return false;
+            }
+            bytesLeft -= length;
+        }
+
+        modelPaths.clear();
+        if (header.version >= 2)
+        {
+            uint32_t modelCount;
+            if (!ReadPod(file, modelCount))
+            {
+                DebugError("Level file model table is truncated:", path);
+                return false;
+            }
+            bytesLeft = bytesLeft >= sizeof(uint32_t) ? bytesLeft - sizeof(uint32_t) : 0;
+
+            if (uint64_t(modelCount) * sizeof(uint32_t) > bytesLeft)
+            {
+                DebugError("Level file model table doesn't fit in the file:", path, std::to_string(modelCount), "models");
+                return false;
+            }
+
+            modelPaths.resize(modelCount);
+            if (modelCount > 0 && !file.read(reinterpret_cast<char *>(modelPaths.data()), modelCount * sizeof(uint32_t)))
+            {
+                DebugError("Level file model table is truncated:", path);
+                return false;
+            }
+            bytesLeft -= uint64_t(modelCount) * sizeof(uint32_t);
+        }
+
+        if (uint64_t(header.entityCount) * sizeof(LevelEntityRecord) > bytesLeft)
+        {
+            DebugError("Level file entities are truncated:", path, std::to_string(header.entityCount), "entities in the header");
+            return false;
+        }
+        entityCount = header.entityCount;
+
+        return true;
+    }
+
+    GameEntity *CreateEntity(const std::vector<StringId> &stringIds, const LevelEntityRecord &record)
+    {
+        GameEntity *entity = new GameEntity();
+        if (record.nameIndex < stringIds.size())
+            entity->SetNameId(stringIds[record.nameIndex]);
+
+        entity->EntityTransform.position = record.position;
+        entity->EntityTransform.rotation = record.rotation;
+        entity->EntityTransform.scale = record.scale;
+        entity->EntityTransform.eulerAngles = record.eulerAngles;
+        entity->EntityTransform.useEulerStorage = record.useEulerStorage != 0;
+
+        switch (record.componentType)
+        {
+        case LevelComponentType::Cube:
+        {
+            auto cube = entity->AddComponent<CubeComponent>();
+            cube->size = record.size;
+            cube->color = record.color;
+            cube->occluder = (record.flags & LEVEL_ENTITY_OCCLUDER) != 0;
+            break;
+        }
+        case LevelComponentType::Sphere:
+        {
+            auto sphere = entity->AddComponent<SphereComponent>();
+            sphere->radius = record.radius;
+            sphere->color = record.color;
+            break;
+        }
+        case LevelComponentType::Model:
+        {
+            auto model = entity->AddComponent<ModelComponent>();
+            model->occluder = (record.flags & LEVEL_ENTITY_OCCLUDER) != 0;
+            // Only the path, the renderer loads the actual model the first time it draws it
+            if (record.modelPathIndex < stringIds.size())
+                model->SetFilePathId(stringIds[record.modelPathIndex]);
+            break;
+        }
+        default:
+            break;
+        }
+
+        return entity;
+    }
+
+    // Entities per job when building them, allocating them is most of the cost
+    constexpr size_t CREATE_GRAIN = 512;
+
+    // Fills entities[first + i] for every record in [recordBegin, recordEnd)
+    void CreateEntityRange(const LevelData &level, const std::vector<StringId> &stringIds, size_t recordBegin, size_t recordEnd, std::vector<GameEntity *> &entities, size_t first)
+    {
+        auto create = [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                entities[first + i] = CreateEntity(stringIds, level.entities[recordBegin + i]);
+        };
+        JobSystem::ParallelFor(recordEnd - recordBegin, CREATE_GRAIN, create);
+    }
+}
+
+bool WriteLevelFile(const std::string &path, const LevelData &level)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        DebugError("Could not open level file for writing:", path);
+        return false;
+    }
+
+    LevelFileHeader header = {};
+    std::memcpy(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic));
+    header.version = LEVEL_FILE_VERSION;
+    header.entityCount = static_cast<uint32_t>(level.entities.size());
+    header.stringCount = static_cast<uint32_t>(level.strings.size());
+    header.bounds = level.bounds;
+    WritePod(file, header);
+
+    for (const auto &string : level.strings)
+    {
+        uint32_t length = static_cast<uint32_t>(string.size());
+        WritePod(file, length);
+        file.write(string.data(), length);
+    }
+
+    // Every model path once, in the order they first show up
+    std::vector<uint32_t> modelPaths;
+    std::unordered_set<uint32_t> seenModels;
+    for (const auto &record : level.entities)
+    {
+        if (record.componentType == LevelComponentType::Model && record.modelPathIndex != LEVEL_NO_STRING && seenModels.insert(record.modelPathIndex).second)
+            modelPaths.push_back(record.modelPathIndex);
+    }
+    uint32_t modelCount = static_cast<uint32_t>(modelPaths.size());
+    WritePod(file, modelCount);
+    file.write(reinterpret_cast<const char *>(modelPaths.data()), modelPaths.size() * sizeof(uint32_t));
+
+    file.write(reinterpret_cast<const char *>(level.entities.data()), level.entities.size() * sizeof(LevelEntityRecord));
+
+    return static_cast<bool>(file);
+}
+
+bool ReadLevelFile(const std::string &path, LevelData &level)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        DebugError("Could not open level file:", path);
+        return false;
+    }
+
+    // The counts are checked against the file size, this is only for when the machine really is out of memory
+    try
+    {
+        uint32_t entityCount;
+        std::vector<uint32_t> modelPaths;
+        if (!ReadLevelPrelude(file, path, level, entityCount, modelPaths))
+            return false;
+
+        level.entities.resize(entityCount);
+        if (!file.read(reinterpret_cast<char *>(level.entities.data()), level.entities.size() * sizeof(LevelEntityRecord)))
+        {
+            DebugError("Level file entities are truncated:", path);
+            return false;
+        }
+    }
+    catch (const std::bad_alloc &)
+    {
+        DebugError("Out of memory reading level file:", path);
+        return false;
+    }
+
+    return true;
+}
+
+LevelData BuildLevelData(const std::vector<GameEntity *> &entities)
+{
+    LevelData level;
+    StringTableBuilder strings(level.strings);
+    level.entities.reserve(entities.size());
+
+    for (auto entity : entities)
+    {
+        LevelEntityRecord record;
+        record.nameIndex = strings.Add(entity->GetNameId());
+        record.position = entity->EntityTransform.position;
+        record.rotation = entity->EntityTransform.rotation;
+        record.scale = entity->EntityTransform.scale;
+        record.eulerAngles = entity->EntityTransform.eulerAngles;
+        record.useEulerStorage = entity->EntityTransform.useEulerStorage ? 1 : 0;
+
+        if (auto cube = entity->GetComponent<CubeComponent>())
+        {
+            record.componentType = LevelComponentType::Cube;
+            record.size = cube->size;
+            record.color = cube->color;
+            record.flags = cube->occluder ? LEVEL_ENTITY_OCCLUDER : 0;
+        }
+        else if (auto sphere = entity->GetComponent<SphereComponent>())
+        {
+            record.componentType = LevelComponentType::Sphere;
+            record.radius = sphere->radius;
+            record.color = sphere->color;
+        }
+        else if (auto model = entity->GetComponent<ModelComponent>())
+        {
+            record.componentType = LevelComponentType::Model;
+            if (model->HasFilePath())
+                record.modelPathIndex = strings.Add(model->filePathId);
+            record.flags = model->occluder ? LEVEL_ENTITY_OCCLUDER : 0;
+        }
+
+        level.entities.push_back(record);
+    }
+
+    level.bounds = ComputeLevelBounds(level.entities);
+    return level;
+}
+
+void CreateEntities(const LevelData &level, std::vector<GameEntity *> &entities)
+{
+    size_t first = entities.size();
+    entities.resize(first + level.entities.size());
+    EntityMemory::BeginLevelArena();
+    CreateEntityRange(level, InternStrings(level), 0, level.entities.size(), entities, first);
+    EntityMemory::EndLevelArena();
+}
+
+BoundingBox GetRecordBounds(const LevelEntityRecord &record)
+{
+    Vector3 halfExtents = {0, 0, 0};
+
+    switch (record.componentType)
+    {
+    case LevelComponentType::Cube:
+        halfExtents = Vector3Scale(Vector3Multiply(record.size, record.scale), 0.5f);
+        break;
+    case LevelComponentType::Sphere:
+        // Drawn through the scale matrix, so it's really an ellipsoid
+        halfExtents = Vector3Scale(record.scale, record.radius);
+        break;
+    default:
+        // Models need their mesh for real bounds, the position is the best we can do without loading it
+        break;
+    }
+
+    return OrientedBox::FromRotation(record.position, record.rotation, halfExtents).GetBoundingBox();
+}
+
+BoundingBox ComputeLevelBounds(const std::vector<LevelEntityRecord> &records)
+{
+    if (records.empty())
+        return {{0, 0, 0}, {0, 0, 0}};
+
+    BoundingBox bounds = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+    for (const auto &record : records)
+    {
+        BoundingBox recordBounds = GetRecordBounds(record);
+        bounds.min = Vector3Min(bounds.min, recordBounds.min);
+        bounds.max = Vector3Max(bounds.max, recordBounds.max);
+    }
+    return bounds;
+}
+
+bool SaveLevel(const std::string &path, const std::vector<GameEntity *> &entities)
+{
+    PROFILE_SCOPE("SaveLevel");
+
+    if (!WriteLevelFile(path, BuildLevelData(entities)))
+        return false;
+
+    DebugPrint("Saved level:", path, static_cast<int>(entities.size()), "entities");
     return true;
 }
 
-void LoadLevel()
+bool LoadLevel(const std::string &path, std::vector<GameEntity *> &entities, LevelLoadStats *stats)
 {
-}
\ No newline at end of file
+    PROFILE_SCOPE("LoadLevel");
+    auto start = std::chrono::steady_clock::now();
+
+    LevelLoadStats localStats;
+    LevelLoadStats &out = stats ? *stats : localStats;
+    out = {};
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        DebugError("Could not open level file:", path);
+        return false;
+    }
+
+    // Everything that gets sized from the file happens up here, before any thread is running. The prelude checks the
+    // counts against the file size, the catch is for when the machine really is out of memory
+    LevelData level;
+    uint32_t entityCount;
+    std::vector<uint32_t> modelPaths;
+    std::vector<StringId> stringIds;
+    size_t firstEntity = entities.size();
+    try
+    {
+        if (!ReadLevelPrelude(file, path, level, entityCount, modelPaths))
+            return false;
+        stringIds = InternStrings(level);
+        level.entities.resize(entityCount);
+        entities.resize(firstEntity + entityCount, nullptr);
+    }
+    catch (const std::bad_alloc &)
+    {
+        DebugError("Out of memory loading level:", path);
+        entities.resize(firstEntity);
+        return false;
+    }
+    out.headerMs = MsSince(start);
+
+    // Model files on the side, they're needed once everything is loaded and reading them doesn't depend on any record
+    std::vector<std::string> prefetchPaths;
+    for (uint32_t index : modelPaths)
+    {
+        if (const std::string *modelPath = GetString(level, index))
+            prefetchPaths.push_back(*modelPath);
+    }
+    out.models = prefetchPaths.size();
+    auto prefetch = [&]()
+    {
+        auto prefetchStart = std::chrono::steady_clock::now();
+        out.prefetchBytes = AssetPrefetch::Prefetch(prefetchPaths);
+        out.prefetchMs = MsSince(prefetchStart);
+    };
+    std::thread prefetcher(prefetch);
+
+    // Records come in chunk by chunk on the reader thread, chunksRead only ever goes up
+    size_t chunkCount = (entityCount + LEVEL_LOAD_CHUNK_ENTITIES - 1) / LEVEL_LOAD_CHUNK_ENTITIES;
+    std::mutex chunkMutex;
+    std::condition_variable chunkReady;
+    size_t chunksRead = 0;
+    bool readFailed = false;
+
+    auto readChunks = [&]()
+    {
+        PROFILE_SCOPE("LoadLevel Read");
+        auto readStart = std::chrono::steady_clock::now();
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            size_t first = chunk * LEVEL_LOAD_CHUNK_ENTITIES;
+            size_t count = std::min<size_t>(LEVEL_LOAD_CHUNK_ENTITIES, entityCount - first);
+            bool ok = static_cast<bool>(file.read(reinterpret_cast<char *>(&level.entities[first]), count * sizeof(LevelEntityRecord)));
+            {
+                std::lock_guard<std::mutex> lock(chunkMutex);
+                if (ok)
+                    ++chunksRead;
+                else
+                    readFailed = true;
+            }
+            chunkReady.notify_one();
+            if (!ok)
+                break;
+        }
+        out.readMs = MsSince(readStart);
+    };
+    std::thread reader(readChunks);
+
+    // Build the entities of a chunk on the jobs while the reader is already on the next one
+    size_t created = 0;
+    {
+        PROFILE_SCOPE("LoadLevel Decode");
+        auto decodeStart = std::chrono::steady_clock::now();
+        // All of it goes in the level arena, the entities of one type end up packed together and unloading is cheap
+        EntityMemory::BeginLevelArena();
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            {
+                std::unique_lock<std::mutex> lock(chunkMutex);
+                chunkReady.wait(lock, [&]()
+                                { return chunksRead > chunk || readFailed; });
+                if (chunksRead <= chunk)
+                    break;
+            }
+
+            size_t first = chunk * LEVEL_LOAD_CHUNK_ENTITIES;
+            size_t end = std::min<size_t>(first + LEVEL_LOAD_CHUNK_ENTITIES, entityCount);
+            CreateEntityRange(level, stringIds, first, end, entities, firstEntity + first);
+            created = end;
+        }
+        EntityMemory::EndLevelArena();
+        out.decodeMs = MsSince(decodeStart);
+    }
+
+    reader.join();
+    prefetcher.join();
+
+    if (created < entityCount)
+    {
+        DebugError("Level file entities are truncated:", path);
+        for (size_t i = firstEntity; i < firstEntity + created; ++i)
+            delete entities[i];
+        entities.resize(firstEntity);
+        AssetPrefetch::Clear();
+        return false;
+    }
+
+    out.entities = entityCount;
+    out.chunks = chunkCount;
+    out.totalMs = MsSince(start);
+
+    DebugPrint("Loaded level:", path, static_cast<int>(entityCount), "entities");
+    return true;
+}
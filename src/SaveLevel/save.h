@@ -1,6 +1,108 @@
 #pragma once
 #include <vector>
+#include <string>
+#include <cstdint>
 #include "../typedef.h"
+#include "../LevelEditor/gameEntity.h"
 
-bool SaveLevel();
-void LoadLevel();
\ No newline at end of file
+// Level file layout (little endian, written straight from the structs below):
+//   LevelFileHeader
+//   stringCount x (uint32 length + bytes)   -> the StringPool entries the level uses (names, model paths), by index
+//   uint32 modelCount + modelCount x uint32 -> string index of every model path used, version 2+
+//   entityCount x LevelEntityRecord
+// Records are fixed size on purpose, so tools can chew through them without building any GameEntities,
+// and loading can read them in chunks and build entities out of one chunk while the next one is still coming in.
+// The model table is there so loading can start reading the model files before it got to a single record.
+
+constexpr char LEVEL_FILE_MAGIC[4] = {'L', 'V', 'L', 'F'};
+constexpr uint32_t LEVEL_FILE_VERSION = 2;
+constexpr uint32_t LEVEL_NO_STRING = 0xFFFFFFFF;
+// Records per read when loading, the entities of one chunk get built while the next one is read
+constexpr size_t LEVEL_LOAD_CHUNK_ENTITIES = 16384;
+
+enum class LevelComponentType : uint8_t
+{
+    None,
+    Cube,
+    Sphere,
+    Model,
+};
+
+// LevelEntityRecord::flags, used to be padding so older files just read as 0
+constexpr uint8_t LEVEL_ENTITY_OCCLUDER = 1 << 0;
+
+struct LevelFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entityCount;
+    uint32_t stringCount;
+    BoundingBox bounds;
+};
+
+struct LevelEntityRecord
+{
+    uint32_t nameIndex = LEVEL_NO_STRING;
+    Vector3 position = {0, 0, 0};
+    Quaternion rotation = {0, 0, 0, 1};
+    Vector3 scale = {1, 1, 1};
+    Vector3 eulerAngles = {0, 0, 0};
+    uint8_t useEulerStorage = 1;
+    LevelComponentType componentType = LevelComponentType::None;
+    uint8_t flags = 0;
+    uint8_t padding = 0;
+
+    // Only the fields for componentType mean anything
+    Vector3 size = {1, 1, 1};
+    float radius = 1.0f;
+    Color color = GRAY;
+    uint32_t modelPathIndex = LEVEL_NO_STRING;
+};
+
+// Written as raw bytes, so changing this means bumping LEVEL_FILE_VERSION
+static_assert(sizeof(LevelEntityRecord) == 84, "LevelEntityRecord layout changed");
+
+// Whole level in file form, what the save/load functions and the batch tools pass around
+struct LevelData
+{
+    uint32_t version = LEVEL_FILE_VERSION;
+    BoundingBox bounds = {{0, 0, 0}, {0, 0, 0}};
+    std::vector<std::string> strings;
+    std::vector<LevelEntityRecord> entities;
+};
+
+bool WriteLevelFile(const std::string &path, const LevelData &level);
+bool ReadLevelFile(const std::string &path, LevelData &level);
+
+LevelData BuildLevelData(const std::vector<GameEntity *> &entities);
+// Appends the entities to the vector, the caller owns them. Built in parallel on the JobSystem
+void CreateEntities(const LevelData &level, std::vector<GameEntity *> &entities);
+
+// World space AABB of a single record, tight around the rotated shape
+BoundingBox GetRecordBounds(const LevelEntityRecord &record);
+BoundingBox ComputeLevelBounds(const std::vector<LevelEntityRecord> &records);
+
+// Wall times of the LoadLevel stages. They overlap (reading, building entities and reading model files all run at
+// once) so they don't add up to totalMs
+struct LevelLoadStats
+{
+    size_t entities = 0;
+    size_t chunks = 0;
+    size_t models = 0;
+    size_t prefetchBytes = 0;
+    // Header, strings and the model table
+    double headerMs = 0.0;
+    double readMs = 0.0;
+    // Building the entities, includes waiting on chunks that weren't read yet
+    double decodeMs = 0.0;
+    double prefetchMs = 0.0;
+    // Until LoadLevel returns
+    double totalMs = 0.0;
+    // Left to the caller, uploading the models needs the GL context (ModelCache::ResolveAll in the editor)
+    double uploadMs = 0.0;
+};
+
+bool SaveLevel(const std::string &path, const std::vector<GameEntity *> &entities);
+// Appends the loaded entities, clear out the old ones first if you want to replace the level.
+// Model files referenced by the level get read into AssetPrefetch on the side
+bool LoadLevel(const std::string &path, std::vector<GameEntity *> &entities, LevelLoadStats *stats = nullptr);
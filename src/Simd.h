@@ -0,0 +1,13 @@
+#pragma once
+
+// x64 always has SSE2, 32 bit MSVC only with /arch:SSE2. Everything else (ARM) takes the scalar paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDITOR_SSE2
+#include <emmintrin.h>
+#endif
+
+// Only when the compiler is told it can use it (-mavx, /arch:AVX), there's no runtime dispatch
+#if defined(EDITOR_SSE2) && defined(__AVX__)
+#define EDITOR_AVX
+#include <immintrin.h>
+#endif
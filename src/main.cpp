@@ -2,73 +2,118 @@
 #include <rlgl.h>
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string>
 
 #include "typedef.h"
-#include "EngineInputs\inputs.h"
-#include "EngineInputs\Gizmos\GizmoController.h"
+#include "EngineInputs/inputs.h"
+#include "EngineInputs/InputState.h"
+#include "EngineInputs/ActionMap.h"
+#include "EngineInputs/Gizmos/GizmoController.h"
+#include "EngineInputs/Profiling/TraceCaptureController.h"
 #include "LevelEditor/objectsUI.h"
 #include "LevelEditor/gameEntity.h"
+#include "LevelEditor/Picking.h"
 #include "SaveLevel/save.h"
 #include "../imgui/imgui.h"
+#include "../imgui/imgui_internal.h"
 #include "../imgui/rlImGui.h"
+#include "../imgui/imgui_impl_raylib.h"
 #include "../imgui/rlImGuiColors.h"
 #include "../imgui/imguiStyle.h"
 #include "Rendering/Renderer.h"
+#include "Rendering/ModelCache.h"
+#include "Rendering/FrameScheduler.h"
+#include "Rendering/FrameStatsUI.h"
+#include "Rendering/SceneViewport.h"
+#include "Rendering/OcclusionCuller.h"
+#include "Rendering/IdPicker.h"
+#include "Rendering/DrawList.h"
+#include "Rendering/UiBenchmark.h"
+#include "Rendering/ThumbnailCache.h"
+#include "Jobs/JobSystem.h"
 #include "Logging/Logger.h"
 #include "Logging/ConsoleUI.h"
+#include "Profiling/Profiler.h"
+#include "Profiling/ProfilerUI.h"
+#include "Profiling/TraceCapture.h"
 #include <raymath.h>
 
-// Link incase I forget how it works
-// https://www.raylib.com/examples/shaders/loader.html?name=shaders_write_depth
-static RenderTexture2D LoadRenderTextureDepthTex(int width, int height)
+// rlImGuiBegin reads the real mouse, so replays feed ImGui the recorded one instead.
+// Keyboard and text input don't go to ImGui in a replay, typing into fields isn't reproduced.
+static void BeginImGuiReplayFrame()
 {
-    RenderTexture2D target = {0};
-    target.id = rlLoadFramebuffer();
-    if (target.id > 0)
-    {
-        rlEnableFramebuffer(target.id);
-
-        target.texture.id = rlLoadTexture(0, width, height, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
-        target.texture.width = width;
-        target.texture.height = height;
-        target.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
-        target.texture.mipmaps = 1;
-
-        target.depth.id = rlLoadTextureDepth(width, height, false);
-        target.depth.width = width;
-        target.depth.height = height;
-        target.depth.format = 19;
-        target.depth.mipmaps = 1;
+    ImGui_ImplRaylib_NewFrame();
 
-        rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0, RL_ATTACHMENT_TEXTURE2D, 0);
-        rlFramebufferAttach(target.id, target.depth.id, RL_ATTACHMENT_DEPTH, RL_ATTACHMENT_TEXTURE2D, 0);
-
-        if (rlFramebufferComplete(target.id))
-            TRACELOG(LOG_INFO, "FBO: [ID %i] Framebuffer object created successfully", target.id);
+    ImGuiIO &io = ImGui::GetIO();
+    const InputFrame &frame = InputState::GetFrame();
+    io.AddMousePosEvent(frame.mousePosition.x, frame.mousePosition.y);
 
-        rlDisableFramebuffer();
+    const int buttons[] = {MOUSE_BUTTON_LEFT, MOUSE_BUTTON_RIGHT, MOUSE_BUTTON_MIDDLE};
+    for (int button : buttons)
+    {
+        if (InputState::IsMouseButtonPressed(button))
+            io.AddMouseButtonEvent(button, true);
+        else if (InputState::IsMouseButtonReleased(button))
+            io.AddMouseButtonEvent(button, false);
     }
-    else
-        TRACELOG(LOG_WARNING, "FBO: Framebuffer object can not be created");
+    io.AddMouseWheelEvent(frame.mouseWheel.x, frame.mouseWheel.y);
 
-    return target;
+    ImGui::NewFrame();
 }
 
-static void UnloadRenderTextureDepthTex(RenderTexture2D target)
+static void ReportReplayFrameTimes(std::vector<double> frameTimes)
 {
-    if (target.id > 0)
+    if (frameTimes.empty())
+        return;
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&](double p)
     {
-        rlUnloadTexture(target.texture.id);
-        rlUnloadTexture(target.depth.id);
-        rlUnloadFramebuffer(target.id);
-    }
+        size_t index = static_cast<size_t>(p * (frameTimes.size() - 1) + 0.5);
+        return frameTimes[index];
+    };
+
+    double total = 0.0;
+    for (double time : frameTimes)
+        total += time;
+
+    std::cout << "Replay: " << frameTimes.size() << " frames, avg " << total / frameTimes.size() << " ms, p50 " << percentile(0.5)
+              << " ms, p90 " << percentile(0.9) << " ms, p99 " << percentile(0.99) << " ms, max " << frameTimes.back() << " ms\n";
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    const char *LEVEL_PATH = "Levels/level.lvl";
+    const char *BINDINGS_PATH = "bindings.cfg";
+    const char *THUMBNAIL_ATLAS_PATH = "thumbnails.atlas";
     const int screenWidth = 1920;
     const int screenHeight = 1080;
 
+    // --record starts recording input right away, --replay plays a recording back as fast as possible and quits,
+    // --ui-bench draws a big synthetic UI for that many frames with both ImGui backends and quits
+    std::string recordPath;
+    std::string replayPath;
+    int uiBenchFrames = 0;
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--record")
+            recordPath = argv[++i];
+        else if (std::string(argv[i]) == "--replay")
+            replayPath = argv[++i];
+        else if (std::string(argv[i]) == "--ui-bench")
+            uiBenchFrames = std::max(1, std::atoi(argv[++i]));
+    }
+
+    // The console keeps a lot more history than the headless tools need
+    SetLogCapacity(EDITOR_LOG_ENTRIES);
+
+    SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(screenWidth, screenHeight, "3D Game raylib");
 
     rlImGuiSetup(true);
@@ -76,6 +121,14 @@ int main()
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
     SetCustomImGuiStyle();
 
+    if (uiBenchFrames > 0)
+    {
+        RunUiBenchmark(uiBenchFrames);
+        rlImGuiShutdown();
+        CloseWindow();
+        return 0;
+    }
+
     Camera3D camera = {0};
     camera.position = Vector3{10.0f, 10.0f, 10.0f};
     camera.target = Vector3{0.0f, 0.0f, 0.0f};
@@ -83,8 +136,6 @@ int main()
     camera.fovy = 45.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    RayCollision collision = {0};
-
     std::vector<GameEntity *> entities;
     GameEntity *selectedEntity = nullptr;
 
@@ -92,48 +143,178 @@ int main()
 
     InputSystem inputSystem;
     GizmoController gizmoController(gizmoSystem);
+    TraceCaptureController traceCaptureController;
 
-    // Register controller as observer
-    inputSystem.RegisterObserver(&gizmoController);
+    // Shortcuts come from bindings.cfg next to the exe, the defaults in ActionMap are used when it's missing
+    ActionMap actionMap;
+    if (!actionMap.LoadBindings(BINDINGS_PATH))
+        DebugPrint("No", BINDINGS_PATH, "found, using the default shortcuts");
+    actionMap.Attach(inputSystem);
 
-    RenderTexture2D sceneTarget = LoadRenderTextureDepthTex(screenWidth, screenHeight);
+    // Register controller as observer, only for the actions they actually handle
+    actionMap.Subscribe(&gizmoController, {InputAction::GizmoNone, InputAction::GizmoPosition, InputAction::GizmoRotation, InputAction::GizmoScale});
+    actionMap.Subscribe(&traceCaptureController, {InputAction::ToggleTraceCapture});
 
-    SetTargetFPS(60);
+    // One thread per core for the per-entity loops (draw list, culling), the main thread counts as one of them
+    JobSystem::Init();
+
+    // Owns a worker thread, lives as long as the window
+    OcclusionCuller occlusionCuller;
+    DrawList drawList;
+
+    IdPicker idPicker;
+    idPicker.Load();
+
+    // Model file thumbnails for the file dialog, kept between sessions in the atlas file next to the exe
+    ThumbnailCache::Load(THUMBNAIL_ATLAS_PATH);
+
+    // Starts out as the whole window, after the first ImGui frame it follows the middle of the dockspace
+    SceneViewport sceneViewport;
+    sceneViewport.SetRect({0, 0, (float)screenWidth, (float)screenHeight});
+
+    // LoadLevel reads, builds the entities and reads the model files all at once, the GPU upload has to happen here after.
+    // Total is how long until the level is on screen without anything left to load
+    auto loadLevel = [&](const std::string &path)
+    {
+        LevelLoadStats stats;
+        if (!LoadLevel(path, entities, &stats))
+            return;
+
+        auto uploadStart = std::chrono::steady_clock::now();
+        ModelCache::ResolveAll(entities);
+        stats.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+
+        DebugPrint("Level ready in", stats.totalMs + stats.uploadMs, "ms: read", stats.readMs, "ms, build", stats.decodeMs, "ms,",
+                   static_cast<int>(stats.models), "models prefetched in", stats.prefetchMs, "ms, upload", stats.uploadMs, "ms");
+    };
+
+    // A recording starts from a saved copy of the scene (same name, .lvl), otherwise the replay would click on different things
+    auto startRecording = [&](const std::string &path)
+    {
+        selectedEntity = nullptr;
+        gizmoSystem.Deactivate();
+        SaveLevel(std::filesystem::path(path).replace_extension(".lvl").string(), entities);
+
+        if (inputSystem.StartRecording(path))
+            DebugPrint("Input recording started:", path);
+    };
+
+    if (!replayPath.empty())
+    {
+        std::string levelPath = std::filesystem::path(replayPath).replace_extension(".lvl").string();
+        if (std::filesystem::exists(levelPath))
+            loadLevel(levelPath);
+
+        if (!inputSystem.StartReplay(replayPath))
+            std::cerr << "Could not open input recording: " << replayPath << "\n";
+    }
+    else if (!recordPath.empty())
+    {
+        startRecording(recordPath);
+    }
+
+    std::vector<double> replayFrameTimes;
+    // Uncapped while replaying, the whole point is measuring how long frames take
+    FrameScheduler::SetMode(inputSystem.IsReplaying() ? FrameMode::Uncapped : FrameMode::Adaptive);
 
     while (!WindowShouldClose())
     {
+        PROFILE_BEGIN_FRAME();
+        auto frameStart = std::chrono::steady_clock::now();
+
+        FrameScheduler::BeginFrame();
+        inputSystem.BeginFrame();
+        if (inputSystem.IsReplayFinished())
+            break;
+        FrameScheduler::MarkInput(InputState::GetFrame(), InputState::GetPreviousFrame());
 
-        if (IsKeyPressed(KEY_F5))
         {
-            // Need to implement the new Save function with the GameEntities, but lazy atm
+            PROFILE_SCOPE("Input");
+            Camera3D previousCamera = camera;
+
+            // Simulate a godot cam and make it much easier for me to move objects
+            if (inputSystem.IsReplaying())
+                camera = InputState::GetFrame().camera;
+            else if (InputState::IsMouseButtonDown(MOUSE_BUTTON_RIGHT) && !io.WantCaptureMouse)
+            {
+                UpdateCamera(&camera, CAMERA_FREE);
+                DisableCursor();
+            }
+            else if (IsCursorHidden())
+                EnableCursor();
+
+            // Keys go to the fly camera or the text field then, but the key state still has to keep up
+            inputSystem.CheckInputs(!io.WantTextInput && !InputState::IsMouseButtonDown(MOUSE_BUTTON_RIGHT));
+
+            inputSystem.EndFrame(camera);
+
+            if (std::memcmp(&previousCamera, &camera, sizeof(Camera3D)) != 0)
+                FrameScheduler::MarkDirty(DIRTY_CAMERA);
+            // Blinking text cursor
+            if (io.WantTextInput)
+                FrameScheduler::MarkDirty(DIRTY_ANIMATION);
+#ifdef PROFILER_ENABLED
+            // Keep frames coming while capturing, a trace of one frame every few seconds isn't much use
+            if (TraceCapture::IsCapturing())
+                FrameScheduler::MarkDirty(DIRTY_ANIMATION);
+#endif
         }
-        if (IsKeyPressed(KEY_F6))
+
+        // Actions fire during CheckInputs above, so these go after it
+        if (actionMap.ConsumeTriggered(InputAction::SaveLevel))
         {
-            // Need to implement the new Load function with the GameEntities, but lazy atm
+            SaveLevel(LEVEL_PATH, entities);
         }
-
-        // Simulate a godot cam and make it much easier for me to move objects
-        if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT) && !io.WantCaptureMouse)
+        if (actionMap.ConsumeTriggered(InputAction::LoadLevel))
         {
-            UpdateCamera(&camera, CAMERA_FREE);
-            DisableCursor();
+            // Replace the current level, gizmo still points at the old transforms so drop that too
+            selectedEntity = nullptr;
+            gizmoSystem.Deactivate();
+            for (auto entity : entities)
+                delete entity;
+            entities.clear();
+            // Everything from the last load is gone now, its arena pages can go in one go
+            EntityMemory::ReleaseLevelArena();
+
+            loadLevel(LEVEL_PATH);
+            FrameScheduler::MarkDirty(DIRTY_ENTITY);
         }
-        else if (IsCursorHidden())
-            EnableCursor();
-
-        if (!io.WantTextInput && !IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+        if (actionMap.ConsumeTriggered(InputAction::ToggleInputRecording) && !inputSystem.IsReplaying())
         {
-            inputSystem.CheckInputs();
+            if (inputSystem.IsRecording())
+            {
+                inputSystem.StopRecording();
+                DebugPrint("Input recording saved:", inputSystem.GetRecorder().GetPath(), static_cast<int>(inputSystem.GetRecorder().GetFrameCount()), "frames");
+            }
+            else
+            {
+                std::error_code error;
+                std::filesystem::create_directories("Captures", error);
+
+                char fileName[64];
+                std::time_t now = std::time(nullptr);
+                std::strftime(fileName, sizeof(fileName), "Captures/input_%Y%m%d_%H%M%S.rec", std::localtime(&now));
+                startRecording(fileName);
+            }
         }
 
         bool isMouseOverImGui = ImGui::GetIO().WantCaptureMouse;
-        Ray mouseRay = GetScreenToWorldRay(GetMousePosition(), camera);
+        Ray mouseRay = sceneViewport.GetMouseRay(InputState::GetMousePosition(), camera);
+
+        // ID buffer picks come back the frame after the click
+        GameEntity *idPicked = nullptr;
+        if (idPicker.Poll(entities, &idPicked) && idPicked != selectedEntity)
+        {
+            selectedEntity = idPicked;
+            FrameScheduler::MarkDirty(DIRTY_ENTITY);
+        }
 
-        // TODO: Also extract this bit into a separate script for the same reason as renderer
-        if (!isMouseOverImGui && !IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
+        if (!isMouseOverImGui && !InputState::IsMouseButtonDown(MOUSE_BUTTON_RIGHT))
         {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
+            if (InputState::IsMouseButtonPressed(MOUSE_BUTTON_LEFT))
             {
+                PROFILE_SCOPE("Picking");
+
                 // Check if we clicked on a gizmo first
                 bool clickedOnGizmo = false;
                 if (selectedEntity)
@@ -141,95 +322,140 @@ int main()
 
                 if (!clickedOnGizmo)
                 {
-                    selectedEntity = nullptr;
-                    for (auto entity : entities)
-                    {
-
-                        if (auto cube = entity->GetComponent<CubeComponent>())
-                        {
-                            BoundingBox box = cube->GetBoundingBox();
-                            collision = GetRayCollisionBox(mouseRay, box);
-                        }
-                        else if (auto sphere = entity->GetComponent<SphereComponent>())
-                        {
-                            float scaledRadius = sphere->GetScaledRadius();
-                            collision = GetRayCollisionSphere(mouseRay, entity->EntityTransform.position, scaledRadius);
-                        }
-                        if (auto model = entity->GetComponent<ModelComponent>())
-                        {
-                            Matrix transform = entity->EntityTransform.GetTransformMatrix();
-                            collision = GetRayCollisionMesh(mouseRay, model->model.meshes[0], transform);
-                        }
-
-                        else
-                            continue;
-
-                        if (collision.hit)
-                        {
-                            selectedEntity = entity;
-                            break;
-                        }
-                    }
+                    if (idPicker.mode == PickingMode::IdBuffer)
+                        idPicker.Request(entities, camera, sceneViewport, InputState::GetMousePosition());
+                    else
+                        selectedEntity = Picking::PickEntity(entities, mouseRay);
                 }
             }
         }
 
         if (selectedEntity)
         {
+            PROFILE_SCOPE("Gizmo Update");
             // Draw gizmos here, so it is synced to the object you're dragging, might change this to just update gizmos and render them below
             ObjectUI::UpdateAndRenderGizmos(camera, selectedEntity, mouseRay, gizmoSystem);
         }
 
-        BeginTextureMode(sceneTarget);
+        // Occlusion culling runs on its own thread while the ImGui frame gets built, the scene is drawn after that.
+        // Nothing in the scene changed = the texture still has last frame's picture, no need to cull or draw.
+        // Gizmo is drawn in there too, so hovering it needs a redraw while something is selected
+        auto sceneNeedsRender = [&]()
+        { return FrameScheduler::ShouldRenderScene() || (selectedEntity && (FrameScheduler::GetFrameReasons() & DIRTY_MOUSE_MOVE)); };
+
+        auto sceneAspect = [&]()
+        { return (float)sceneViewport.GetTargetWidth() / std::max(1, sceneViewport.GetTargetHeight()); };
+
+        if (sceneNeedsRender())
+            occlusionCuller.Kick(entities, camera, sceneAspect());
+
+        {
+            PROFILE_SCOPE("ImGui Submit");
+            if (inputSystem.IsReplaying())
+                BeginImGuiReplayFrame();
+            else
+                rlImGuiBegin();
+
+            // Scene shows through the middle of the dockspace, docking windows to the sides shrinks it
+            ImGuiID dockspaceId = ImGui::DockSpaceOverViewport(0, nullptr, ImGuiDockNodeFlags_PassthruCentralNode);
+            if (ImGuiDockNode *centralNode = ImGui::DockBuilderGetCentralNode(dockspaceId))
+                sceneViewport.SetRect({centralNode->Pos.x, centralNode->Pos.y, centralNode->Size.x, centralNode->Size.y});
+
+            ObjectUI::RenderGeneralUI(&selectedEntity, entities, gizmoSystem);
+            // Test Print
+            // DebugPrint("Test", selectedEntity);
+            // DebugWarn("Test", selectedEntity);
+            // DebugPrint(selectedEntity, "Test");
+            // DebugWarn(selectedEntity, "Test");
+            // DebugPrint(1);
+
+            RenderConsoleUI(logBuffer);
+            RenderProfilerUI();
+            RenderFrameStatsUI(sceneViewport, occlusionCuller, drawList, idPicker);
+        }
+
+        // Renders into its own target, has to happen outside of the scene and BeginDrawing
+        ThumbnailCache::Update();
+
+        bool targetRecreated = sceneViewport.UpdateResolution(FrameScheduler::GetLastFrameMs());
+        if (targetRecreated)
+            FrameScheduler::MarkDirty(DIRTY_WINDOW);
+
+        // Checked again, the UI can mark things dirty too (loading a model, ticking a checkbox)
+        if (sceneNeedsRender())
         {
+            PROFILE_SCOPE("Scene Render");
+            // Culled with the old aspect ratio when the target just changed size, safer to draw everything for a frame
+            const std::vector<uint8_t> *visible = occlusionCuller.Wait(entities);
+            if (targetRecreated)
+                visible = nullptr;
+
+            // Transforms, bounds and the draw list go wide on the job system, only the GL calls below stay on this thread
+            drawList.Build(entities, camera, sceneAspect(), selectedEntity, visible);
+
+            sceneViewport.BeginScene();
             ClearBackground(RAYWHITE);
 
             BeginMode3D(camera);
             {
                 DrawGrid(50, 1.0f);
                 // Render components separately, as with many components this can bloat the file a lot
-                Renderer::RenderComponents(entities, selectedEntity);
+                Renderer::RenderComponents(drawList);
+
+                rlDrawRenderBatchActive();
+                rlDisableDepthTest();
+                if (selectedEntity)
+                {
+                    // Draw gizmos again, as otherwise they won't be on top
+                    ObjectUI::UpdateAndRenderGizmos(camera, selectedEntity, mouseRay, gizmoSystem);
+                }
+                rlDrawRenderBatchActive();
+                rlEnableDepthTest();
             }
             EndMode3D();
+            sceneViewport.EndScene();
+            FrameScheduler::NotifySceneRendered();
         }
-        EndTextureMode();
 
         BeginDrawing();
         {
             ClearBackground(RAYWHITE);
 
-            DrawTextureRec(
-                sceneTarget.texture,
-                Rectangle{0, 0, (float)screenWidth, (float)-screenHeight}, // Flip Y
-                Vector2{0, 0},
-                WHITE);
+            sceneViewport.Draw();
 
-            BeginMode3D(camera);
-            rlDisableDepthTest();
-            if (selectedEntity)
             {
-                // Draw gizmos again, as otherwise they won't be on top
-                ObjectUI::UpdateAndRenderGizmos(camera, selectedEntity, mouseRay, gizmoSystem);
+                PROFILE_SCOPE("ImGui Render");
+                rlImGuiEnd();
             }
-            rlEnableDepthTest();
-            EndMode3D();
+        }
+        {
+            // Includes waiting on the frame cap (or for input when idle), so don't panic when this one is big
+            PROFILE_SCOPE("EndDrawing");
+            FrameScheduler::Present();
+        }
 
-            rlImGuiBegin();
-            ObjectUI::RenderGeneralUI(&selectedEntity, entities, gizmoSystem);
-            // Test Print
-            // DebugPrint("Test", selectedEntity);
-            // DebugWarn("Test", selectedEntity);
-            // DebugPrint(selectedEntity, "Test");
-            // DebugWarn(selectedEntity, "Test");
-            // DebugPrint(1);
+        if (inputSystem.IsReplaying())
+            replayFrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
 
-            RenderConsoleUI(logBuffer);
-            rlImGuiEnd();
-        }
-        EndDrawing();
+        PROFILE_END_FRAME();
     }
 
+    ReportReplayFrameTimes(replayFrameTimes);
+    inputSystem.StopRecording();
+
+#ifdef PROFILER_ENABLED
+    // Don't leave a half written trace behind when closing mid capture
+    TraceCapture::Stop();
+#endif
+
+    // Worker might still be reading meshes from the last kick
+    occlusionCuller.Wait(entities);
+    JobSystem::Shutdown();
+    // Entities only point into the cache, so this is the one place models get unloaded
+    ModelCache::UnloadAll();
     rlImGuiShutdown();
-    UnloadRenderTextureDepthTex(sceneTarget);
+    idPicker.Unload();
+    ThumbnailCache::Unload();
+    sceneViewport.Unload();
     CloseWindow();
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+// Batch level processor, runs passes over level files without the editor (nightly re-saves, cleanups, stats).
+//
+//   level_tool [--passes validate,compact-strings,bounds] [--threads N] [--out dir] [--dry-run] [--force] <files or folders...>
+//
+// Folders are searched recursively for .lvl files. Files are written back in place (or into --out, keeping their path
+// below the folder they were found in) with the current format version (through a .tmp file that replaces the original
+// once it is complete), but only when a pass changed something, the file was an older version, or --force is given.
+// A file with validation errors is never written.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Logging/Logger.h"
+#include "SaveLevel/LevelPasses.h"
+#include "SaveLevel/save.h"
+
+namespace fs = std::filesystem;
+
+struct ToolConfig
+{
+    std::vector<const LevelPass *> passes;
+    unsigned threads = 0; // 0 = one per core
+    std::string outDir;
+    bool dryRun = false;
+    bool force = false;
+};
+
+struct FileResult
+{
+    std::string path;
+    std::string outPath;
+    bool ok = false;
+    bool written = false;
+    size_t entities = 0;
+    uintmax_t bytesIn = 0;
+    double readMs = 0.0;
+    double passMs = 0.0;
+    double writeMs = 0.0;
+    LevelPassReport report;
+};
+
+static double MsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void ProcessFile(const ToolConfig &config, FileResult &result)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    LevelData level;
+    std::error_code error;
+    result.bytesIn = fs::file_size(result.path, error);
+    if (error || !ReadLevelFile(result.path, level))
+    {
+        result.report.errors.push_back("could not read level file");
+        return;
+    }
+    result.entities = level.entities.size();
+    result.readMs = MsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (const LevelPass *pass : config.passes)
+    {
+        pass->run(level, result.report);
+
+        // No point running the rest over a broken level
+        if (!result.report.errors.empty())
+        {
+            result.passMs = MsSince(start);
+            return;
+        }
+    }
+    result.passMs = MsSince(start);
+    result.ok = true;
+
+    bool upgrade = level.version != LEVEL_FILE_VERSION;
+    if (config.dryRun || !(result.report.modified || upgrade || config.force))
+        return;
+
+    start = std::chrono::steady_clock::now();
+    const std::string &outPath = result.outPath;
+    if (!config.outDir.empty())
+        fs::create_directories(fs::path(outPath).parent_path(), error);
+
+    // Written next to it and moved over it once it's all there, a crash or a full disk halfway leaves the old file alone
+    level.version = LEVEL_FILE_VERSION;
+    std::string tempPath = outPath + ".tmp";
+    if (!WriteLevelFile(tempPath, level))
+    {
+        result.report.errors.push_back("could not write " + tempPath);
+        result.ok = false;
+        // Whatever made it into the file before it failed
+        if (fs::is_regular_file(tempPath, error))
+            fs::remove(tempPath, error);
+    }
+    else
+    {
+        fs::rename(tempPath, outPath, error);
+        if (error)
+        {
+            result.report.errors.push_back("could not replace " + outPath + ": " + error.message());
+            result.ok = false;
+            fs::remove(tempPath, error);
+        }
+    }
+    result.written = result.ok;
+    result.writeMs = MsSince(start);
+}
+
+// Fixed set of workers pulling the next file off a shared counter, files take wildly different times so
+// handing them out one by one balances better than splitting the list up front
+static void ProcessFiles(const ToolConfig &config, std::vector<FileResult> &results)
+{
+    unsigned threadCount = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(results.size()));
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]()
+    {
+        for (size_t i = next.fetch_add(1); i < results.size(); i = next.fetch_add(1))
+        {
+            // The reader and the passes say what exactly is wrong through DebugError, that goes in with the file's errors
+            std::vector<LogEntry> log;
+            threadLogCapture = &log;
+            ProcessFile(config, results[i]);
+            threadLogCapture = nullptr;
+
+            for (const LogEntry &entry : log)
+            {
+                if (entry.level == LogLevel::Error)
+                    results[i].report.errors.push_back(entry.message);
+                else if (entry.level == LogLevel::Warning)
+                    results[i].report.notes.push_back(entry.message);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threadCount; ++i)
+        workers.emplace_back(worker);
+    worker();
+
+    for (auto &thread : workers)
+        thread.join();
+}
+
+static bool CollectFiles(const std::vector<std::string> &inputs, const std::string &outDir, std::vector<FileResult> &results)
+{
+    for (const auto &input : inputs)
+    {
+        std::error_code error;
+        if (fs::is_directory(input, error))
+        {
+            std::vector<std::string> found;
+            for (const auto &entry : fs::recursive_directory_iterator(input, error))
+            {
+                if (entry.is_regular_file() && entry.path().extension() == ".lvl")
+                    found.push_back(entry.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            for (auto &path : found)
+            {
+                // a/x.lvl and b/x.lvl would both end up as out/x.lvl otherwise
+                std::string outPath = outDir.empty() ? path : (fs::path(outDir) / fs::path(path).lexically_relative(input)).string();
+                results.push_back({path, outPath});
+            }
+        }
+        else if (fs::is_regular_file(input, error))
+        {
+            std::string outPath = outDir.empty() ? input : (fs::path(outDir) / fs::path(input).filename()).string();
+            results.push_back({input, outPath});
+        }
+        else
+        {
+            std::cerr << "No such file or folder: " << input << "\n";
+            return false;
+        }
+    }
+
+    // Two workers writing the same file (and the same .tmp next to it) would trample each other, refuse up front
+    std::vector<std::pair<std::string, size_t>> outPaths;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        std::error_code error;
+        fs::path outPath = fs::weakly_canonical(results[i].outPath, error);
+        if (error)
+            outPath = fs::absolute(results[i].outPath, error).lexically_normal();
+        outPaths.emplace_back(outPath.string(), i);
+    }
+    std::sort(outPaths.begin(), outPaths.end());
+    bool unique = true;
+    for (size_t i = 1; i < outPaths.size(); ++i)
+    {
+        if (outPaths[i].first != outPaths[i - 1].first)
+            continue;
+        std::cerr << results[outPaths[i - 1].second].path << " and " << results[outPaths[i].second].path << " would both be written to "
+                  << results[outPaths[i].second].outPath << "\n";
+        unique = false;
+    }
+    return unique;
+}
+
+static bool ParsePasses(const std::string &list, std::vector<const LevelPass *> &passes)
+{
+    passes.clear();
+    std::stringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        const LevelPass *pass = FindLevelPass(name);
+        if (!pass)
+        {
+            std::cerr << "Unknown pass: " << name << "\n";
+            return false;
+        }
+        passes.push_back(pass);
+    }
+    return !passes.empty();
+}
+
+static void PrintUsage()
+{
+    std::cerr << "Usage: level_tool [--passes a,b,c] [--threads N] [--out dir] [--dry-run] [--force] <files or folders...>\n\nPasses:\n";
+    for (const LevelPass &pass : GetLevelPasses())
+        std::cerr << "  " << pass.name << " - " << pass.description << "\n";
+}
+
+int main(int argc, char **argv)
+{
+    ToolConfig config;
+    ParsePasses("validate,compact-strings,bounds", config.passes);
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        auto hasValue = [&]()
+        { return i + 1 < argc; };
+
+        if (!std::strcmp(argv[i], "--passes") && hasValue())
+        {
+            if (!ParsePasses(argv[++i], config.passes))
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (!std::strcmp(argv[i], "--threads") && hasValue())
+            config.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (!std::strcmp(argv[i], "--out") && hasValue())
+            config.outDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--dry-run"))
+            config.dryRun = true;
+        else if (!std::strcmp(argv[i], "--force"))
+            config.force = true;
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+            inputs.push_back(argv[i]);
+    }
+
+    if (inputs.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<FileResult> results;
+    if (!CollectFiles(inputs, config.outDir, results))
+        return 1;
+    if (results.empty())
+    {
+        std::cerr << "No level files found\n";
+        return 0;
+    }
+
+    if (!config.outDir.empty())
+    {
+        std::error_code error;
+        fs::create_directories(config.outDir, error);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ProcessFiles(config, results);
+    double totalMs = MsSince(start);
+
+    // Printed after everything is done so the output stays in file order no matter which thread finished first
+    size_t failed = 0;
+    size_t written = 0;
+    size_t totalEntities = 0;
+    uintmax_t totalBytes = 0;
+    for (const FileResult &result : results)
+    {
+        failed += !result.ok;
+        written += result.written;
+        totalEntities += result.entities;
+        totalBytes += result.bytesIn;
+
+        std::cout << (result.ok ? (result.written ? "WROTE " : "OK    ") : "FAIL  ") << result.path << "  " << result.entities << " entities  read "
+                  << result.readMs << " ms  passes " << result.passMs << " ms  write " << result.writeMs << " ms\n";
+        for (const auto &note : result.report.notes)
+            std::cout << "      " << note << "\n";
+        for (const auto &error : result.report.errors)
+            std::cout << "      error: " << error << "\n";
+    }
+
+    double seconds = std::max(totalMs, 0.001) / 1000.0;
+    std::cout << results.size() << " files (" << written << " written, " << failed << " failed) in " << totalMs << " ms: "
+              << results.size() / seconds << " files/s, " << totalEntities / seconds << " entities/s, "
+              << totalBytes / seconds / (1024.0 * 1024.0) << " MB/s\n";
+
+    return failed ? 2 : 0;
+}
@@ -30,6 +30,28 @@ DEALINGS IN THE SOFTWARE.
 #include <iterator>
 #include <cstring>
 #include <string>
+#include <vector>
+
+// ASCII fast paths: SSE2 wherever it's there (x64 always), AVX2 when the compiler targets it, 8 bytes at a time
+// otherwise. Define UTF_CPP_NO_SIMD to keep the plain loops.
+#if !defined UTF_CPP_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTF_CPP_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define UTF_CPP_AVX2
+#include <immintrin.h>
+#endif
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define UTF_CPP_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#define UTF_CPP_NOINLINE __attribute__((noinline))
+#else
+#define UTF_CPP_NOINLINE
+#endif
 
 // Determine the C++ standard version.
 // If the user defines UTF_CPP_CPLUSPLUS, use that.
@@ -42,7 +64,7 @@ DEALINGS IN THE SOFTWARE.
 #if UTF_CPP_CPLUSPLUS >= 201103L // C++ 11 or later
 #define UTF_CPP_OVERRIDE override
 #define UTF_CPP_NOEXCEPT noexcept
-#define UTF_CPP_STATIC_trigger(condition) static_trigger(condition, "UTFCPP static trigger");
+#define UTF_CPP_STATIC_trigger(condition) static_assert(condition, "UTFCPP static assert");
 #else // C++ 98/03
 #define UTF_CPP_OVERRIDE
 #define UTF_CPP_NOEXCEPT throw()
@@ -478,6 +500,286 @@ namespace utf8
             return append16<word_iterator, utfchar16_t>(cp, result);
         }
 
+        // Index of the lowest set bit, mask is never 0
+        inline unsigned lowest_bit(unsigned mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        // How many units at the start of [it, end) are ASCII, the caller already checked the first one. ASCII is one
+        // code point per unit in every encoding here, so whole runs of it can skip the decoding. Kept out of line,
+        // inlined into every API function the vector loops would cost the decoding its own inlining.
+        UTF_CPP_NOINLINE inline std::size_t ascii_scan8(const unsigned char *it, const unsigned char *end)
+        {
+            const unsigned char *start = it;
+#if defined(UTF_CPP_AVX2)
+            for (; end - it >= 32; it += 32)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(it))));
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask);
+            }
+#endif
+#if defined(UTF_CPP_SSE2)
+            for (; end - it >= 16; it += 16)
+            {
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(it))));
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask);
+            }
+#else
+            for (; end - it >= 8; it += 8)
+            {
+                unsigned long long word;
+                std::memcpy(&word, it, sizeof(word));
+                if (word & 0x8080808080808080ull)
+                    break;
+            }
+#endif
+            while (it != end && *it < 0x80)
+                ++it;
+            return static_cast<std::size_t>(it - start);
+        }
+
+        UTF_CPP_NOINLINE inline std::size_t ascii_scan16(const utfchar16_t *it, const utfchar16_t *end)
+        {
+            const utfchar16_t *start = it;
+#if defined(UTF_CPP_AVX2)
+            for (; end - it >= 16; it += 16)
+            {
+                const __m256i high = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(it)), _mm256_set1_epi16(static_cast<short>(0xff80)));
+                const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(high, _mm256_setzero_si256())));
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask) / 2;
+            }
+#endif
+#if defined(UTF_CPP_SSE2)
+            for (; end - it >= 8; it += 8)
+            {
+                const __m128i high = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(it)), _mm_set1_epi16(static_cast<short>(0xff80)));
+                const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128()))) & 0xffffu;
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask) / 2;
+            }
+#endif
+            while (it != end && *it < 0x80)
+                ++it;
+            return static_cast<std::size_t>(it - start);
+        }
+
+        UTF_CPP_NOINLINE inline std::size_t ascii_scan32(const utfchar32_t *it, const utfchar32_t *end)
+        {
+            const utfchar32_t *start = it;
+#if defined(UTF_CPP_AVX2)
+            for (; end - it >= 8; it += 8)
+            {
+                const __m256i high = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(it)), _mm256_set1_epi32(static_cast<int>(0xffffff80u)));
+                const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(high, _mm256_setzero_si256())));
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask) / 4;
+            }
+#endif
+#if defined(UTF_CPP_SSE2)
+            for (; end - it >= 4; it += 4)
+            {
+                const __m128i high = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(it)), _mm_set1_epi32(static_cast<int>(0xffffff80u)));
+                const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128()))) & 0xffffu;
+                if (mask)
+                    return static_cast<std::size_t>(it - start) + lowest_bit(mask) / 4;
+            }
+#endif
+            while (it != end && *it < 0x80)
+                ++it;
+            return static_cast<std::size_t>(it - start);
+        }
+
+        // Non-ASCII text comes through here once per code point, that shouldn't cost more than a compare. Same for
+        // the lone spaces and newlines between its words, those don't need any vectors
+        inline std::size_t ascii_prefix8(const unsigned char *it, const unsigned char *end)
+        {
+            if (it == end || *it >= 0x80)
+                return 0;
+            if (end - it == 1 || it[1] >= 0x80)
+                return 1;
+            return ascii_scan8(it, end);
+        }
+
+        inline std::size_t ascii_prefix16(const utfchar16_t *it, const utfchar16_t *end)
+        {
+            if (it == end || *it >= 0x80)
+                return 0;
+            if (end - it == 1 || it[1] >= 0x80)
+                return 1;
+            return ascii_scan16(it, end);
+        }
+
+        inline std::size_t ascii_prefix32(const utfchar32_t *it, const utfchar32_t *end)
+        {
+            if (it == end || *it >= 0x80)
+                return 0;
+            if (end - it == 1 || it[1] >= 0x80)
+                return 1;
+            return ascii_scan32(it, end);
+        }
+
+        // Only contiguous buffers get the fast path. Any other iterator reports no run and goes one code point
+        // at a time like before.
+        template <typename iterator>
+        inline std::size_t ascii_run(iterator, iterator)
+        {
+            return 0;
+        }
+
+        inline std::size_t ascii_run(const char *it, const char *end)
+        {
+            return ascii_prefix8(reinterpret_cast<const unsigned char *>(it), reinterpret_cast<const unsigned char *>(end));
+        }
+
+        inline std::size_t ascii_run(char *it, char *end)
+        {
+            return ascii_prefix8(reinterpret_cast<const unsigned char *>(it), reinterpret_cast<const unsigned char *>(end));
+        }
+
+        inline std::size_t ascii_run(const unsigned char *it, const unsigned char *end)
+        {
+            return ascii_prefix8(it, end);
+        }
+
+        inline std::size_t ascii_run(unsigned char *it, unsigned char *end)
+        {
+            return ascii_prefix8(it, end);
+        }
+
+        inline std::size_t ascii_run(const utfchar16_t *it, const utfchar16_t *end)
+        {
+            return ascii_prefix16(it, end);
+        }
+
+        inline std::size_t ascii_run(utfchar16_t *it, utfchar16_t *end)
+        {
+            return ascii_prefix16(it, end);
+        }
+
+        inline std::size_t ascii_run(const utfchar32_t *it, const utfchar32_t *end)
+        {
+            return ascii_prefix32(it, end);
+        }
+
+        inline std::size_t ascii_run(utfchar32_t *it, utfchar32_t *end)
+        {
+            return ascii_prefix32(it, end);
+        }
+
+#if UTF_CPP_CPLUSPLUS >= 202002L // C++ 20 or later
+        inline std::size_t ascii_run(const char8_t *it, const char8_t *end)
+        {
+            return ascii_prefix8(reinterpret_cast<const unsigned char *>(it), reinterpret_cast<const unsigned char *>(end));
+        }
+
+        inline std::size_t ascii_run(char8_t *it, char8_t *end)
+        {
+            return ascii_prefix8(reinterpret_cast<const unsigned char *>(it), reinterpret_cast<const unsigned char *>(end));
+        }
+#endif
+
+        // The string overloads of the API pass string iterators, those are contiguous too
+        inline std::size_t ascii_run(std::string::const_iterator it, std::string::const_iterator end)
+        {
+            return it == end ? 0 : ascii_run(&*it, &*it + (end - it));
+        }
+
+        inline std::size_t ascii_run(std::string::iterator it, std::string::iterator end)
+        {
+            return it == end ? 0 : ascii_run(&*it, &*it + (end - it));
+        }
+
+#if UTF_CPP_CPLUSPLUS >= 201103L // C++ 11 or later
+        inline std::size_t ascii_run(std::u16string::const_iterator it, std::u16string::const_iterator end)
+        {
+            return it == end ? 0 : ascii_run(&*it, &*it + (end - it));
+        }
+
+        inline std::size_t ascii_run(std::u32string::const_iterator it, std::u32string::const_iterator end)
+        {
+            return it == end ? 0 : ascii_run(&*it, &*it + (end - it));
+        }
+#endif
+
+        // back_insert_iterator keeps its container protected, this gets at it so a whole run goes in with one insert
+        template <typename container_type>
+        struct back_insert_access : std::back_insert_iterator<container_type>
+        {
+            static container_type &get(const std::back_insert_iterator<container_type> &it)
+            {
+                return *(it.*(&back_insert_access::container));
+            }
+        };
+
+        template <typename container_type, typename input_iterator>
+        UTF_CPP_NOINLINE void insert_ascii(input_iterator &it, std::size_t count, const std::back_insert_iterator<container_type> &result)
+        {
+            container_type &container = back_insert_access<container_type>::get(result);
+            // Short runs (the spaces between words in other scripts) cost more as an insert
+            if (count < 16)
+            {
+                for (; count; --count)
+                    container.push_back(static_cast<typename container_type::value_type>(*it++));
+                return;
+            }
+
+            input_iterator last = it;
+            std::advance(last, static_cast<typename std::iterator_traits<input_iterator>::difference_type>(count));
+            container.insert(container.end(), it, last);
+            it = last;
+        }
+
+        // Writes `count` ASCII units from `it` as output_type, ASCII is the same value in every encoding
+        template <typename output_type, typename input_iterator, typename output_iterator>
+        output_iterator copy_ascii(input_iterator &it, std::size_t count, output_iterator result)
+        {
+            for (; count; --count)
+                *result++ = static_cast<output_type>(*it++);
+            return result;
+        }
+
+        // Strings and vectors behind a back_inserter (what most callers pass) get one insert instead of a push_back per unit
+        template <typename output_type, typename input_iterator, typename char_type, typename traits, typename allocator>
+        std::back_insert_iterator<std::basic_string<char_type, traits, allocator> >
+        copy_ascii(input_iterator &it, std::size_t count, std::back_insert_iterator<std::basic_string<char_type, traits, allocator> > result)
+        {
+            if (count == 1)
+                *result++ = static_cast<char_type>(*it++);
+            else
+                insert_ascii(it, count, result);
+            return result;
+        }
+
+        template <typename output_type, typename input_iterator, typename value_type, typename allocator>
+        std::back_insert_iterator<std::vector<value_type, allocator> >
+        copy_ascii(input_iterator &it, std::size_t count, std::back_insert_iterator<std::vector<value_type, allocator> > result)
+        {
+            if (count == 1)
+                *result++ = static_cast<value_type>(*it++);
+            else
+                insert_ascii(it, count, result);
+            return result;
+        }
+
+        // Moves `it` past the ASCII run it's on, returns how long it was
+        template <typename iterator>
+        inline std::size_t skip_ascii(iterator &it, iterator end)
+        {
+            const std::size_t run = utf8::internal::ascii_run(it, end);
+            std::advance(it, static_cast<typename std::iterator_traits<iterator>::difference_type>(run));
+            return run;
+        }
+
     } // namespace internal
 
     /// The library API - functions intended to be called by the users
@@ -491,6 +793,11 @@ namespace utf8
         octet_iterator result = start;
         while (result != end)
         {
+            // ASCII is always valid
+            utf8::internal::skip_ascii(result, end);
+            if (result == end)
+                break;
+
             utf8::internal::utf_error err_code = utf8::internal::validate_next(result, end);
             if (err_code != internal::UTF8_OK)
                 return result;
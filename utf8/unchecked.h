@@ -172,9 +172,17 @@ namespace utf8
         typename std::iterator_traits<octet_iterator>::difference_type
         distance(octet_iterator first, octet_iterator last)
         {
-            typename std::iterator_traits<octet_iterator>::difference_type dist;
-            for (dist = 0; first < last; ++dist)
+            typedef typename std::iterator_traits<octet_iterator>::difference_type difference_type;
+            difference_type dist = 0;
+            while (first < last) {
+                // ASCII runs count one per byte
+                if (const std::size_t ascii = utf8::internal::skip_ascii(first, last)) {
+                    dist += static_cast<difference_type>(ascii);
+                    continue;
+                }
                 utf8::unchecked::next(first);
+                ++dist;
+            }
             return dist;
         }
 
@@ -182,6 +190,11 @@ namespace utf8
         octet_iterator utf16to8(u16bit_iterator start, u16bit_iterator end, octet_iterator result)
         {
             while (start != end) {
+                // ASCII goes straight through, no surrogates to look for
+                if (const std::size_t ascii = utf8::internal::ascii_run(start, end)) {
+                    result = utf8::internal::copy_ascii<utfchar8_t>(start, ascii, result);
+                    continue;
+                }
                 utfchar32_t cp = utf8::internal::mask16(*start++);
                 // Take care of surrogate pairs first
                 if (utf8::internal::is_lead_surrogate(cp)) {
@@ -199,6 +212,11 @@ namespace utf8
         u16bit_iterator utf8to16(octet_iterator start, octet_iterator end, u16bit_iterator result)
         {
             while (start < end) {
+                // ASCII bytes widen as they are
+                if (const std::size_t ascii = utf8::internal::ascii_run(start, end)) {
+                    result = utf8::internal::copy_ascii<utfchar16_t>(start, ascii, result);
+                    continue;
+                }
                 utfchar32_t cp = utf8::unchecked::next(start);
                 if (cp > 0xffff) { //make a surrogate pair
                     *result++ = static_cast<utfchar16_t>((cp >> 10)   + internal::LEAD_OFFSET);
@@ -222,8 +240,13 @@ namespace utf8
         template <typename octet_iterator, typename u32bit_iterator>
         u32bit_iterator utf8to32(octet_iterator start, octet_iterator end, u32bit_iterator result)
         {
-            while (start < end)
+            while (start < end) {
+                if (const std::size_t ascii = utf8::internal::ascii_run(start, end)) {
+                    result = utf8::internal::copy_ascii<utfchar32_t>(start, ascii, result);
+                    continue;
+                }
                 (*result++) = utf8::unchecked::next(start);
+            }
 
             return result;
         }